@@ -1,27 +1,143 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.components import esp32_ble_tracker
-from esphome.const import CONF_ID
+from esphome.components import binary_sensor, esp32_ble_tracker, sensor, text_sensor
+from esphome.const import (
+    CONF_ADDRESS,
+    CONF_ID,
+    DEVICE_CLASS_PRESENCE,
+    DEVICE_CLASS_SIGNAL_STRENGTH,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    UNIT_DECIBEL_MILLIWATT,
+    UNIT_MILLISECOND,
+    UNIT_SECOND,
+)
 
 CODEOWNERS = ["@yoziru"]
 DEPENDENCIES = ["esp32_ble_tracker"]
+AUTO_LOAD = ["binary_sensor", "sensor", "text_sensor"]
 CONF_VIN = "vin"
+CONF_PRESENCE_TIMEOUT = "presence_timeout"
+CONF_ASLEEP_INTERVAL = "asleep_interval"
+CONF_PRESENCE = "presence"
+CONF_ASLEEP = "asleep"
+CONF_RSSI = "rssi"
+CONF_ADVERTISING_INTERVAL = "advertising_interval"
+CONF_DISTANCE_TREND = "distance_trend"
+CONF_LAST_SEEN = "last_seen"
+CONF_VEHICLES = "vehicles"
+
+# Keep in sync with TeslaBLEListener::MAX_VEHICLES
+MAX_VEHICLES = 8
 
 tesla_ble_listener_ns = cg.esphome_ns.namespace("tesla_ble_listener")
 TeslaBLEListener = tesla_ble_listener_ns.class_(
-    "TeslaBLEListener", esp32_ble_tracker.ESPBTDeviceListener
+    "TeslaBLEListener", cg.Component, esp32_ble_tracker.ESPBTDeviceListener
 )
 
-CONFIG_SCHEMA = cv.Schema(
+# Per-vehicle sensors, inferred from advertisements only
+VEHICLE_SENSORS_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_PRESENCE): binary_sensor.binary_sensor_schema(
+            device_class=DEVICE_CLASS_PRESENCE,
+            icon="mdi:car-connected",
+        ),
+        cv.Optional(CONF_ASLEEP): binary_sensor.binary_sensor_schema(
+            icon="mdi:sleep",
+        ),
+        cv.Optional(CONF_RSSI): sensor.sensor_schema(
+            unit_of_measurement=UNIT_DECIBEL_MILLIWATT,
+            accuracy_decimals=0,
+            device_class=DEVICE_CLASS_SIGNAL_STRENGTH,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_ADVERTISING_INTERVAL): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            accuracy_decimals=0,
+            icon="mdi:timer-outline",
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_LAST_SEEN): sensor.sensor_schema(
+            unit_of_measurement=UNIT_SECOND,
+            accuracy_decimals=0,
+            icon="mdi:clock-outline",
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_DISTANCE_TREND): text_sensor.text_sensor_schema(
+            icon="mdi:map-marker-distance",
+        ),
+        cv.Optional(CONF_ADDRESS): text_sensor.text_sensor_schema(
+            icon="mdi:bluetooth",
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+    }
+)
+
+VEHICLE_SCHEMA = VEHICLE_SENSORS_SCHEMA.extend(
     {
-        cv.GenerateID(): cv.declare_id(TeslaBLEListener),
         cv.Required(CONF_VIN): cv.string,
     }
-).extend(esp32_ble_tracker.ESP_BLE_DEVICE_SCHEMA)
+)
 
+# Either a single `vin` (with its sensors at the top level) or a `vehicles` list
+CONFIG_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(TeslaBLEListener),
+            cv.Optional(CONF_VIN): cv.string,
+            cv.Optional(CONF_VEHICLES): cv.All(
+                cv.ensure_list(VEHICLE_SCHEMA), cv.Length(min=1, max=MAX_VEHICLES)
+            ),
+            cv.Optional(CONF_PRESENCE_TIMEOUT, default="30s"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_ASLEEP_INTERVAL, default="100ms"): cv.positive_time_period_milliseconds,
+        }
+    )
+    .extend(VEHICLE_SENSORS_SCHEMA)
+    .extend(cv.COMPONENT_SCHEMA)
+    .extend(esp32_ble_tracker.ESP_BLE_DEVICE_SCHEMA),
+    cv.has_exactly_one_key(CONF_VIN, CONF_VEHICLES),
+)
+
+
+async def register_vehicle(var, vehicle):
+    vin = vehicle[CONF_VIN]
+    cg.add(var.add_vehicle(vin))
 
-def to_code(config):
+    if CONF_PRESENCE in vehicle:
+        sens = await binary_sensor.new_binary_sensor(vehicle[CONF_PRESENCE])
+        cg.add(var.set_presence_binary_sensor(vin, sens))
+    if CONF_ASLEEP in vehicle:
+        sens = await binary_sensor.new_binary_sensor(vehicle[CONF_ASLEEP])
+        cg.add(var.set_asleep_binary_sensor(vin, sens))
+    if CONF_RSSI in vehicle:
+        sens = await sensor.new_sensor(vehicle[CONF_RSSI])
+        cg.add(var.set_rssi_sensor(vin, sens))
+    if CONF_ADVERTISING_INTERVAL in vehicle:
+        sens = await sensor.new_sensor(vehicle[CONF_ADVERTISING_INTERVAL])
+        cg.add(var.set_interval_sensor(vin, sens))
+    if CONF_LAST_SEEN in vehicle:
+        sens = await sensor.new_sensor(vehicle[CONF_LAST_SEEN])
+        cg.add(var.set_last_seen_sensor(vin, sens))
+    if CONF_DISTANCE_TREND in vehicle:
+        sens = await text_sensor.new_text_sensor(vehicle[CONF_DISTANCE_TREND])
+        cg.add(var.set_distance_trend_text_sensor(vin, sens))
+    if CONF_ADDRESS in vehicle:
+        sens = await text_sensor.new_text_sensor(vehicle[CONF_ADDRESS])
+        cg.add(var.set_address_text_sensor(vin, sens))
+
+
+async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
-    yield esp32_ble_tracker.register_ble_device(var, config)
+    await cg.register_component(var, config)
+    await esp32_ble_tracker.register_ble_device(var, config)
+    cg.add_define("USE_TESLA_BLE_LISTENER")
+
+    cg.add(var.set_presence_timeout(config[CONF_PRESENCE_TIMEOUT]))
+    cg.add(var.set_asleep_interval(config[CONF_ASLEEP_INTERVAL]))
 
-    cg.add(var.set_vin(config[CONF_VIN]))
+    if CONF_VIN in config:
+        await register_vehicle(var, config)
+    for vehicle in config.get(CONF_VEHICLES, []):
+        await register_vehicle(var, vehicle)
@@ -1,5 +1,9 @@
 #include "tesla_ble_listener.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <vin_utils.h>
 
@@ -7,24 +11,311 @@ namespace esphome {
 namespace tesla_ble_listener {
 static const char *const TAG = "tesla_ble_listener";
 
+// A car in range advertises every 20-150 ms; one "found" line per address
+// per interval is plenty
+static const uint32_t FOUND_LOG_INTERVAL_MS = 60000;
+static const uint32_t STATS_INTERVAL_MS = 60000;
+// Presence is re-evaluated (and sensors published) at most this often
+static const uint32_t PUBLISH_INTERVAL_MS = 10000;
+// RSSI change (dB) between the two halves of the ring that counts as movement
+static const float DISTANCE_TREND_THRESHOLD_DB = 4.0f;
+
 std::string get_vin_advertisement_name(const char *vin) {
   std::string result = TeslaBLE::get_vin_advertisement_name(vin);
   ESP_LOGD(TAG, "VIN advertisement name: %s", result.c_str());
   return result;
 }
 
+// =============================================================================
+// AdvertHistory
+// =============================================================================
+
+void AdvertHistory::add(uint32_t now, int8_t value) {
+  if (this->count > 0)
+    this->head = (this->head + 1) % SIZE;
+  this->timestamps[this->head] = now;
+  this->rssi[this->head] = value;
+  this->count = std::min(this->count + 1, SIZE);
+}
+
+uint32_t AdvertHistory::median_interval() const {
+  if (this->count < 3)
+    return 0;
+
+  uint32_t gaps[SIZE - 1];
+  size_t n = 0;
+  // Walk newest to oldest
+  for (size_t i = 0; i + 1 < this->count; i++) {
+    const size_t newer = (this->head + SIZE - i) % SIZE;
+    const size_t older = (newer + SIZE - 1) % SIZE;
+    gaps[n++] = this->timestamps[newer] - this->timestamps[older];
+  }
+  std::sort(gaps, gaps + n);
+  return gaps[n / 2];
+}
+
+float AdvertHistory::rssi_mean() const {
+  if (this->count == 0)
+    return 0.0f;
+  int32_t sum = 0;
+  for (size_t i = 0; i < this->count; i++)
+    sum += this->rssi[i];
+  return static_cast<float>(sum) / this->count;
+}
+
+float AdvertHistory::rssi_trend() const {
+  if (this->count < 4)
+    return 0.0f;
+
+  const size_t half = this->count / 2;
+  int32_t newer = 0, older = 0;
+  for (size_t i = 0; i < half; i++) {
+    newer += this->rssi[(this->head + SIZE - i) % SIZE];
+    older += this->rssi[(this->head + SIZE - (this->count - 1 - i)) % SIZE];
+  }
+  return static_cast<float>(newer - older) / half;
+}
+
+// =============================================================================
+// TeslaBLEListener
+// =============================================================================
+
+void TeslaBLEListener::add_vehicle(const char *vin) {
+  if (this->find_vehicle(vin) != nullptr)
+    return;
+  if (this->vehicles_.size() >= MAX_VEHICLES) {
+    ESP_LOGE(TAG, "Too many vehicles, ignoring VIN %s", vin);
+    return;
+  }
+
+  TrackedVehicle vehicle;
+  vehicle.vin = vin;
+  vehicle.ad_name = get_vin_advertisement_name(vin);
+  vehicle.name_hash = fnv1_hash(vehicle.ad_name);
+  this->ad_name_length_ = vehicle.ad_name.size();
+  this->vehicles_.push_back(std::move(vehicle));
+}
+
+void TeslaBLEListener::setup() {
+  // Sort once so parse_device can binary search the hashes; pointers into
+  // vehicles_ are only handed out after this point
+  std::sort(this->vehicles_.begin(), this->vehicles_.end(),
+            [](const TrackedVehicle &a, const TrackedVehicle &b) { return a.name_hash < b.name_hash; });
+  this->name_hashes_.clear();
+  for (const auto &vehicle : this->vehicles_)
+    this->name_hashes_.push_back(vehicle.name_hash);
+}
+
+TrackedVehicle *TeslaBLEListener::match_name(const std::string &name) {
+  // Most advertisements carry no name or one of a different length
+  if (name.size() != this->ad_name_length_ || this->ad_name_length_ == 0)
+    return nullptr;
+
+  const uint32_t hash = fnv1_hash(name);
+  auto it = std::lower_bound(this->name_hashes_.begin(), this->name_hashes_.end(), hash);
+  for (; it != this->name_hashes_.end() && *it == hash; ++it) {
+    TrackedVehicle &vehicle = this->vehicles_[it - this->name_hashes_.begin()];
+    if (memcmp(name.data(), vehicle.ad_name.data(), name.size()) == 0)
+      return &vehicle;
+  }
+  return nullptr;
+}
+
+TrackedVehicle *TeslaBLEListener::find_vehicle(const char *vin) {
+  for (auto &vehicle : this->vehicles_) {
+    if (vehicle.vin == vin)
+      return &vehicle;
+  }
+  return nullptr;
+}
+
+const TrackedVehicle *TeslaBLEListener::find_vehicle(const std::string &vin) const {
+  for (const auto &vehicle : this->vehicles_) {
+    if (vehicle.vin == vin)
+      return &vehicle;
+  }
+  return nullptr;
+}
+
+uint64_t TeslaBLEListener::resolve_address(const std::string &vin) const {
+  const TrackedVehicle *vehicle = this->find_vehicle(vin);
+  return vehicle != nullptr ? vehicle->address : 0;
+}
+
+// Both read the history rather than the published flag, which lags by up
+// to PUBLISH_INTERVAL_MS: a car that just came back is not reported gone
+bool TeslaBLEListener::is_present(const std::string &vin) const {
+  const TrackedVehicle *vehicle = this->find_vehicle(vin);
+  return vehicle != nullptr && this->in_range(*vehicle, millis());
+}
+
+bool TeslaBLEListener::is_gone(const std::string &vin) const {
+  const TrackedVehicle *vehicle = this->find_vehicle(vin);
+  return vehicle != nullptr && vehicle->history.count > 0 && !this->in_range(*vehicle, millis());
+}
+
+bool TeslaBLEListener::in_range(const TrackedVehicle &vehicle, uint32_t now) const {
+  return vehicle.history.count > 0 && now - vehicle.history.last_seen() < this->presence_timeout_;
+}
+
+// Sensor setters are called from codegen after add_vehicle() for the VIN
+#define TESLA_LISTENER_SENSOR_SETTER(Method, Type, member) \
+  void TeslaBLEListener::Method(const char *vin, Type *sensor) { \
+    TrackedVehicle *vehicle = this->find_vehicle(vin); \
+    if (vehicle != nullptr) \
+      vehicle->member = sensor; \
+  }
+
+TESLA_LISTENER_SENSOR_SETTER(set_presence_binary_sensor, binary_sensor::BinarySensor, presence_sensor)
+TESLA_LISTENER_SENSOR_SETTER(set_asleep_binary_sensor, binary_sensor::BinarySensor, asleep_sensor)
+TESLA_LISTENER_SENSOR_SETTER(set_rssi_sensor, sensor::Sensor, rssi_sensor)
+TESLA_LISTENER_SENSOR_SETTER(set_interval_sensor, sensor::Sensor, interval_sensor)
+TESLA_LISTENER_SENSOR_SETTER(set_last_seen_sensor, sensor::Sensor, last_seen_sensor)
+TESLA_LISTENER_SENSOR_SETTER(set_distance_trend_text_sensor, text_sensor::TextSensor, distance_trend_sensor)
+TESLA_LISTENER_SENSOR_SETTER(set_address_text_sensor, text_sensor::TextSensor, address_sensor)
+
+#undef TESLA_LISTENER_SENSOR_SETTER
+
 bool TeslaBLEListener::parse_device(
     const esp32_ble_tracker::ESPBTDevice &device) {
-  ESP_LOGD(TAG, "Parsing device: [%s]: %s", device.address_str().c_str(),
-           device.get_name().c_str());
+  const uint32_t start_us = micros();
+  const uint32_t now = millis();
+
+  TrackedVehicle *vehicle = this->match_name(device.get_name());
+  if (vehicle != nullptr) {
+    this->stats_matches_++;
+    const uint64_t address = device.address_uint64();
+    if (address != vehicle->address) {
+      // First sighting, or the car's MAC changed (e.g. after a service visit)
+      if (vehicle->address != 0)
+        ESP_LOGW(TAG, "Vehicle %s changed address to %s", vehicle->vin.c_str(), device.address_str().c_str());
+      vehicle->address = address;
+      if (vehicle->address_sensor != nullptr)
+        vehicle->address_sensor->publish_state(device.address_str());
+    }
+    vehicle->rssi = static_cast<int8_t>(device.get_rssi());
+    vehicle->history.add(now, vehicle->rssi);
+    if (this->should_log(address, now)) {
+      ESP_LOGI(TAG, "Found Tesla vehicle | Name: %s | MAC: %s | RSSI: %d",
+               device.get_name().c_str(), device.address_str().c_str(),
+               device.get_rssi());
+    }
+  }
+
+  this->update_stats(now, micros() - start_us);
+  return vehicle != nullptr;
+}
+
+void TeslaBLEListener::loop() {
+  const uint32_t now = millis();
+  if (now - this->last_publish_ < PUBLISH_INTERVAL_MS)
+    return;
+  this->last_publish_ = now;
+  for (auto &vehicle : this->vehicles_)
+    this->publish_state(vehicle, now);
+}
 
-  if (device.get_name() == this->vin_ad_name_) {
-    ESP_LOGI(TAG, "Found Tesla vehicle | Name: %s | MAC: %s",
-             device.get_name().c_str(), device.address_str().c_str());
-    return true;
+void TeslaBLEListener::publish_state(TrackedVehicle &vehicle, uint32_t now) {
+  const AdvertHistory &history = vehicle.history;
+  const bool present = this->in_range(vehicle, now);
+  if (present != vehicle.present) {
+    ESP_LOGI(TAG, "Vehicle %s %s", vehicle.vin.c_str(), present ? "in range" : "out of range");
+    vehicle.present = present;
   }
+  if (vehicle.presence_sensor != nullptr)
+    vehicle.presence_sensor->publish_state(present);
+  if (vehicle.last_seen_sensor != nullptr && history.count > 0)
+    vehicle.last_seen_sensor->publish_state((now - history.last_seen()) / 1000);
+
+  DistanceTrend trend = DistanceTrend::AWAY;
+  if (present) {
+    const float delta = history.rssi_trend();
+    if (delta >= DISTANCE_TREND_THRESHOLD_DB) {
+      trend = DistanceTrend::APPROACHING;
+    } else if (delta <= -DISTANCE_TREND_THRESHOLD_DB) {
+      trend = DistanceTrend::LEAVING;
+    } else {
+      trend = DistanceTrend::STEADY;
+    }
+  }
+  if (vehicle.distance_trend_sensor != nullptr)
+    vehicle.distance_trend_sensor->publish_state(distance_trend_name(trend));
+
+  if (!present)
+    return;
+
+  if (vehicle.rssi_sensor != nullptr)
+    vehicle.rssi_sensor->publish_state(history.rssi_mean());
+
+  // The car advertises faster while awake. The observed interval also
+  // depends on the scan duty cycle, hence the configurable threshold.
+  const uint32_t interval = history.median_interval();
+  if (interval == 0)
+    return;
+  if (vehicle.interval_sensor != nullptr)
+    vehicle.interval_sensor->publish_state(interval);
+  if (vehicle.asleep_sensor != nullptr)
+    vehicle.asleep_sensor->publish_state(interval > this->asleep_interval_);
+}
+
+const char *TeslaBLEListener::distance_trend_name(DistanceTrend trend) {
+  switch (trend) {
+  case DistanceTrend::APPROACHING:
+    return "Approaching";
+  case DistanceTrend::STEADY:
+    return "Steady";
+  case DistanceTrend::LEAVING:
+    return "Leaving";
+  case DistanceTrend::AWAY:
+  default:
+    return "Away";
+  }
+}
+
+void TeslaBLEListener::dump_config() {
+  ESP_LOGCONFIG(TAG, "Tesla BLE Listener:");
+  for (const auto &vehicle : this->vehicles_) {
+    ESP_LOGCONFIG(TAG, "  VIN: %s (advertisement name: %s)", vehicle.vin.c_str(), vehicle.ad_name.c_str());
+  }
+  ESP_LOGCONFIG(TAG, "  Presence timeout: %ums", this->presence_timeout_);
+  ESP_LOGCONFIG(TAG, "  Asleep above interval: %ums", this->asleep_interval_);
+}
+
+bool TeslaBLEListener::should_log(uint64_t address, uint32_t now) {
+  LogSlot *oldest = &this->log_slots_[0];
+  for (auto &slot : this->log_slots_) {
+    if (slot.address == address) {
+      if (now - slot.last_log < FOUND_LOG_INTERVAL_MS)
+        return false;
+      slot.last_log = now;
+      return true;
+    }
+    if (slot.last_log < oldest->last_log)
+      oldest = &slot;
+  }
+  oldest->address = address;
+  oldest->last_log = now;
+  return true;
+}
+
+void TeslaBLEListener::update_stats(uint32_t now, uint32_t elapsed_us) {
+  if (this->stats_window_start_ == 0)
+    this->stats_window_start_ = now;
+  this->stats_adverts_++;
+  this->stats_busy_us_ += elapsed_us;
+
+  const uint32_t window = now - this->stats_window_start_;
+  if (window < STATS_INTERVAL_MS)
+    return;
 
-  return false;
+  ESP_LOGD(TAG, "Advertisements: %.1f/s, %u matched, %.1f us each (%u us total over %us)",
+           this->stats_adverts_ * 1000.0f / window, this->stats_matches_,
+           static_cast<float>(this->stats_busy_us_) / this->stats_adverts_,
+           this->stats_busy_us_, window / 1000);
+  this->stats_window_start_ = now;
+  this->stats_adverts_ = 0;
+  this->stats_matches_ = 0;
+  this->stats_busy_us_ = 0;
 }
 } // namespace tesla_ble_listener
 } // namespace esphome
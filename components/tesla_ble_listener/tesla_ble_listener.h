@@ -1,7 +1,12 @@
 #pragma once
 
 #include "esphome/core/component.h"
+#include "esphome/components/binary_sensor/binary_sensor.h"
 #include "esphome/components/esp32_ble_tracker/esp32_ble_tracker.h"
+#include "esphome/components/sensor/sensor.h"
+#include "esphome/components/text_sensor/text_sensor.h"
+#include <string>
+#include <vector>
 
 namespace esphome
 {
@@ -10,13 +15,135 @@ namespace esphome
 
     std::string get_vin_advertisement_name(const char *vin);
 
-    class TeslaBLEListener : public esp32_ble_tracker::ESPBTDeviceListener
+    /**
+     * @brief Recent advertisements of one vehicle
+     *
+     * A small ring of (timestamp, RSSI) pairs is enough to estimate the
+     * advertising interval and the RSSI trend without connecting.
+     */
+    struct AdvertHistory
+    {
+      static constexpr size_t SIZE = 16;
+
+      uint32_t timestamps[SIZE]{};
+      int8_t rssi[SIZE]{};
+      size_t head{0};
+      size_t count{0};
+
+      void add(uint32_t now, int8_t value);
+      uint32_t last_seen() const { return count ? timestamps[head] : 0; }
+      // Median gap between consecutive advertisements, 0 if unknown
+      uint32_t median_interval() const;
+      // Mean RSSI of the newest half minus the oldest half of the ring
+      float rssi_trend() const;
+      float rssi_mean() const;
+    };
+
+    enum class DistanceTrend : uint8_t
+    {
+      AWAY,
+      APPROACHING,
+      STEADY,
+      LEAVING,
+    };
+
+    /**
+     * @brief Discovery table entry for one configured VIN
+     */
+    struct TrackedVehicle
+    {
+      std::string vin;
+      std::string ad_name;
+      uint32_t name_hash{0};
+
+      // Last sighting
+      uint64_t address{0};
+      int8_t rssi{0};
+      AdvertHistory history;
+      // Presence as last published; lookups go by history instead, which
+      // every matching advertisement updates
+      bool present{false};
+
+      binary_sensor::BinarySensor *presence_sensor{nullptr};
+      binary_sensor::BinarySensor *asleep_sensor{nullptr};
+      sensor::Sensor *rssi_sensor{nullptr};
+      sensor::Sensor *interval_sensor{nullptr};
+      sensor::Sensor *last_seen_sensor{nullptr};
+      text_sensor::TextSensor *distance_trend_sensor{nullptr};
+      text_sensor::TextSensor *address_sensor{nullptr};
+    };
+
+    class TeslaBLEListener : public Component, public esp32_ble_tracker::ESPBTDeviceListener
     {
     public:
-      std::string vin_ad_name_;
+      static constexpr size_t MAX_VEHICLES = 8;
+
+      void setup() override;
+      void loop() override;
+      void dump_config() override;
+      float get_setup_priority() const override { return setup_priority::DATA; }
 
       bool parse_device(const esp32_ble_tracker::ESPBTDevice &device) override;
-      void set_vin(const char *vin) { vin_ad_name_ = get_vin_advertisement_name(vin); }
+
+      // Discovery table
+      void add_vehicle(const char *vin);
+      void set_vin(const char *vin) { this->add_vehicle(vin); }
+
+      // Passive state, inferred from advertisements only
+      void set_presence_timeout(uint32_t timeout_ms) { presence_timeout_ = timeout_ms; }
+      void set_asleep_interval(uint32_t interval_ms) { asleep_interval_ = interval_ms; }
+      void set_presence_binary_sensor(const char *vin, binary_sensor::BinarySensor *sensor);
+      void set_asleep_binary_sensor(const char *vin, binary_sensor::BinarySensor *sensor);
+      void set_rssi_sensor(const char *vin, sensor::Sensor *sensor);
+      void set_interval_sensor(const char *vin, sensor::Sensor *sensor);
+      void set_last_seen_sensor(const char *vin, sensor::Sensor *sensor);
+      void set_distance_trend_text_sensor(const char *vin, text_sensor::TextSensor *sensor);
+      void set_address_text_sensor(const char *vin, text_sensor::TextSensor *sensor);
+
+      // Lookups for other components, by VIN
+      const TrackedVehicle *find_vehicle(const std::string &vin) const;
+      // Most recently seen MAC address, 0 if the car has not been seen
+      uint64_t resolve_address(const std::string &vin) const;
+      // True once the car has been seen and has not gone quiet since
+      bool is_present(const std::string &vin) const;
+      // True if the car was seen at some point and is now clearly gone
+      bool is_gone(const std::string &vin) const;
+
+    protected:
+      TrackedVehicle *find_vehicle(const char *vin);
+      // Hash lookup of an advertised name, nullptr if it is not one of ours
+      TrackedVehicle *match_name(const std::string &name);
+      // Rate limit "found" logs per address
+      bool should_log(uint64_t address, uint32_t now);
+      void update_stats(uint32_t now, uint32_t elapsed_us);
+      void publish_state(TrackedVehicle &vehicle, uint32_t now);
+      bool in_range(const TrackedVehicle &vehicle, uint32_t now) const;
+      static const char *distance_trend_name(DistanceTrend trend);
+
+      // All advertisement names share one length (S + 16 hex + C)
+      size_t ad_name_length_{0};
+      // Sorted by name_hash once setup() has run
+      std::vector<TrackedVehicle> vehicles_;
+      std::vector<uint32_t> name_hashes_;
+
+      static constexpr size_t LOG_SLOTS = 4;
+      struct LogSlot
+      {
+        uint64_t address{0};
+        uint32_t last_log{0};
+      };
+      LogSlot log_slots_[LOG_SLOTS];
+
+      // Advertisement statistics, logged once per window
+      uint32_t stats_window_start_{0};
+      uint32_t stats_adverts_{0};
+      uint32_t stats_matches_{0};
+      uint32_t stats_busy_us_{0};
+
+      // Passive presence
+      uint32_t presence_timeout_{30000};
+      uint32_t asleep_interval_{100};
+      uint32_t last_publish_{0};
     };
 
   } // namespace tesla_ble_listener
@@ -1,6 +1,10 @@
+import logging
+import re
+
 import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome.components import ble_client, binary_sensor, button, switch, number, sensor, text_sensor, lock, cover, climate
+from esphome.components import esp32
 from esphome.const import (
     CONF_ACCURACY_DECIMALS,
     CONF_DEVICE_CLASS,
@@ -16,10 +20,13 @@ from esphome.const import (
     ENTITY_CATEGORY_DIAGNOSTIC,
 )
 from esphome import automation
+import esphome.final_validate as fv
 
+_LOGGER = logging.getLogger(__name__)
 
 CODEOWNERS = ["@yoziru"]
 DEPENDENCIES = ["ble_client"]
+MULTI_CONF = True
 AUTO_LOAD = ["binary_sensor", "button", "switch", "number", "sensor", "text_sensor", "lock", "cover", "climate"]
 
 tesla_ble_vehicle_ns = cg.esphome_ns.namespace("tesla_ble_vehicle")
@@ -27,6 +34,9 @@ TeslaBLEVehicle = tesla_ble_vehicle_ns.class_(
     "TeslaBLEVehicle", cg.PollingComponent, ble_client.BLEClientNode
 )
 
+# Declared by name so this component loads without tesla_ble_listener
+TeslaBLEListener = cg.esphome_ns.namespace("tesla_ble_listener").class_("TeslaBLEListener", cg.Component)
+
 # Custom button classes - generated via macro in C++, just reference here
 # The class name follows pattern: Tesla{Id}Button where Id is PascalCase of id
 TeslaWakeButton = tesla_ble_vehicle_ns.class_("TeslaWakeButton", button.Button)
@@ -67,6 +77,8 @@ ForceUpdateAction = tesla_ble_vehicle_ns.class_("ForceUpdateAction", automation.
 SetChargingAction = tesla_ble_vehicle_ns.class_("SetChargingAction", automation.Action)
 SetChargingAmpsAction = tesla_ble_vehicle_ns.class_("SetChargingAmpsAction", automation.Action)
 SetChargingLimitAction = tesla_ble_vehicle_ns.class_("SetChargingLimitAction", automation.Action)
+BenchmarkAction = tesla_ble_vehicle_ns.class_("BenchmarkAction", automation.Action)
+DumpCaptureAction = tesla_ble_vehicle_ns.class_("DumpCaptureAction", automation.Action)
 
 # Configuration constants
 CONF_VIN = "vin"
@@ -78,6 +90,17 @@ CONF_VCSEC_POLL_INTERVAL = "vcsec_poll_interval"
 CONF_INFOTAINMENT_POLL_INTERVAL_AWAKE = "infotainment_poll_interval_awake" 
 CONF_INFOTAINMENT_POLL_INTERVAL_ACTIVE = "infotainment_poll_interval_active"
 CONF_INFOTAINMENT_SLEEP_TIMEOUT = "infotainment_sleep_timeout"
+CONF_SESSION_FLUSH_INTERVAL = "session_flush_interval"
+CONF_LINK_IDLE_TIMEOUT = "link_idle_timeout"
+CONF_PAUSE_SCAN_WHILE_CONNECTED = "pause_scan_while_connected"
+CONF_LISTENER_ID = "listener_id"
+CONF_NAME_PREFIX = "name_prefix"
+CONF_CAPTURE_BUFFER_SIZE = "capture_buffer_size"
+CONF_LOOP_TIME_BUDGET = "loop_time_budget"
+CONF_PUBLISH_BUDGET = "publish_budget"
+CONF_HEAP_TELEMETRY = "heap_telemetry"
+CONF_PROTOCOL_TASK = "protocol_task"
+CONF_ENTITY_GROUPS = "entity_groups"
 
 # Tesla key roles
 TESLA_ROLES = {
@@ -85,6 +108,18 @@ TESLA_ROLES = {
     "CHARGING_MANAGER": "Keys_Role_ROLE_CHARGING_MANAGER",
 }
 
+# Roles whose key may lock, open closures, run climate and sound alerts
+DRIVER_ROLES = ("DRIVER",)
+
+# Optional entity groups and the define that compiles in their update path.
+# A define is emitted if any vehicle on the node keeps the group.
+ENTITY_GROUPS = {
+    "climate": "USE_TESLA_BLE_CLIMATE_STATE",
+    "drive": "USE_TESLA_BLE_DRIVE_STATE",
+    "tire_pressure": "USE_TESLA_BLE_TIRE_PRESSURE_STATE",
+    "closures": "USE_TESLA_BLE_CLOSURES_STATE",
+}
+
 # =============================================================================
 # ENTITY DEFINITIONS - Add new sensors/controls here!
 # =============================================================================
@@ -100,6 +135,8 @@ TESLA_ROLES = {
 #   - accuracy_decimals: number of decimals for display precision (optional, for sensors only)
 #   - disabled_by_default: whether disabled by default (optional, default False)
 #   - entity_category: entity category (optional, e.g. "diagnostic")
+#   - group: key of ENTITY_GROUPS the entity belongs to (optional)
+#   - driver_only: only created for roles in DRIVER_ROLES (optional, default False)
 #
 # For buttons/switches, also include:
 #   - class: the C++ class reference (e.g. TeslaWakeButton)
@@ -117,18 +154,18 @@ BINARY_SENSORS = [
     {"id": "charger", "name": "Charger", "icon": "mdi:power-plug", "device_class": "plug"},
     
     # Drive sensors
-    {"id": "parking_brake", "name": "Parking Brake", "icon": "mdi:car-brake-parking"},
+    {"id": "parking_brake", "name": "Parking Brake", "icon": "mdi:car-brake-parking", "group": "drive"},
     
     # Individual closure sensors (disabled by default since covers/locks show aggregate state)
-    {"id": "door_driver_front", "name": "Door Driver Front", "icon": "mdi:car-door", "device_class": "door", "disabled_by_default": True},
-    {"id": "door_driver_rear", "name": "Door Driver Rear", "icon": "mdi:car-door", "device_class": "door", "disabled_by_default": True},
-    {"id": "door_passenger_front", "name": "Door Passenger Front", "icon": "mdi:car-door", "device_class": "door", "disabled_by_default": True},
-    {"id": "door_passenger_rear", "name": "Door Passenger Rear", "icon": "mdi:car-door", "device_class": "door", "disabled_by_default": True},
-    {"id": "window_driver_front", "name": "Window Driver Front", "icon": "mdi:car-door", "device_class": "window", "disabled_by_default": True},
-    {"id": "window_driver_rear", "name": "Window Driver Rear", "icon": "mdi:car-door", "device_class": "window", "disabled_by_default": True},
-    {"id": "window_passenger_front", "name": "Window Passenger Front", "icon": "mdi:car-door", "device_class": "window", "disabled_by_default": True},
-    {"id": "window_passenger_rear", "name": "Window Passenger Rear", "icon": "mdi:car-door", "device_class": "window", "disabled_by_default": True},
-    {"id": "sunroof", "name": "Sunroof", "icon": "mdi:car-select", "device_class": "window", "disabled_by_default": True},
+    {"id": "door_driver_front", "name": "Door Driver Front", "icon": "mdi:car-door", "device_class": "door", "disabled_by_default": True, "group": "closures"},
+    {"id": "door_driver_rear", "name": "Door Driver Rear", "icon": "mdi:car-door", "device_class": "door", "disabled_by_default": True, "group": "closures"},
+    {"id": "door_passenger_front", "name": "Door Passenger Front", "icon": "mdi:car-door", "device_class": "door", "disabled_by_default": True, "group": "closures"},
+    {"id": "door_passenger_rear", "name": "Door Passenger Rear", "icon": "mdi:car-door", "device_class": "door", "disabled_by_default": True, "group": "closures"},
+    {"id": "window_driver_front", "name": "Window Driver Front", "icon": "mdi:car-door", "device_class": "window", "disabled_by_default": True, "group": "closures"},
+    {"id": "window_driver_rear", "name": "Window Driver Rear", "icon": "mdi:car-door", "device_class": "window", "disabled_by_default": True, "group": "closures"},
+    {"id": "window_passenger_front", "name": "Window Passenger Front", "icon": "mdi:car-door", "device_class": "window", "disabled_by_default": True, "group": "closures"},
+    {"id": "window_passenger_rear", "name": "Window Passenger Rear", "icon": "mdi:car-door", "device_class": "window", "disabled_by_default": True, "group": "closures"},
+    {"id": "sunroof", "name": "Sunroof", "icon": "mdi:car-select", "device_class": "window", "disabled_by_default": True, "group": "closures"},
 
 ]
 
@@ -148,23 +185,66 @@ SENSORS = [
     {"id": "time_to_full", "name": "Time to Full", "icon": "mdi:clock-outline", "device_class": "duration", "unit": "min"},
     
     # Climate state sensors
-    {"id": "outside_temp", "name": "Outside Temperature", "icon": "mdi:thermometer", "device_class": "temperature", "unit": "°C", "accuracy_decimals": 1},
+    {"id": "outside_temp", "name": "Outside Temperature", "icon": "mdi:thermometer", "device_class": "temperature", "unit": "°C", "accuracy_decimals": 1, "group": "climate"},
     
     # Drive state sensors
-    {"id": "odometer", "name": "Odometer", "icon": "mdi:counter", "device_class": "distance", "unit": "mi", "disabled_by_default": True},
+    {"id": "odometer", "name": "Odometer", "icon": "mdi:counter", "device_class": "distance", "unit": "mi", "disabled_by_default": True, "group": "drive"},
     
     # Tire pressure sensors
-    {"id": "tpms_front_left", "name": "TPMS Front Left", "icon": "mdi:car-tire-alert", "device_class": "pressure", "unit": "bar", "accuracy_decimals": 1},
-    {"id": "tpms_front_right", "name": "TPMS Front Right", "icon": "mdi:car-tire-alert", "device_class": "pressure", "unit": "bar", "accuracy_decimals": 1},
-    {"id": "tpms_rear_left", "name": "TPMS Rear Left", "icon": "mdi:car-tire-alert", "device_class": "pressure", "unit": "bar", "accuracy_decimals": 1},
-    {"id": "tpms_rear_right", "name": "TPMS Rear Right", "icon": "mdi:car-tire-alert", "device_class": "pressure", "unit": "bar", "accuracy_decimals": 1},
+    {"id": "tpms_front_left", "name": "TPMS Front Left", "icon": "mdi:car-tire-alert", "device_class": "pressure", "unit": "bar", "accuracy_decimals": 1, "group": "tire_pressure"},
+    {"id": "tpms_front_right", "name": "TPMS Front Right", "icon": "mdi:car-tire-alert", "device_class": "pressure", "unit": "bar", "accuracy_decimals": 1, "group": "tire_pressure"},
+    {"id": "tpms_rear_left", "name": "TPMS Rear Left", "icon": "mdi:car-tire-alert", "device_class": "pressure", "unit": "bar", "accuracy_decimals": 1, "group": "tire_pressure"},
+    {"id": "tpms_rear_right", "name": "TPMS Rear Right", "icon": "mdi:car-tire-alert", "device_class": "pressure", "unit": "bar", "accuracy_decimals": 1, "group": "tire_pressure"},
+
+    # Component diagnostics
+    {"id": "connect_open_time", "name": "Connect Link Open", "icon": "mdi:timer-outline", "device_class": "duration", "unit": "ms", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "connect_mtu_time", "name": "Connect MTU Exchange", "icon": "mdi:timer-outline", "device_class": "duration", "unit": "ms", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "connect_discovery_time", "name": "Connect Discovery", "icon": "mdi:timer-outline", "device_class": "duration", "unit": "ms", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "connect_ready_time", "name": "Connect Ready", "icon": "mdi:timer-outline", "device_class": "duration", "unit": "ms", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "connect_first_rx_time", "name": "Connect First RX", "icon": "mdi:timer-outline", "device_class": "duration", "unit": "ms", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "connect_vcsec_time", "name": "Connect VCSEC Session", "icon": "mdi:timer-outline", "device_class": "duration", "unit": "ms", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "connect_infotainment_time", "name": "Connect Infotainment Session", "icon": "mdi:timer-outline", "device_class": "duration", "unit": "ms", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "connect_open_median", "name": "Connect Link Open Median", "icon": "mdi:timer-sand", "device_class": "duration", "unit": "ms", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "connect_mtu_median", "name": "Connect MTU Exchange Median", "icon": "mdi:timer-sand", "device_class": "duration", "unit": "ms", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "connect_discovery_median", "name": "Connect Discovery Median", "icon": "mdi:timer-sand", "device_class": "duration", "unit": "ms", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "connect_ready_median", "name": "Connect Ready Median", "icon": "mdi:timer-sand", "device_class": "duration", "unit": "ms", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "connect_first_rx_median", "name": "Connect First RX Median", "icon": "mdi:timer-sand", "device_class": "duration", "unit": "ms", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "connect_vcsec_median", "name": "Connect VCSEC Session Median", "icon": "mdi:timer-sand", "device_class": "duration", "unit": "ms", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "connect_vcsec_cached_median", "name": "Connect VCSEC Session Median (Cached Handles)", "icon": "mdi:timer-sand", "device_class": "duration", "unit": "ms", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "connect_vcsec_discovery_median", "name": "Connect VCSEC Session Median (Full Discovery)", "icon": "mdi:timer-sand", "device_class": "duration", "unit": "ms", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "connect_infotainment_median", "name": "Connect Infotainment Session Median", "icon": "mdi:timer-sand", "device_class": "duration", "unit": "ms", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "time_to_first_state", "name": "Time to First State", "icon": "mdi:timer-check-outline", "device_class": "duration", "unit": "ms", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "connection_interval", "name": "Connection Interval", "icon": "mdi:timer-sync-outline", "device_class": "duration", "unit": "ms", "accuracy_decimals": 2, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "connection_latency", "name": "Connection Slave Latency", "icon": "mdi:sleep", "unit": "", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "link_param_switches", "name": "Link Parameter Switches", "icon": "mdi:swap-horizontal", "unit": "", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "link_data_length", "name": "Link Data Length", "icon": "mdi:arrow-expand-horizontal", "unit": "B", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "rx_latency", "name": "RX Latency", "icon": "mdi:timer-outline", "device_class": "duration", "unit": "ms", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "rx_throughput", "name": "RX Throughput", "icon": "mdi:speedometer", "device_class": "data_rate", "unit": "B/s", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "link_rssi", "name": "Link RSSI", "icon": "mdi:signal", "device_class": "signal_strength", "unit": "dBm", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "link_quality", "name": "Link Quality", "icon": "mdi:signal-cellular-3", "unit": "%", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "reconnect_attempts", "name": "Reconnect Attempts", "icon": "mdi:bluetooth-connect", "unit": "", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "reconnect_backoff", "name": "Reconnect Backoff", "icon": "mdi:timer-refresh-outline", "device_class": "duration", "unit": "s", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "airtime_utilization", "name": "Air Time", "icon": "mdi:radio-tower", "unit": "%", "accuracy_decimals": 2, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "airtime_total_utilization", "name": "Air Time (All Vehicles)", "icon": "mdi:radio-tower", "unit": "%", "accuracy_decimals": 2, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "loop_time_max", "name": "Loop Time Max", "icon": "mdi:timer-alert-outline", "device_class": "duration", "unit": "ms", "accuracy_decimals": 1, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "loop_time_mean", "name": "Loop Time Mean", "icon": "mdi:timer-outline", "device_class": "duration", "unit": "ms", "accuracy_decimals": 2, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "loop_over_budget", "name": "Loop Over Budget", "icon": "mdi:timer-alert", "unit": "", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "heap_min_free", "name": "Heap Minimum Free", "icon": "mdi:memory", "device_class": "data_size", "unit": "B", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "heap_largest_block", "name": "Heap Largest Free Block", "icon": "mdi:memory", "device_class": "data_size", "unit": "B", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "component_allocations", "name": "Allocations per Minute", "icon": "mdi:counter", "unit": "", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "component_alloc_bytes", "name": "Allocated Bytes per Minute", "icon": "mdi:memory", "device_class": "data_size", "unit": "B", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "storage_writes_avoided", "name": "Flash Writes Avoided", "icon": "mdi:content-save-check", "unit": "", "accuracy_decimals": 0, "entity_category": "diagnostic", "disabled_by_default": True},
 ]
 
 TEXT_SENSORS = [
     {"id": "charging_state", "name": "Charging", "icon": "mdi:ev-station"},
     {"id": "iec61851_state", "name": "IEC 61851", "icon": "mdi:ev-plug-type2", "disabled_by_default": True},
-    {"id": "shift_state", "name": "Shift State", "icon": "mdi:car-shift-pattern", "disabled_by_default": True},
+    {"id": "shift_state", "name": "Shift State", "icon": "mdi:car-shift-pattern", "disabled_by_default": True, "group": "drive"},
     {"id": "charge_limit_reason", "name": "Charge Limit Reason", "icon": "mdi:ev-plug-tesla"},
+    {"id": "key_operation", "name": "Key Operation", "icon": "mdi:key-chain", "entity_category": "diagnostic"},
+    {"id": "loop_time_breakdown", "name": "Loop Time Breakdown", "icon": "mdi:chart-timeline", "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "heap_scope_breakdown", "name": "Allocation Breakdown", "icon": "mdi:chart-bar", "entity_category": "diagnostic", "disabled_by_default": True},
+    {"id": "link_phy", "name": "Link PHY", "icon": "mdi:radio-tower", "entity_category": "diagnostic", "disabled_by_default": True},
     {"id": "last_command", "name": "Last Command", "icon": "mdi:history", "entity_category": "diagnostic", "disabled_by_default": True, "setter": "set_last_command_text_sensor"},
 ]
 
@@ -174,29 +254,29 @@ BUTTONS = [
     {"id": "regenerate_key", "name": "Regenerate key", "class": TeslaRegenerateKeyButton, "setter": "set_regenerate_key_button", "icon": "mdi:key-change", "entity_category": "diagnostic", "disabled_by_default": True},
     {"id": "force_update", "name": "Force data update", "class": TeslaForceUpdateButton, "setter": "set_force_update_button", "icon": "mdi:database-sync", "entity_category": "diagnostic"},
     # Unique actions (not part of combined entities)
-    {"id": "unlatch_driver_door", "name": "Unlatch Driver Door", "class": TeslaUnlatchDriverDoorButton, "setter": None, "icon": "mdi:car-door", "disabled_by_default": True},
+    {"id": "unlatch_driver_door", "name": "Unlatch Driver Door", "class": TeslaUnlatchDriverDoorButton, "setter": None, "icon": "mdi:car-door", "disabled_by_default": True, "driver_only": True},
     # Vehicle controls
-    {"id": "flash_lights", "name": "Flash Lights", "class": TeslaFlashLightsButton, "setter": None, "icon": "mdi:car-light-high"},
-    {"id": "honk_horn", "name": "Sound Horn", "class": TeslaHonkHornButton, "setter": None, "icon": "mdi:bullhorn"},
+    {"id": "flash_lights", "name": "Flash Lights", "class": TeslaFlashLightsButton, "setter": None, "icon": "mdi:car-light-high", "driver_only": True},
+    {"id": "honk_horn", "name": "Sound Horn", "class": TeslaHonkHornButton, "setter": None, "icon": "mdi:bullhorn", "driver_only": True},
 ]
 
 SWITCHES = [
     {"id": "charging", "name": "Charger", "class": TeslaChargingSwitch, "setter": "set_charging_switch", "icon": "mdi:ev-station"},
-    {"id": "steering_wheel_heat", "name": "Heated Steering", "class": TeslaSteeringWheelHeatSwitch, "setter": "set_steering_wheel_heat_switch", "icon": "mdi:steering"},
-    {"id": "sentry_mode", "name": "Sentry Mode", "class": TeslaSentryModeSwitch, "setter": "set_sentry_mode_switch", "icon": "mdi:shield-car"},
+    {"id": "steering_wheel_heat", "name": "Heated Steering", "class": TeslaSteeringWheelHeatSwitch, "setter": "set_steering_wheel_heat_switch", "icon": "mdi:steering", "group": "climate", "driver_only": True},
+    {"id": "sentry_mode", "name": "Sentry Mode", "class": TeslaSentryModeSwitch, "setter": "set_sentry_mode_switch", "icon": "mdi:shield-car", "group": "closures", "driver_only": True},
 ]
 
 # Lock entities (combined sensor + control)
 LOCKS = [
-    {"id": "doors", "name": "Doors", "class": TeslaDoorsLock, "setter": "set_doors_lock", "icon": "mdi:car-door-lock"},
+    {"id": "doors", "name": "Doors", "class": TeslaDoorsLock, "setter": "set_doors_lock", "icon": "mdi:car-door-lock", "driver_only": True},
     {"id": "charge_port_latch", "name": "Charge Port Latch", "class": TeslaChargePortLatchLock, "setter": "set_charge_port_latch_lock", "icon": "mdi:ev-plug-tesla"},
 ]
 
 # Cover entities (combined sensor + control)
 COVERS = [
-    {"id": "trunk", "name": "Trunk", "class": TeslaTrunkCover, "setter": "set_trunk_cover", "icon": "mdi:car-back", "device_class": "door"},
-    {"id": "frunk", "name": "Frunk", "class": TeslaFrunkCover, "setter": "set_frunk_cover", "icon": "mdi:car", "device_class": "door"},
-    {"id": "windows", "name": "Windows", "class": TeslaWindowsCover, "setter": "set_windows_cover", "icon": "mdi:car-door", "device_class": "awning"},
+    {"id": "trunk", "name": "Trunk", "class": TeslaTrunkCover, "setter": "set_trunk_cover", "icon": "mdi:car-back", "device_class": "door", "group": "closures", "driver_only": True},
+    {"id": "frunk", "name": "Frunk", "class": TeslaFrunkCover, "setter": "set_frunk_cover", "icon": "mdi:car", "device_class": "door", "group": "closures", "driver_only": True},
+    {"id": "windows", "name": "Windows", "class": TeslaWindowsCover, "setter": "set_windows_cover", "icon": "mdi:car-door", "device_class": "awning", "group": "closures", "driver_only": True},
     {"id": "charge_port_door", "name": "Charge Port Door", "class": TeslaChargePortDoorCover, "setter": "set_charge_port_door_cover", "icon": "mdi:ev-plug-tesla", "device_class": "door"},
 ]
 
@@ -206,6 +286,8 @@ CLIMATE = {
     "name": "Climate",
     "class": TeslaClimate,
     "setter": "set_climate",
+    "group": "climate",
+    "driver_only": True,
 }
 
 NUMBERS = [
@@ -249,6 +331,26 @@ CONFIG_SCHEMA = (
             cv.Optional(CONF_INFOTAINMENT_POLL_INTERVAL_AWAKE, default=30): cv.int_range(min=10, max=600), 
             cv.Optional(CONF_INFOTAINMENT_POLL_INTERVAL_ACTIVE, default=10): cv.int_range(min=5, max=120),
             cv.Optional(CONF_INFOTAINMENT_SLEEP_TIMEOUT, default=660): cv.int_range(min=60, max=3600),
+            # Session cache flush interval (in seconds)
+            cv.Optional(CONF_SESSION_FLUSH_INTERVAL, default=60): cv.int_range(min=5, max=3600),
+            cv.Optional(CONF_LINK_IDLE_TIMEOUT, default=30): cv.int_range(min=5, max=600),
+            cv.Optional(CONF_PAUSE_SCAN_WHILE_CONNECTED, default=False): cv.boolean,
+            cv.Optional(CONF_LOOP_TIME_BUDGET, default="20ms"): cv.positive_time_period_microseconds,
+            # Time per loop spent publishing staged sensor updates; 0 publishes inline
+            cv.Optional(CONF_PUBLISH_BUDGET, default="2ms"): cv.positive_time_period_microseconds,
+            # Per-scope allocation accounting; enables the ESP-IDF heap hooks
+            cv.Optional(CONF_HEAP_TELEMETRY, default=False): cv.boolean,
+            # Decode notifications on the second core (no-op on single-core chips)
+            cv.Optional(CONF_PROTOCOL_TASK, default=False): cv.boolean,
+            # Set a group to false to leave out its entities and update code
+            cv.Optional(CONF_ENTITY_GROUPS, default={}): cv.Schema(
+                {cv.Optional(group, default=True): cv.boolean for group in ENTITY_GROUPS}
+            ),
+            cv.Optional(CONF_LISTENER_ID): cv.use_id(TeslaBLEListener),
+            # Required to tell entities apart when several vehicles share a node
+            cv.Optional(CONF_NAME_PREFIX): cv.string_strict,
+            # Record raw BLE traffic into a RAM ring of this many bytes
+            cv.Optional(CONF_CAPTURE_BUFFER_SIZE): cv.int_range(min=1024, max=65536),
         },
     )
     .extend(cv.polling_component_schema("10s"))
@@ -260,6 +362,25 @@ CONFIG_SCHEMA = (
 # HELPER FUNCTIONS
 # =============================================================================
 
+def entity_enabled(definition, vehicle_config):
+    """Whether the entity's group is enabled and the key's role may use it."""
+    group = definition.get("group")
+    if group is not None and not vehicle_config[CONF_ENTITY_GROUPS][group]:
+        return False
+    return vehicle_config[CONF_ROLE] in DRIVER_ROLES or not definition.get("driver_only", False)
+
+
+def enabled_entities(definitions, vehicle_config, skipped):
+    """Filter definitions with entity_enabled(), collecting the skipped IDs."""
+    enabled = []
+    for definition in definitions:
+        if entity_enabled(definition, vehicle_config):
+            enabled.append(definition)
+        else:
+            skipped.append(definition["id"])
+    return enabled
+
+
 def get_device_class_const(component_module, device_class_str):
     """Convert device class string to the actual constant."""
     if device_class_str is None:
@@ -267,11 +388,28 @@ def get_device_class_const(component_module, device_class_str):
     return getattr(component_module, f"DEVICE_CLASS_{device_class_str.upper()}", None)
 
 
-async def create_binary_sensor(var, definition):
+def entity_id(config, definition, kind):
+    """Entity ID for a definition, namespaced by name_prefix when one is set."""
+    prefix = config.get(CONF_NAME_PREFIX)
+    if prefix:
+        slug = re.sub(r"[^a-z0-9]+", "_", prefix.lower()).strip("_")
+        return f"tesla_{slug}_{definition['id']}_{kind}"
+    return f"tesla_{definition['id']}_{kind}"
+
+
+def entity_name(config, definition):
+    """Entity name, prefixed with name_prefix when one is set."""
+    prefix = config.get(CONF_NAME_PREFIX)
+    if prefix:
+        return f"{prefix} {definition['name']}"
+    return definition["name"]
+
+
+async def create_binary_sensor(var, definition, vehicle_config):
     """Create a binary sensor and register with TeslaBLEVehicle using generic setter."""
     config = {
-        CONF_ID: cv.declare_id(binary_sensor.BinarySensor)(f"tesla_{definition['id']}_sensor"),
-        CONF_NAME: definition["name"],
+        CONF_ID: cv.declare_id(binary_sensor.BinarySensor)(entity_id(vehicle_config, definition, "sensor")),
+        CONF_NAME: entity_name(vehicle_config, definition),
         CONF_DISABLED_BY_DEFAULT: definition.get("disabled_by_default", False),
     }
     if "icon" in definition:
@@ -287,11 +425,11 @@ async def create_binary_sensor(var, definition):
     return sens
 
 
-async def create_sensor(var, definition):
+async def create_sensor(var, definition, vehicle_config):
     """Create a sensor and register with TeslaBLEVehicle using generic setter."""
     config = {
-        CONF_ID: cv.declare_id(sensor.Sensor)(f"tesla_{definition['id']}_sensor"),
-        CONF_NAME: definition["name"],
+        CONF_ID: cv.declare_id(sensor.Sensor)(entity_id(vehicle_config, definition, "sensor")),
+        CONF_NAME: entity_name(vehicle_config, definition),
         CONF_DISABLED_BY_DEFAULT: definition.get("disabled_by_default", False),
         CONF_FORCE_UPDATE: False,
     }
@@ -315,11 +453,11 @@ async def create_sensor(var, definition):
     return sens
 
 
-async def create_text_sensor(var, definition):
+async def create_text_sensor(var, definition, vehicle_config):
     """Create a text sensor and register with TeslaBLEVehicle using generic setter."""
     config = {
-        CONF_ID: cv.declare_id(text_sensor.TextSensor)(f"tesla_{definition['id']}_sensor"),
-        CONF_NAME: definition["name"],
+        CONF_ID: cv.declare_id(text_sensor.TextSensor)(entity_id(vehicle_config, definition, "sensor")),
+        CONF_NAME: entity_name(vehicle_config, definition),
         CONF_DISABLED_BY_DEFAULT: definition.get("disabled_by_default", False),
         CONF_FORCE_UPDATE: False,
     }
@@ -337,11 +475,11 @@ async def create_text_sensor(var, definition):
     return sens
 
 
-async def create_button(var, definition):
+async def create_button(var, definition, vehicle_config):
     """Create a button and register with TeslaBLEVehicle."""
     config = {
-        CONF_ID: cv.declare_id(definition["class"])(f"tesla_{definition['id']}_button"),
-        CONF_NAME: definition["name"],
+        CONF_ID: cv.declare_id(definition["class"])(entity_id(vehicle_config, definition, "button")),
+        CONF_NAME: entity_name(vehicle_config, definition),
         CONF_DISABLED_BY_DEFAULT: definition.get("disabled_by_default", False),
     }
     if "icon" in definition:
@@ -357,11 +495,11 @@ async def create_button(var, definition):
     return btn
 
 
-async def create_switch(var, definition):
+async def create_switch(var, definition, vehicle_config):
     """Create a switch and register with TeslaBLEVehicle."""
     config = {
-        CONF_ID: cv.declare_id(definition["class"])(f"tesla_{definition['id']}_switch"),
-        CONF_NAME: definition["name"],
+        CONF_ID: cv.declare_id(definition["class"])(entity_id(vehicle_config, definition, "switch")),
+        CONF_NAME: entity_name(vehicle_config, definition),
         CONF_DISABLED_BY_DEFAULT: definition.get("disabled_by_default", False),
         CONF_RESTORE_MODE: switch.RESTORE_MODES['RESTORE_DEFAULT_OFF'],
     }
@@ -375,16 +513,16 @@ async def create_switch(var, definition):
     return sw
 
 
-async def create_number(var, definition, config):
+async def create_number(var, definition, vehicle_config):
     """Create a number and register with TeslaBLEVehicle."""
     # Handle dynamic max value from config
     max_val = definition["max"]
     if max_val == "config":
-        max_val = config.get(CONF_CHARGING_AMPS_MAX, 32)
+        max_val = vehicle_config.get(CONF_CHARGING_AMPS_MAX, 32)
     
     num_config = {
-        CONF_ID: cv.declare_id(definition["class"])(f"tesla_{definition['id']}_number"),
-        CONF_NAME: definition["name"],
+        CONF_ID: cv.declare_id(definition["class"])(entity_id(vehicle_config, definition, "number")),
+        CONF_NAME: entity_name(vehicle_config, definition),
         CONF_DISABLED_BY_DEFAULT: definition.get("disabled_by_default", False),
         CONF_MODE: number.NUMBER_MODES['AUTO'],
     }
@@ -405,11 +543,11 @@ async def create_number(var, definition, config):
     return num
 
 
-async def create_lock(var, definition):
+async def create_lock(var, definition, vehicle_config):
     """Create a lock and register with TeslaBLEVehicle."""
     config = {
-        CONF_ID: cv.declare_id(definition["class"])(f"tesla_{definition['id']}_lock"),
-        CONF_NAME: definition["name"],
+        CONF_ID: cv.declare_id(definition["class"])(entity_id(vehicle_config, definition, "lock")),
+        CONF_NAME: entity_name(vehicle_config, definition),
         CONF_DISABLED_BY_DEFAULT: definition.get("disabled_by_default", False),
     }
     if "icon" in definition:
@@ -423,11 +561,11 @@ async def create_lock(var, definition):
     return lck
 
 
-async def create_cover(var, definition):
+async def create_cover(var, definition, vehicle_config):
     """Create a cover and register with TeslaBLEVehicle."""
     config = {
-        CONF_ID: cv.declare_id(definition["class"])(f"tesla_{definition['id']}_cover"),
-        CONF_NAME: definition["name"],
+        CONF_ID: cv.declare_id(definition["class"])(entity_id(vehicle_config, definition, "cover")),
+        CONF_NAME: entity_name(vehicle_config, definition),
         CONF_DISABLED_BY_DEFAULT: definition.get("disabled_by_default", False),
     }
     if "icon" in definition:
@@ -443,13 +581,13 @@ async def create_cover(var, definition):
     return cvr
 
 
-async def create_climate_entity(var, definition):
+async def create_climate_entity(var, definition, vehicle_config):
     """Create a climate entity and register with TeslaBLEVehicle."""
     from esphome.components.climate import CONF_VISUAL
     
     config = {
-        CONF_ID: cv.declare_id(definition["class"])(f"tesla_{definition['id']}_climate"),
-        CONF_NAME: definition["name"],
+        CONF_ID: cv.declare_id(definition["class"])(entity_id(vehicle_config, definition, "climate")),
+        CONF_NAME: entity_name(vehicle_config, definition),
         CONF_DISABLED_BY_DEFAULT: False,
         # Visual settings for the climate entity UI
         CONF_VISUAL: {},
@@ -488,38 +626,97 @@ async def to_code(config):
     cg.add(var.set_infotainment_poll_interval_awake(config[CONF_INFOTAINMENT_POLL_INTERVAL_AWAKE] * 1000))
     cg.add(var.set_infotainment_poll_interval_active(config[CONF_INFOTAINMENT_POLL_INTERVAL_ACTIVE] * 1000))
     cg.add(var.set_infotainment_sleep_timeout(config[CONF_INFOTAINMENT_SLEEP_TIMEOUT] * 1000))
+    cg.add(var.set_session_flush_interval(config[CONF_SESSION_FLUSH_INTERVAL] * 1000))
+    cg.add(var.set_link_idle_timeout(config[CONF_LINK_IDLE_TIMEOUT] * 1000))
+    cg.add(var.set_pause_scan_while_connected(config[CONF_PAUSE_SCAN_WHILE_CONNECTED]))
+    cg.add(var.set_loop_time_budget(config[CONF_LOOP_TIME_BUDGET].total_microseconds))
+    cg.add(var.set_publish_budget(config[CONF_PUBLISH_BUDGET].total_microseconds))
+    if CONF_LISTENER_ID in config:
+        listener = await cg.get_variable(config[CONF_LISTENER_ID])
+        cg.add(var.set_listener(listener))
+    if config[CONF_HEAP_TELEMETRY]:
+        cg.add_define("USE_TESLA_BLE_HEAP_TELEMETRY")
+        esp32.add_idf_sdkconfig_option("CONFIG_HEAP_USE_HOOKS", True)
+    if config[CONF_PROTOCOL_TASK]:
+        cg.add_define("USE_TESLA_BLE_PROTOCOL_TASK")
+        cg.add(var.set_protocol_task(True))
+    if CONF_CAPTURE_BUFFER_SIZE in config:
+        cg.add_define("USE_TESLA_BLE_CAPTURE")
+        cg.add(var.set_capture_buffer_size(config[CONF_CAPTURE_BUFFER_SIZE]))
     
+    # Compile in the update paths this vehicle needs
+    for group, define in ENTITY_GROUPS.items():
+        if config[CONF_ENTITY_GROUPS][group]:
+            cg.add_define(define)
+    if role in DRIVER_ROLES:
+        cg.add_define("USE_TESLA_BLE_DRIVER_CONTROLS")
+    skipped = []
+
     # Create all sensors using data-driven approach with generic setters
-    for definition in BINARY_SENSORS:
-        await create_binary_sensor(var, definition)
+    for definition in enabled_entities(BINARY_SENSORS, config, skipped):
+        await create_binary_sensor(var, definition, config)
     
-    for definition in SENSORS:
-        await create_sensor(var, definition)
+    for definition in enabled_entities(SENSORS, config, skipped):
+        await create_sensor(var, definition, config)
     
-    for definition in TEXT_SENSORS:
-        await create_text_sensor(var, definition)
+    for definition in enabled_entities(TEXT_SENSORS, config, skipped):
+        await create_text_sensor(var, definition, config)
     
-    for definition in BUTTONS:
-        await create_button(var, definition)
+    for definition in enabled_entities(BUTTONS, config, skipped):
+        await create_button(var, definition, config)
     
     # Switches - data-driven approach
-    for definition in SWITCHES:
-        await create_switch(var, definition)
+    for definition in enabled_entities(SWITCHES, config, skipped):
+        await create_switch(var, definition, config)
 
     # Numbers - data-driven approach
-    for definition in NUMBERS:
+    for definition in enabled_entities(NUMBERS, config, skipped):
         await create_number(var, definition, config)
 
     # Locks - combined entities for doors and charge port
-    for definition in LOCKS:
-        await create_lock(var, definition)
+    for definition in enabled_entities(LOCKS, config, skipped):
+        await create_lock(var, definition, config)
 
     # Covers - combined entities for trunk, frunk, windows
-    for definition in COVERS:
-        await create_cover(var, definition)
+    for definition in enabled_entities(COVERS, config, skipped):
+        await create_cover(var, definition, config)
 
     # Climate - HVAC control
-    await create_climate_entity(var, CLIMATE)
+    for definition in enabled_entities([CLIMATE], config, skipped):
+        await create_climate_entity(var, definition, config)
+
+    if skipped:
+        _LOGGER.info(
+            "tesla_ble_vehicle %s (%s): left out %d entities: %s",
+            config[CONF_VIN], role, len(skipped), ", ".join(skipped),
+        )
+
+
+def _final_validate(config):
+    # Entity IDs and names are derived from name_prefix, so with several
+    # vehicles on one node every instance needs a distinct one
+    vehicles = fv.full_config.get().get("tesla_ble_vehicle", [])
+    if len(vehicles) > 1:
+        prefixes = [vehicle.get(CONF_NAME_PREFIX) for vehicle in vehicles]
+        if None in prefixes or len(set(prefixes)) != len(prefixes):
+            raise cv.Invalid(
+                f"Each tesla_ble_vehicle needs a unique '{CONF_NAME_PREFIX}' when more than one is configured"
+            )
+
+    # The listener and bluetooth_proxy need the scanner running at all times
+    scanners = [name for name in ("tesla_ble_listener", "bluetooth_proxy") if name in fv.full_config.get()]
+    if scanners:
+        for vehicle in vehicles:
+            if vehicle.get(CONF_PAUSE_SCAN_WHILE_CONNECTED):
+                _LOGGER.warning(
+                    "'%s' is ignored because %s also uses the BLE scanner",
+                    CONF_PAUSE_SCAN_WHILE_CONNECTED, " and ".join(scanners),
+                )
+                vehicle[CONF_PAUSE_SCAN_WHILE_CONNECTED] = False
+    return config
+
+
+FINAL_VALIDATE_SCHEMA = _final_validate
 
 
 # =============================================================================
@@ -542,6 +739,15 @@ TESLA_FORCE_UPDATE_ACTION_SCHEMA = cv.Schema({
     cv.Required(CONF_ID): cv.use_id(TeslaBLEVehicle),
 })
 
+TESLA_CAPTURE_ACTION_SCHEMA = cv.Schema({
+    cv.Required(CONF_ID): cv.use_id(TeslaBLEVehicle),
+})
+
+TESLA_BENCHMARK_ACTION_SCHEMA = cv.Schema({
+    cv.Required(CONF_ID): cv.use_id(TeslaBLEVehicle),
+    cv.Optional("iterations", default=100): cv.templatable(cv.int_range(min=1, max=1000)),
+})
+
 TESLA_SET_CHARGING_ACTION_SCHEMA = cv.Schema({
     cv.Required(CONF_ID): cv.use_id(TeslaBLEVehicle),
     cv.Required("state"): cv.templatable(cv.boolean),
@@ -625,3 +831,28 @@ async def tesla_set_charging_limit_to_code(config, action_id, template_arg, args
     template_ = await cg.templatable(config["limit"], args, int)
     cg.add(var.set_limit(template_))
     return var
+
+
+@automation.register_action(
+    "tesla_ble_vehicle.benchmark", BenchmarkAction, TESLA_BENCHMARK_ACTION_SCHEMA, synchronous=True
+)
+async def tesla_benchmark_to_code(config, action_id, template_arg, args):
+    # Only builds that use the action carry the benchmark and the heap hooks
+    cg.add_define("USE_TESLA_BLE_BENCHMARK")
+    esp32.add_idf_sdkconfig_option("CONFIG_HEAP_USE_HOOKS", True)
+    paren = await cg.get_variable(config[CONF_ID])
+    var = cg.new_Pvariable(action_id, template_arg, paren)
+    template_ = await cg.templatable(config["iterations"], args, cg.uint32)
+    cg.add(var.set_iterations(template_))
+    return var
+
+
+@automation.register_action(
+    "tesla_ble_vehicle.dump_capture", DumpCaptureAction, TESLA_CAPTURE_ACTION_SCHEMA, synchronous=True
+)
+async def tesla_dump_capture_to_code(config, action_id, template_arg, args):
+    # Without capture_buffer_size the capture uses its default size
+    cg.add_define("USE_TESLA_BLE_CAPTURE")
+    paren = await cg.get_variable(config[CONF_ID])
+    return cg.new_Pvariable(action_id, template_arg, paren)
+
@@ -2,8 +2,11 @@
 #include "storage_adapter_impl.h"
 #include "tesla_ble_vehicle.h"
 #include <esphome/core/log.h>
+#include <esphome/core/helpers.h>
 #include <tb_utils.h>
 #include <algorithm>
+#include <cinttypes>
+#include <cstring>
 
 namespace esphome {
 namespace tesla_ble_vehicle {
@@ -27,6 +30,7 @@ void BleAdapterImpl::disconnect() {
 bool BleAdapterImpl::write(const std::vector<uint8_t>& data) {
     if (!parent_->is_connected()) return false;
     
+    HeapScopeGuard heap_scope(HeapScope::TX_ENQUEUE);
     ESP_LOGV(ADAPTER_TAG, "BLE TX: %s", TeslaBLE::format_hex(data.data(), data.size()).c_str());
     
     // Fragment message
@@ -65,7 +69,17 @@ void BleAdapterImpl::process_write_queue() {
         chunk.write_type, chunk.auth_req
     );
     
+    if (auto* link_manager = parent_->get_link_manager()) {
+        link_manager->record_write_result(err == ESP_OK);
+        if (err == ESP_OK) link_manager->record_tx(chunk.data.size());
+    }
+
     if (err == ESP_OK) {
+#ifdef USE_TESLA_BLE_CAPTURE
+        if (auto* capture = parent_->get_traffic_capture()) {
+            capture->record(TrafficCapture::Direction::TX, conn_id, chunk.data.data(), chunk.data.size());
+        }
+#endif
         write_queue_.pop();
     } else {
         ESP_LOGW(ADAPTER_TAG, "BLE write failed: %s", esp_err_to_name(err));
@@ -88,7 +102,12 @@ StorageAdapterImpl::~StorageAdapterImpl() {
     }
 }
 
-bool StorageAdapterImpl::initialize() {
+static const char *const LEGACY_NAMESPACE = "storage";
+static const char *const KEY_INDEX_KEY = "~index";
+static const char *const LEGACY_MIGRATED_KEY = "migrated";
+static const size_t NVS_KEY_MAX_LENGTH = 15;
+
+bool StorageAdapterImpl::initialize(const std::string& vin) {
     esp_err_t err = nvs_flash_init();
     if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
         ESP_ERROR_CHECK(nvs_flash_erase());
@@ -97,56 +116,260 @@ bool StorageAdapterImpl::initialize() {
     
     if (err != ESP_OK) return false;
     
-    err = nvs_open("storage", NVS_READWRITE, &storage_handle_);
+    if (vin.empty()) {
+        namespace_ = LEGACY_NAMESPACE;
+    } else {
+        char ns[16];
+        snprintf(ns, sizeof(ns), "tb_%08" PRIx32, fnv1_hash(vin));
+        namespace_ = ns;
+    }
+    
+    err = nvs_open(namespace_.c_str(), NVS_READWRITE, &storage_handle_);
     if (err != ESP_OK) return false;
     
     initialized_ = true;
+    load_key_index();
+    if (namespace_ != LEGACY_NAMESPACE) {
+        migrate_legacy_keys();
+    }
+    
+    ESP_LOGD(ADAPTER_TAG, "Storage namespace: %s", namespace_.c_str());
     return true;
 }
 
-const char* StorageAdapterImpl::map_key(const std::string& key) {
+std::string StorageAdapterImpl::map_key(const std::string& key) {
+    if (key.empty()) return "";
     if (key == "session_vcsec") return "tk_vcsec";
     if (key == "session_infotainment") return "tk_infotainment";
-    if (key == "private_key") return "private_key"; // Unchanged
-    return nullptr;
+    // '~' prefixes are reserved for hashed keys and the index itself
+    if (key.size() <= NVS_KEY_MAX_LENGTH && key[0] != '~') return key;
+    
+    auto it = key_index_.find(key);
+    if (it != key_index_.end()) return it->second;
+    
+    // "~" + 8 hex digits, probing with a numeric suffix on collision
+    const uint32_t hash = fnv1_hash(key);
+    char candidate[NVS_KEY_MAX_LENGTH + 1];
+    for (uint16_t probe = 0; probe < 1000; probe++) {
+        if (probe == 0) {
+            snprintf(candidate, sizeof(candidate), "~%08" PRIx32, hash);
+        } else {
+            snprintf(candidate, sizeof(candidate), "~%08" PRIx32 ".%u", hash, static_cast<unsigned>(probe));
+        }
+        bool taken = false;
+        for (const auto& pair : key_index_) {
+            if (pair.second == candidate) {
+                taken = true;
+                break;
+            }
+        }
+        if (taken) continue;
+        
+        key_index_[key] = candidate;
+        if (!save_key_index()) {
+            ESP_LOGW(ADAPTER_TAG, "Failed to persist key index for %s", key.c_str());
+        }
+        return candidate;
+    }
+    
+    ESP_LOGE(ADAPTER_TAG, "No free NVS key for %s", key.c_str());
+    return "";
+}
+
+// Index blob format: repeated "<logical key>\0<nvs key>\0"
+void StorageAdapterImpl::load_key_index() {
+    key_index_.clear();
+    
+    size_t size = 0;
+    if (nvs_get_blob(storage_handle_, KEY_INDEX_KEY, nullptr, &size) != ESP_OK || size == 0) return;
+    
+    std::vector<char> blob(size);
+    if (nvs_get_blob(storage_handle_, KEY_INDEX_KEY, blob.data(), &size) != ESP_OK) return;
+    
+    size_t pos = 0;
+    while (pos < size) {
+        const char* logical = blob.data() + pos;
+        size_t logical_len = strnlen(logical, size - pos);
+        pos += logical_len + 1;
+        if (pos >= size) break;
+        
+        const char* nvs_key = blob.data() + pos;
+        size_t nvs_key_len = strnlen(nvs_key, size - pos);
+        pos += nvs_key_len + 1;
+        if (pos > size || nvs_key_len == 0 || nvs_key_len > NVS_KEY_MAX_LENGTH) break;
+        
+        key_index_[std::string(logical, logical_len)] = std::string(nvs_key, nvs_key_len);
+    }
+}
+
+bool StorageAdapterImpl::save_key_index() {
+    std::vector<char> blob;
+    for (const auto& pair : key_index_) {
+        blob.insert(blob.end(), pair.first.begin(), pair.first.end());
+        blob.push_back('\0');
+        blob.insert(blob.end(), pair.second.begin(), pair.second.end());
+        blob.push_back('\0');
+    }
+    
+    if (nvs_set_blob(storage_handle_, KEY_INDEX_KEY, blob.data(), blob.size()) != ESP_OK) return false;
+    if (nvs_commit(storage_handle_) != ESP_OK) return false;
+    flash_writes_++;
+    return true;
+}
+
+void StorageAdapterImpl::migrate_legacy_keys() {
+    nvs_handle_t legacy;
+    if (nvs_open(LEGACY_NAMESPACE, NVS_READWRITE, &legacy) != ESP_OK) return;
+    
+    // Only the first vehicle to start after an upgrade inherits the legacy key
+    // and sessions; any other vehicle pairs with its own key.
+    uint8_t migrated = 0;
+    if (nvs_get_u8(legacy, LEGACY_MIGRATED_KEY, &migrated) == ESP_OK && migrated) {
+        nvs_close(legacy);
+        return;
+    }
+    
+    static const char *const LEGACY_KEYS[] = {"private_key", "tk_vcsec", "tk_infotainment"};
+    size_t copied = 0;
+    for (const char* key : LEGACY_KEYS) {
+        size_t size = 0;
+        if (nvs_get_blob(legacy, key, nullptr, &size) != ESP_OK || size == 0) continue;
+        
+        // Never overwrite data already stored for this vehicle
+        size_t existing = 0;
+        if (nvs_get_blob(storage_handle_, key, nullptr, &existing) == ESP_OK) continue;
+        
+        std::vector<uint8_t> data(size);
+        if (nvs_get_blob(legacy, key, data.data(), &size) != ESP_OK) continue;
+        if (nvs_set_blob(storage_handle_, key, data.data(), size) == ESP_OK) copied++;
+    }
+    
+    if (copied > 0 && nvs_commit(storage_handle_) == ESP_OK) {
+        ESP_LOGI(ADAPTER_TAG, "Migrated %u legacy storage keys to %s", static_cast<unsigned>(copied),
+                 namespace_.c_str());
+    }
+    
+    // Legacy entries are left in place so a downgrade keeps working
+    nvs_set_u8(legacy, LEGACY_MIGRATED_KEY, 1);
+    nvs_commit(legacy);
+    nvs_close(legacy);
 }
 
 bool StorageAdapterImpl::load(const std::string& key, std::vector<uint8_t>& buffer) {
     if (!initialized_) return false;
     
-    const char* nvs_key = map_key(key);
-    if (!nvs_key) return false;
+    // Serve from the write-behind cache when possible
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+        buffer = it->second.data;
+        return true;
+    }
+    
+    const std::string nvs_key = map_key(key);
+    if (nvs_key.empty()) return false;
     
     size_t required_size = 0;
-    esp_err_t err = nvs_get_blob(storage_handle_, nvs_key, nullptr, &required_size);
+    esp_err_t err = nvs_get_blob(storage_handle_, nvs_key.c_str(), nullptr, &required_size);
     if (err != ESP_OK || required_size == 0) return false;
     
     buffer.resize(required_size);
-    err = nvs_get_blob(storage_handle_, nvs_key, buffer.data(), &required_size);
-    return err == ESP_OK;
+    err = nvs_get_blob(storage_handle_, nvs_key.c_str(), buffer.data(), &required_size);
+    if (err != ESP_OK) return false;
+    
+    cache_[key].data = buffer;
+    return true;
 }
 
 bool StorageAdapterImpl::save(const std::string& key, const std::vector<uint8_t>& buffer) {
     if (!initialized_) return false;
+    if (map_key(key).empty()) return false;
     
-    const char* nvs_key = map_key(key);
-    if (!nvs_key) return false;
+    CachedBlob& entry = cache_[key];
+    if (!entry.dirty && !entry.data.empty() && entry.data == buffer) {
+        // Unchanged since the last commit - nothing to write
+        writes_avoided_++;
+        return true;
+    }
     
-    esp_err_t err = nvs_set_blob(storage_handle_, nvs_key, buffer.data(), buffer.size());
-    if (err != ESP_OK) return false;
+    entry.data = buffer;
+    if (is_write_through_key(key)) {
+        entry.dirty = false;
+        return write_blob(key, buffer);
+    }
     
-    return nvs_commit(storage_handle_) == ESP_OK;
+    if (entry.dirty) {
+        // Coalesced with a pending write that has not reached flash yet
+        writes_avoided_++;
+    }
+    entry.dirty = true;
+    if (dirty_since_ == 0) {
+        dirty_since_ = std::max<uint32_t>(millis(), 1);
+    }
+    return true;
 }
 
 bool StorageAdapterImpl::remove(const std::string& key) {
     if (!initialized_) return false;
     
-    const char* nvs_key = map_key(key);
-    if (!nvs_key) return false;
+    const std::string nvs_key = map_key(key);
+    if (nvs_key.empty()) return false;
     
-    esp_err_t err = nvs_erase_key(storage_handle_, nvs_key);
+    cache_.erase(key);
+    
+    esp_err_t err = nvs_erase_key(storage_handle_, nvs_key.c_str());
+    if (err == ESP_ERR_NVS_NOT_FOUND) return true;
     return (err == ESP_OK) && (nvs_commit(storage_handle_) == ESP_OK);
 }
 
+void StorageAdapterImpl::loop() {
+    if (dirty_since_ == 0) return;
+    if (millis() - dirty_since_ < flush_interval_) return;
+    flush();
+}
+
+bool StorageAdapterImpl::flush() {
+    if (!initialized_ || dirty_since_ == 0) return true;
+    
+    bool ok = true;
+    std::vector<CachedBlob*> staged;
+    for (auto& pair : cache_) {
+        if (!pair.second.dirty) continue;
+        const std::string nvs_key = map_key(pair.first);
+        if (nvs_key.empty() || nvs_set_blob(storage_handle_, nvs_key.c_str(), pair.second.data.data(),
+                                     pair.second.data.size()) != ESP_OK) {
+            ESP_LOGW(ADAPTER_TAG, "Failed to stage %s for flash", pair.first.c_str());
+            ok = false;
+            continue;
+        }
+        staged.push_back(&pair.second);
+    }
+    
+    // Entries stay dirty until the commit succeeds, so a failed commit is
+    // retried on the next flush
+    if (nvs_commit(storage_handle_) != ESP_OK) {
+        ESP_LOGW(ADAPTER_TAG, "NVS commit failed");
+        return false;
+    }
+    for (CachedBlob* entry : staged) entry->dirty = false;
+    flash_writes_ += staged.size();
+    dirty_since_ = ok ? 0 : std::max<uint32_t>(millis(), 1);
+    
+    ESP_LOGD(ADAPTER_TAG, "Flushed session cache (%u flash writes, %u writes avoided)",
+             flash_writes_, writes_avoided_);
+    return ok;
+}
+
+bool StorageAdapterImpl::write_blob(const std::string& key, const std::vector<uint8_t>& data) {
+    const std::string nvs_key = map_key(key);
+    if (nvs_key.empty()) return false;
+    
+    esp_err_t err = nvs_set_blob(storage_handle_, nvs_key.c_str(), data.data(), data.size());
+    if (err != ESP_OK) return false;
+    
+    if (nvs_commit(storage_handle_) != ESP_OK) return false;
+    flash_writes_++;
+    return true;
+}
+
 } // namespace tesla_ble_vehicle
 } // namespace esphome
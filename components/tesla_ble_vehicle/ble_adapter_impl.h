@@ -2,6 +2,7 @@
 
 #include "adapters.h"
 #include <esphome/components/ble_client/ble_client.h>
+#include <esphome/core/defines.h>
 #include <esphome/core/log.h>
 #include <vector>
 #include <queue>
@@ -36,11 +37,13 @@ public:
     // Clear queues (on disconnect)
     void clear_queues();
 
+    bool has_pending_writes() const { return !write_queue_.empty(); }
+
 private:
     TeslaBLEVehicle* parent_;
     std::queue<BLETXChunk> write_queue_;
     
-    static const size_t BLOCK_LENGTH = 18; // Safe BLE MTU chunk size
+    static constexpr size_t BLOCK_LENGTH = 18; // Safe BLE MTU chunk size
 };
 
 } // namespace tesla_ble_vehicle
@@ -0,0 +1,204 @@
+#include "ble_coordinator.h"
+#include "tesla_ble_vehicle.h"
+#include <esphome/core/defines.h>
+#include <esphome/core/hal.h>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+static const char *const COORDINATOR_TAG = "tesla_ble_coordinator";
+
+namespace espbt = esphome::esp32_ble_tracker;
+
+// A connection attempt that has not finished by then no longer blocks others
+static constexpr uint32_t CONNECT_SLOT_TIMEOUT_MS = 30000;
+// Hold the heavy poll token at least this long (the request has to go on air
+// before its RX window shows activity) and at most this long
+static constexpr uint32_t HEAVY_POLL_MIN_HOLD_MS = 1000;
+static constexpr uint32_t HEAVY_POLL_MAX_HOLD_MS = 10000;
+// Other vehicles' polls wait this long after a user command
+static constexpr uint32_t COMMAND_PRIORITY_WINDOW_MS = 3000;
+static constexpr uint32_t AIRTIME_WINDOW_MS = 30000;
+
+BleCoordinator* BleCoordinator::get() {
+    static BleCoordinator instance;
+    return &instance;
+}
+
+void BleCoordinator::register_vehicle(TeslaBLEVehicle* vehicle) {
+    if (find(vehicle) != nullptr) return;
+    vehicles_.push_back({vehicle, espbt::ClientState::INIT, 0, false});
+    ESP_LOGD(COORDINATOR_TAG, "Registered vehicle %u", static_cast<unsigned>(vehicles_.size()));
+}
+
+BleCoordinator::Entry* BleCoordinator::find(const TeslaBLEVehicle* vehicle) {
+    for (auto& entry : vehicles_) {
+        if (entry.vehicle == vehicle) return &entry;
+    }
+    return nullptr;
+}
+
+// =============================================================================
+// Connection slots
+// =============================================================================
+
+void BleCoordinator::on_client_state(TeslaBLEVehicle* vehicle, espbt::ClientState state) {
+    Entry* entry = find(vehicle);
+    if (entry == nullptr) return;
+    entry->state = state;
+
+    if (state == espbt::ClientState::CONNECTING && connecting_ == nullptr) {
+        connecting_ = vehicle;
+        connecting_since_ = millis();
+    }
+}
+
+void BleCoordinator::update_slots(uint32_t now) {
+    if (connecting_ != nullptr) {
+        Entry* entry = find(connecting_);
+        const bool done = entry == nullptr || connecting_->is_connected() ||
+                          entry->state == espbt::ClientState::IDLE ||
+                          entry->state == espbt::ClientState::INIT;
+        if (done || now - connecting_since_ >= CONNECT_SLOT_TIMEOUT_MS) {
+            connecting_ = nullptr;
+        }
+    }
+
+    size_t established = 0;
+    for (const auto& entry : vehicles_) {
+        if (entry.vehicle->is_connected()) established++;
+    }
+
+    for (auto& entry : vehicles_) {
+        auto* reconnect = entry.vehicle->get_reconnect_manager();
+        if (reconnect == nullptr) continue;
+
+        bool granted = entry.vehicle->is_connected() || connecting_ == entry.vehicle;
+        if (!granted) {
+            granted = connecting_ == nullptr && established < MAX_CONNECTIONS;
+        }
+        reconnect->set_slot_granted(granted);
+    }
+}
+
+// =============================================================================
+// Poll scheduling
+// =============================================================================
+
+bool BleCoordinator::request_heavy_poll(TeslaBLEVehicle* vehicle) {
+    if (!polls_allowed(vehicle)) return false;
+    if (heavy_holder_ != nullptr && heavy_holder_ != vehicle) return false;
+
+    heavy_holder_ = vehicle;
+    heavy_since_ = millis();
+    return true;
+}
+
+void BleCoordinator::update_heavy_token(uint32_t now) {
+    if (heavy_holder_ == nullptr) return;
+
+    const uint32_t held = now - heavy_since_;
+    auto* link = heavy_holder_->get_link_manager();
+    const bool burst_over = link == nullptr || !link->rx_window_active() || !heavy_holder_->is_connected();
+    if ((held >= HEAVY_POLL_MIN_HOLD_MS && burst_over) || held >= HEAVY_POLL_MAX_HOLD_MS) {
+        heavy_holder_ = nullptr;
+    }
+}
+
+void BleCoordinator::note_command(TeslaBLEVehicle* vehicle) {
+    command_owner_ = vehicle;
+    command_at_ = millis();
+}
+
+bool BleCoordinator::polls_allowed(const TeslaBLEVehicle* vehicle) const {
+    if (command_owner_ == nullptr || command_owner_ == vehicle) return true;
+    return millis() - command_at_ >= COMMAND_PRIORITY_WINDOW_MS;
+}
+
+// =============================================================================
+// Scanner
+// =============================================================================
+
+void BleCoordinator::set_scan_pause(TeslaBLEVehicle* vehicle, bool pause) {
+    Entry* entry = find(vehicle);
+    if (entry == nullptr || entry->scan_pause_vote == pause) return;
+    entry->scan_pause_vote = pause;
+    update_scan();
+}
+
+void BleCoordinator::update_scan() {
+    size_t votes = 0;
+    for (const auto& entry : vehicles_) {
+        if (entry.scan_pause_vote) votes++;
+    }
+    // A vehicle that is still disconnected needs advertisements to reconnect
+    bool pause = votes > 0 && votes == vehicles_.size();
+#if defined(USE_TESLA_BLE_LISTENER) || defined(USE_BLUETOOTH_PROXY)
+    // Presence tracking and proxying both live off the scanner
+    pause = false;
+#endif
+    if (pause == scan_paused_) return;
+
+    auto* tracker = espbt::global_esp32_ble_tracker;
+    if (tracker == nullptr) return;
+    if (pause) {
+        if (!tracker->get_scan_continuous()) return;  // Someone else owns the scanner
+        ESP_LOGD(COORDINATOR_TAG, "Pausing BLE scan - all vehicles connected");
+        tracker->set_scan_continuous(false);
+        tracker->stop_scan();
+        scan_paused_ = true;
+    } else {
+        ESP_LOGD(COORDINATOR_TAG, "Resuming BLE scan");
+        scan_paused_ = false;
+        tracker->set_scan_continuous(true);
+        tracker->start_scan();
+    }
+}
+
+// =============================================================================
+// Air time
+// =============================================================================
+
+void BleCoordinator::publish_airtime(uint32_t now) {
+    if (airtime_window_start_ == 0) {
+        airtime_window_start_ = now;
+        for (auto& entry : vehicles_) {
+            auto* link = entry.vehicle->get_link_manager();
+            entry.airtime_at_window_start = link ? link->get_airtime_us() : 0;
+        }
+        return;
+    }
+
+    const uint32_t window = now - airtime_window_start_;
+    if (window < AIRTIME_WINDOW_MS) return;
+
+    const float window_us = window * 1000.0f;
+    float total = 0.0f;
+    for (auto& entry : vehicles_) {
+        auto* link = entry.vehicle->get_link_manager();
+        if (link == nullptr) continue;
+        const uint64_t airtime = link->get_airtime_us();
+        const float utilization = (airtime - entry.airtime_at_window_start) * 100.0f / window_us;
+        entry.airtime_at_window_start = airtime;
+        total += utilization;
+        if (auto* state_manager = entry.vehicle->get_state_manager()) {
+            state_manager->update_diagnostic_sensor("airtime_utilization", utilization);
+        }
+    }
+    for (auto& entry : vehicles_) {
+        if (auto* state_manager = entry.vehicle->get_state_manager()) {
+            state_manager->update_diagnostic_sensor("airtime_total_utilization", total);
+        }
+    }
+    airtime_window_start_ = now;
+}
+
+void BleCoordinator::loop() {
+    const uint32_t now = millis();
+    update_slots(now);
+    update_heavy_token(now);
+    publish_airtime(now);
+}
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <esphome/components/esp32_ble_tracker/esp32_ble_tracker.h>
+#include <cstdint>
+#include <vector>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+class TeslaBLEVehicle; // Forward declaration
+
+/**
+ * @brief Shares the radio between several TeslaBLEVehicle instances on one node
+ *
+ * Every vehicle registers with the single coordinator instance. It hands
+ * out connection slots (one connection attempt at a time, at most
+ * MAX_CONNECTIONS links), a token for heavy infotainment polls so two RX
+ * bursts never overlap, and holds back polls of other vehicles while a user
+ * command is in flight. It also publishes air-time utilization per vehicle
+ * and in total.
+ *
+ * The scanner is shared by every ble_client on the node, so it is paused
+ * only while every registered vehicle is connected and has asked for it,
+ * and never when the node also listens for advertisements.
+ */
+class BleCoordinator {
+public:
+    // Matches ESPHome's default esp32_ble max_connections
+    static constexpr size_t MAX_CONNECTIONS = 3;
+
+    static BleCoordinator* get();
+
+    void register_vehicle(TeslaBLEVehicle* vehicle);
+    // The first registered vehicle drives loop()
+    bool is_leader(const TeslaBLEVehicle* vehicle) const { return !vehicles_.empty() && vehicles_[0].vehicle == vehicle; }
+    size_t vehicle_count() const { return vehicles_.size(); }
+
+    void on_client_state(TeslaBLEVehicle* vehicle, esp32_ble_tracker::ClientState state);
+    void loop();
+
+    // Heavy infotainment poll token; released once the poll's RX burst ends
+    bool request_heavy_poll(TeslaBLEVehicle* vehicle);
+    // User commands take priority over other vehicles' polls
+    void note_command(TeslaBLEVehicle* vehicle);
+    bool polls_allowed(const TeslaBLEVehicle* vehicle) const;
+
+    // Vote to pause scanning while this vehicle is connected; false withdraws it
+    void set_scan_pause(TeslaBLEVehicle* vehicle, bool pause);
+
+private:
+    struct Entry {
+        TeslaBLEVehicle* vehicle;
+        esp32_ble_tracker::ClientState state;
+        uint64_t airtime_at_window_start;
+        bool scan_pause_vote;
+    };
+
+    std::vector<Entry> vehicles_;
+
+    // Connection slots
+    TeslaBLEVehicle* connecting_{nullptr};
+    uint32_t connecting_since_{0};
+
+    // Heavy poll token
+    TeslaBLEVehicle* heavy_holder_{nullptr};
+    uint32_t heavy_since_{0};
+
+    // Command priority
+    const TeslaBLEVehicle* command_owner_{nullptr};
+    uint32_t command_at_{0};
+
+    // Air time window
+    uint32_t airtime_window_start_{0};
+
+    // Set only if we stopped a continuous scan, so only we restart it
+    bool scan_paused_{false};
+
+    Entry* find(const TeslaBLEVehicle* vehicle);
+    void update_slots(uint32_t now);
+    void update_heavy_token(uint32_t now);
+    void publish_airtime(uint32_t now);
+    void update_scan();
+};
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
@@ -0,0 +1,423 @@
+#include "ble_link_manager.h"
+#include "tesla_ble_vehicle.h"
+#include <esphome/core/hal.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+// Minimum spacing between connection parameter requests; peers may reject
+// (or disconnect on) rapid back-to-back updates
+static constexpr uint32_t LINK_PARAMS_REQUEST_SPACING_MS = 2000;
+
+// Largest LL payload allowed by data length extension
+static constexpr uint16_t LINK_MAX_DATA_LENGTH = 251;
+
+// An infotainment response is complete once notifications pause this long;
+// a window that never sees any RX is dropped after the timeout
+static constexpr uint32_t RX_WINDOW_IDLE_MS = 500;
+static constexpr uint32_t RX_WINDOW_TIMEOUT_MS = 10000;
+static constexpr uint32_t RX_LATENCY_MAX_MS = 5000;
+
+// Link quality: RSSI poll period, EWMA weight of each new sample, and the
+// RSSI range mapped onto a 0-100 score
+static constexpr uint32_t RSSI_READ_INTERVAL_MS = 10000;
+static constexpr float LINK_QUALITY_ALPHA = 0.2f;
+static constexpr float RSSI_SCORE_FLOOR = -95.0f;
+static constexpr float RSSI_SCORE_CEILING = -60.0f;
+static constexpr float LINK_QUALITY_FAIR_BELOW = 60.0f;
+static constexpr float LINK_QUALITY_POOR_BELOW = 30.0f;
+
+BleLinkManager::BleLinkManager(TeslaBLEVehicle* parent) : parent_(parent) {}
+
+// =============================================================================
+// Connection lifecycle
+// =============================================================================
+
+void BleLinkManager::on_connected(const esp_bd_addr_t bda) {
+    memcpy(remote_bda_, bda, sizeof(esp_bd_addr_t));
+    connected_ = true;
+    mode_ = LinkMode::UNKNOWN;
+    requested_mode_ = LinkMode::UNKNOWN;
+    last_request_ = 0;
+    tx_phy_ = rx_phy_ = 0;
+    tx_data_length_ = rx_data_length_ = 0;
+    // Failure history is per connection; RSSI starts fresh from the first read
+    rssi_valid_ = false;
+    last_rssi_read_ = 0;
+    write_failure_rate_ = 0.0f;
+    response_timeout_rate_ = 0.0f;
+    update_quality();
+    negotiate_phy_and_data_length();
+    notify_activity();
+}
+
+void BleLinkManager::on_disconnected() {
+    connected_ = false;
+    data_length_pending_ = false;
+    mode_ = LinkMode::UNKNOWN;
+    requested_mode_ = LinkMode::UNKNOWN;
+    rx_measuring_ = false;
+    tx_pending_ = false;
+    awaiting_rx_ = false;
+}
+
+// =============================================================================
+// Connection parameters
+// =============================================================================
+
+void BleLinkManager::notify_activity() {
+    last_activity_ = millis();
+    if (connected_ && requested_mode_ != LinkMode::ACTIVE) {
+        request_mode(LinkMode::ACTIVE);
+    }
+}
+
+void BleLinkManager::update_tx_state(bool pending) {
+    if (pending) {
+        tx_pending_ = true;
+        // Only the infotainment burst counts; a VCSEC poll fits in the idle
+        // profile's connection events
+        if (rx_measuring_) {
+            rx_window_tx_seen_ = true;
+            notify_activity();
+        }
+    } else if (tx_pending_) {
+        tx_pending_ = false;
+        tx_drained_at_ = millis();
+        awaiting_rx_ = true;
+    }
+}
+
+void BleLinkManager::loop() {
+    if (!connected_) return;
+
+    const uint32_t now = millis();
+    if (rx_measuring_) {
+        if (rx_notifications_ > 0 && now - rx_last_at_ >= RX_WINDOW_IDLE_MS) {
+            finish_rx_measurement();
+        } else if (rx_notifications_ == 0 && now - rx_window_start_ >= RX_WINDOW_TIMEOUT_MS) {
+            rx_measuring_ = false;
+            // Only a request that actually went on air can time out; a
+            // NO_WAKE_SKIP poll of a sleeping car sends nothing
+            if (rx_window_tx_seen_) record_response(false);
+        }
+    }
+
+    if (now - last_rssi_read_ >= RSSI_READ_INTERVAL_MS) {
+        last_rssi_read_ = now;
+        esp_err_t err = esp_ble_gap_read_rssi(remote_bda_);
+        if (err != ESP_OK) {
+            ESP_LOGV(LINK_TAG, "RSSI read failed: %s", esp_err_to_name(err));
+        }
+    }
+
+    if (requested_mode_ == LinkMode::ACTIVE && now - last_activity_ >= idle_timeout_) {
+        request_mode(LinkMode::IDLE);
+    } else if (requested_mode_ != mode_ && now - last_request_ >= LINK_PARAMS_REQUEST_SPACING_MS) {
+        // Previous request was rejected or superseded - retry
+        request_mode(requested_mode_);
+    }
+}
+
+void BleLinkManager::request_mode(LinkMode mode) {
+    requested_mode_ = mode;
+    if (mode == mode_) return;
+
+    const uint32_t now = millis();
+    if (last_request_ != 0 && now - last_request_ < LINK_PARAMS_REQUEST_SPACING_MS) {
+        return; // loop() retries once the spacing has elapsed
+    }
+    last_request_ = now;
+
+    const LinkParams& params = (mode == LinkMode::ACTIVE) ? LINK_PARAMS_ACTIVE : LINK_PARAMS_IDLE;
+    esp_ble_conn_update_params_t conn_params = {};
+    memcpy(conn_params.bda, remote_bda_, sizeof(esp_bd_addr_t));
+    conn_params.min_int = params.min_interval;
+    conn_params.max_int = params.max_interval;
+    conn_params.latency = params.latency;
+    conn_params.timeout = params.timeout;
+
+    esp_err_t err = esp_ble_gap_update_conn_params(&conn_params);
+    if (err != ESP_OK) {
+        ESP_LOGW(LINK_TAG, "Failed to request %s connection parameters: %s",
+                 mode == LinkMode::ACTIVE ? "active" : "idle", esp_err_to_name(err));
+        return;
+    }
+    ESP_LOGD(LINK_TAG, "Requested %s connection parameters", mode == LinkMode::ACTIVE ? "active" : "idle");
+}
+
+// =============================================================================
+// PHY and data length
+// =============================================================================
+
+void BleLinkManager::negotiate_phy_and_data_length() {
+    // Both are requests: the controller and the car settle on what they
+    // both support, and the result arrives as a GAP event. A refusal simply
+    // leaves the link on 1M PHY / 27 byte payloads.
+#ifdef CONFIG_BT_BLE_50_FEATURES_SUPPORTED
+    // all_phys = 0: both the TX and RX preference below apply
+    esp_err_t err = esp_ble_gap_set_preferred_phy(remote_bda_, 0, ESP_BLE_GAP_PHY_2M_PREF_MASK,
+                                                  ESP_BLE_GAP_PHY_2M_PREF_MASK, ESP_BLE_GAP_PHY_OPTIONS_NO_PREF);
+    if (err != ESP_OK) {
+        ESP_LOGD(LINK_TAG, "2M PHY request failed: %s", esp_err_to_name(err));
+    }
+#else
+    // Controller is BLE 4.2 only - the link stays on 1M PHY
+    tx_phy_ = rx_phy_ = 1;
+    publish_phy();
+#endif
+
+    esp_err_t dle_err = esp_ble_gap_set_pkt_data_len(remote_bda_, LINK_MAX_DATA_LENGTH);
+    if (dle_err != ESP_OK) {
+        ESP_LOGD(LINK_TAG, "Data length extension request failed: %s", esp_err_to_name(dle_err));
+    }
+    data_length_pending_ = dle_err == ESP_OK;
+}
+
+void BleLinkManager::publish_phy() {
+    auto* state_manager = parent_->get_state_manager();
+    if (state_manager == nullptr) return;
+
+    std::string value = phy_name(tx_phy_);
+    if (rx_phy_ != tx_phy_) {
+        value += "/";
+        value += phy_name(rx_phy_);
+    }
+    state_manager->update_diagnostic_text_sensor("link_phy", value);
+}
+
+const char* BleLinkManager::phy_name(uint8_t phy) {
+    switch (phy) {
+        case 1: return "1M";
+        case 2: return "2M";
+        case 3: return "Coded";
+        default: return "unknown";
+    }
+}
+
+// =============================================================================
+// RX throughput
+// =============================================================================
+
+void BleLinkManager::begin_rx_measurement() {
+    rx_measuring_ = true;
+    rx_window_start_ = millis();
+    rx_first_at_ = 0;
+    rx_last_at_ = 0;
+    rx_bytes_ = 0;
+    rx_notifications_ = 0;
+    rx_window_tx_seen_ = false;
+}
+
+void BleLinkManager::record_rx(size_t bytes) {
+    const uint32_t now = millis();
+    add_airtime(bytes);
+    if (awaiting_rx_) {
+        awaiting_rx_ = false;
+        const uint32_t latency = now - tx_drained_at_;
+        // Anything slower is not a reply to what we sent (or the car woke up first)
+        if (latency <= RX_LATENCY_MAX_MS) {
+            rx_latency_avg_ = (rx_latency_avg_ == 0.0f)
+                                  ? latency
+                                  : rx_latency_avg_ + LINK_QUALITY_ALPHA * (latency - rx_latency_avg_);
+            ESP_LOGV(LINK_TAG, "RX latency %ums (avg %.0fms)", latency, rx_latency_avg_);
+            if (auto* state_manager = parent_->get_state_manager()) {
+                state_manager->update_diagnostic_sensor("rx_latency", rx_latency_avg_);
+            }
+        }
+    }
+
+    if (!rx_measuring_) return;
+
+    notify_activity();
+    if (rx_notifications_ == 0) rx_first_at_ = now;
+    rx_last_at_ = now;
+    rx_bytes_ += bytes;
+    rx_notifications_++;
+}
+
+void BleLinkManager::finish_rx_measurement() {
+    rx_measuring_ = false;
+    record_response(true);
+
+    // A single notification says nothing about sustained throughput
+    const uint32_t duration = rx_last_at_ - rx_first_at_;
+    if (rx_notifications_ < 2 || duration == 0) return;
+
+    const float bytes_per_second = rx_bytes_ * 1000.0f / duration;
+    ESP_LOGD(LINK_TAG, "Infotainment RX: %u bytes in %u notifications over %ums (%.0f B/s, %s PHY, %u byte PDU)",
+             rx_bytes_, rx_notifications_, duration, bytes_per_second, phy_name(rx_phy_), rx_data_length_);
+
+    if (auto* state_manager = parent_->get_state_manager()) {
+        state_manager->update_diagnostic_sensor("rx_throughput", bytes_per_second);
+    }
+}
+
+// =============================================================================
+// Air time
+// =============================================================================
+
+void BleLinkManager::record_tx(size_t bytes) {
+    add_airtime(bytes);
+}
+
+void BleLinkManager::add_airtime(size_t att_payload) {
+    // One LL data PDU plus its empty acknowledgement. ATT (3) + L2CAP (4)
+    // headers and LL preamble/access address/header/CRC (10) surround the
+    // payload; each packet is followed by T_IFS. Fragmentation at short data
+    // lengths is ignored - this is an estimate for comparing links.
+    const uint32_t us_per_byte = (tx_phy_ == 2) ? 4 : 8;
+    const uint32_t packet_us = (att_payload + 17) * us_per_byte;
+    const uint32_t ack_us = 10 * us_per_byte;
+    airtime_us_ += packet_us + ack_us + 2 * 150;
+}
+
+// =============================================================================
+// Link quality
+// =============================================================================
+
+void BleLinkManager::record_write_result(bool success) {
+    write_failure_rate_ += LINK_QUALITY_ALPHA * ((success ? 0.0f : 1.0f) - write_failure_rate_);
+    if (!success) update_quality();
+}
+
+void BleLinkManager::record_response(bool received) {
+    response_timeout_rate_ += LINK_QUALITY_ALPHA * ((received ? 0.0f : 1.0f) - response_timeout_rate_);
+    update_quality();
+}
+
+void BleLinkManager::update_quality() {
+    float rssi_score = 100.0f;
+    if (rssi_valid_) {
+        rssi_score = (rssi_avg_ - RSSI_SCORE_FLOOR) * 100.0f / (RSSI_SCORE_CEILING - RSSI_SCORE_FLOOR);
+        rssi_score = std::max(0.0f, std::min(100.0f, rssi_score));
+    }
+    quality_score_ = rssi_score * (1.0f - write_failure_rate_) * (1.0f - response_timeout_rate_);
+
+    LinkQuality quality = LinkQuality::GOOD;
+    if (quality_score_ < LINK_QUALITY_POOR_BELOW) {
+        quality = LinkQuality::POOR;
+    } else if (quality_score_ < LINK_QUALITY_FAIR_BELOW) {
+        quality = LinkQuality::FAIR;
+    }
+    if (quality != quality_) {
+        ESP_LOGI(LINK_TAG, "Link quality %s -> %s (score %.0f, RSSI %.0f dBm, write failures %.0f%%, timeouts %.0f%%)",
+                 quality_name(quality_), quality_name(quality), quality_score_, rssi_avg_,
+                 write_failure_rate_ * 100.0f, response_timeout_rate_ * 100.0f);
+        quality_ = quality;
+    }
+
+    if (auto* state_manager = parent_->get_state_manager()) {
+        state_manager->update_diagnostic_sensor("link_quality", quality_score_);
+    }
+}
+
+const char* BleLinkManager::quality_name(LinkQuality quality) {
+    switch (quality) {
+        case LinkQuality::GOOD: return "good";
+        case LinkQuality::FAIR: return "fair";
+        case LinkQuality::POOR: return "poor";
+        default: return "unknown";
+    }
+}
+
+// =============================================================================
+// GAP events
+// =============================================================================
+
+void BleLinkManager::gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param) {
+    switch (event) {
+    case ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT: {
+        if (!connected_ || !is_remote(param->update_conn_params.bda)) break;
+        if (param->update_conn_params.status != ESP_BT_STATUS_SUCCESS) {
+            ESP_LOGW(LINK_TAG, "Connection parameter update rejected: %d", param->update_conn_params.status);
+            break;
+        }
+
+        conn_interval_ = param->update_conn_params.conn_int;
+        conn_latency_ = param->update_conn_params.latency;
+
+        // Classify by the interval actually granted (the peer may pick its own)
+        const LinkMode new_mode = (conn_interval_ <= LINK_PARAMS_ACTIVE.max_interval) ? LinkMode::ACTIVE : LinkMode::IDLE;
+        if (new_mode != mode_) {
+            if (mode_ != LinkMode::UNKNOWN) switch_count_++;
+            mode_ = new_mode;
+        }
+
+        ESP_LOGD(LINK_TAG, "Connection parameters: interval=%.2fms latency=%u timeout=%ums (%s)",
+                 conn_interval_ * 1.25f, conn_latency_, param->update_conn_params.timeout * 10,
+                 mode_ == LinkMode::ACTIVE ? "active" : "idle");
+
+        if (auto* state_manager = parent_->get_state_manager()) {
+            state_manager->update_diagnostic_sensor("connection_interval", conn_interval_ * 1.25f);
+            state_manager->update_diagnostic_sensor("connection_latency", static_cast<float>(conn_latency_));
+            state_manager->update_diagnostic_sensor("link_param_switches", static_cast<float>(switch_count_));
+        }
+        break;
+    }
+
+#ifdef CONFIG_BT_BLE_50_FEATURES_SUPPORTED
+    case ESP_GAP_BLE_PHY_UPDATE_COMPLETE_EVT: {
+        if (!connected_ || !is_remote(param->phy_update.bda)) break;
+        if (param->phy_update.status != ESP_BT_STATUS_SUCCESS) {
+            ESP_LOGD(LINK_TAG, "PHY update failed: %d - staying on current PHY", param->phy_update.status);
+            break;
+        }
+        tx_phy_ = param->phy_update.tx_phy;
+        rx_phy_ = param->phy_update.rx_phy;
+        ESP_LOGI(LINK_TAG, "PHY updated: TX %s, RX %s", phy_name(tx_phy_), phy_name(rx_phy_));
+        publish_phy();
+        break;
+    }
+#endif
+
+    case ESP_GAP_BLE_READ_RSSI_COMPLETE_EVT: {
+        if (!connected_ || !is_remote(param->read_rssi_cmpl.remote_addr)) break;
+        if (param->read_rssi_cmpl.status != ESP_BT_STATUS_SUCCESS) break;
+
+        const float rssi = param->read_rssi_cmpl.rssi;
+        rssi_avg_ = rssi_valid_ ? rssi_avg_ + LINK_QUALITY_ALPHA * (rssi - rssi_avg_) : rssi;
+        rssi_valid_ = true;
+        if (auto* state_manager = parent_->get_state_manager()) {
+            state_manager->update_diagnostic_sensor("link_rssi", rssi);
+        }
+        update_quality();
+        break;
+    }
+
+    case ESP_GAP_BLE_SET_PKT_LENGTH_COMPLETE_EVT: {
+        // This event carries no peer address. Every vehicle's link manager
+        // sees it, so only the one with a request outstanding takes it
+        if (!connected_ || !data_length_pending_) break;
+        data_length_pending_ = false;
+        if (param->pkt_data_length_cmpl.status != ESP_BT_STATUS_SUCCESS) {
+            ESP_LOGD(LINK_TAG, "Data length extension not accepted: %d", param->pkt_data_length_cmpl.status);
+            break;
+        }
+        tx_data_length_ = param->pkt_data_length_cmpl.params.tx_len;
+        rx_data_length_ = param->pkt_data_length_cmpl.params.rx_len;
+        ESP_LOGI(LINK_TAG, "Data length: TX %u, RX %u bytes", tx_data_length_, rx_data_length_);
+        if (auto* state_manager = parent_->get_state_manager()) {
+            state_manager->update_diagnostic_sensor("link_data_length", static_cast<float>(rx_data_length_));
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+bool BleLinkManager::is_remote(const esp_bd_addr_t bda) const {
+    return memcmp(bda, remote_bda_, sizeof(esp_bd_addr_t)) == 0;
+}
+
+void BleLinkManager::dump_config() {
+    ESP_LOGCONFIG(LINK_TAG, "  Link idle timeout: %ums", idle_timeout_);
+}
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
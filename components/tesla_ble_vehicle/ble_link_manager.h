@@ -0,0 +1,147 @@
+#pragma once
+
+#include <esphome/components/esp32_ble/ble.h>
+#include <esphome/core/log.h>
+#include <esp_gap_ble_api.h>
+#include <cstdint>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+static const char *const LINK_TAG = "tesla_ble_link";
+
+class TeslaBLEVehicle; // Forward declaration
+
+/**
+ * @brief BLE connection parameter profile
+ *
+ * Intervals are in 1.25 ms units, timeout in 10 ms units (as used by
+ * esp_ble_gap_update_conn_params).
+ */
+struct LinkParams {
+    uint16_t min_interval;
+    uint16_t max_interval;
+    uint16_t latency;
+    uint16_t timeout;
+};
+
+// Short interval while commands or polls are in flight
+static constexpr LinkParams LINK_PARAMS_ACTIVE = {0x000C, 0x0018, 0, 400};    // 15-30 ms, 4 s
+// Long interval with slave latency once the link has been quiet for a while
+static constexpr LinkParams LINK_PARAMS_IDLE = {0x00F0, 0x0140, 4, 600};      // 300-400 ms, 6 s
+
+/**
+ * @brief Manages link-layer behaviour of the vehicle connection
+ *
+ * Switches connection parameters between an active (low latency) and an
+ * idle (low duty cycle) profile based on commands, infotainment bursts and
+ * connection bring-up, asks
+ * for LE 2M PHY and extended data length on connect, and measures RX
+ * throughput of infotainment polls and the latency of the car's replies. Connection RSSI, write failures and
+ * response timeouts are folded into a link quality score that the poll
+ * scheduler uses to back off on marginal links.
+ */
+class BleLinkManager : public esp32_ble::GAPEventHandler {
+public:
+    enum class LinkMode : uint8_t { UNKNOWN, ACTIVE, IDLE };
+    enum class LinkQuality : uint8_t { GOOD, FAIR, POOR };
+
+    explicit BleLinkManager(TeslaBLEVehicle* parent);
+
+    void set_idle_timeout(uint32_t timeout_ms) { idle_timeout_ = timeout_ms; }
+
+    // Connection lifecycle
+    void on_connected(const esp_bd_addr_t bda);
+    void on_disconnected();
+
+    // Called for user commands; bring-up and infotainment bursts count on
+    // their own. Scheduled VCSEC polls and their replies do not, or their
+    // period (10 s by default) would hold the link active for good.
+    void notify_activity();
+    // Called every loop with whether the adapter still has chunks queued
+    void update_tx_state(bool pending);
+    void loop();
+
+    // RX throughput measurement, one window per infotainment poll
+    void begin_rx_measurement();
+    void record_rx(size_t bytes);
+
+    // Link quality inputs
+    void record_write_result(bool success);
+    void record_tx(size_t bytes);
+
+    void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param) override;
+
+    LinkMode get_mode() const { return mode_; }
+    uint32_t get_switch_count() const { return switch_count_; }
+    LinkQuality get_quality() const { return quality_; }
+    float get_quality_score() const { return quality_score_; }
+    bool rx_window_active() const { return rx_measuring_; }
+    // Estimated radio time spent on this link since boot
+    uint64_t get_airtime_us() const { return airtime_us_; }
+    void dump_config();
+
+private:
+    TeslaBLEVehicle* parent_;
+
+    esp_bd_addr_t remote_bda_{};
+    bool connected_{false};
+
+    // Connection parameters
+    LinkMode mode_{LinkMode::UNKNOWN};
+    LinkMode requested_mode_{LinkMode::UNKNOWN};
+    uint32_t idle_timeout_{30000};
+    uint32_t last_activity_{0};
+    uint32_t last_request_{0};
+    uint32_t switch_count_{0};
+    uint16_t conn_interval_{0};
+    uint16_t conn_latency_{0};
+
+    // PHY / data length
+    uint8_t tx_phy_{0};
+    uint8_t rx_phy_{0};
+    uint16_t tx_data_length_{0};
+    uint16_t rx_data_length_{0};
+    // Set while our esp_ble_gap_set_pkt_data_len() awaits its completion event
+    bool data_length_pending_{false};
+
+    // RX throughput window
+    bool rx_measuring_{false};
+    uint32_t rx_window_start_{0};
+    uint32_t rx_first_at_{0};
+    uint32_t rx_last_at_{0};
+    uint32_t rx_bytes_{0};
+    uint32_t rx_notifications_{0};
+    bool rx_window_tx_seen_{false};
+
+    // RX latency: last TX chunk handed to the stack -> next notification
+    bool tx_pending_{false};
+    bool awaiting_rx_{false};
+    uint32_t tx_drained_at_{0};
+    float rx_latency_avg_{0.0f};
+
+    uint64_t airtime_us_{0};
+
+    // Link quality (exponentially weighted)
+    uint32_t last_rssi_read_{0};
+    float rssi_avg_{0.0f};
+    bool rssi_valid_{false};
+    float write_failure_rate_{0.0f};
+    float response_timeout_rate_{0.0f};
+    float quality_score_{100.0f};
+    LinkQuality quality_{LinkQuality::GOOD};
+
+    void request_mode(LinkMode mode);
+    void negotiate_phy_and_data_length();
+    void finish_rx_measurement();
+    void record_response(bool received);
+    void update_quality();
+    void add_airtime(size_t att_payload);
+    static const char* quality_name(LinkQuality quality);
+    void publish_phy();
+    static const char* phy_name(uint8_t phy);
+    bool is_remote(const esp_bd_addr_t bda) const;
+};
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
@@ -0,0 +1,100 @@
+#include "connection_timeline.h"
+#include <algorithm>
+#include <iterator>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+void ConnectionTimeline::reset(uint32_t now) {
+    started_at = now;
+    std::fill(std::begin(phase_ms), std::end(phase_ms), NOT_REACHED);
+    cached_handles = false;
+}
+
+void ConnectionTimelineRecorder::begin(uint32_t now) {
+    // An attempt that never opened a link is replaced rather than kept, so
+    // the ring only holds connections that got somewhere
+    if (count_ == 0 || history_[head_].reached(ConnectionPhase::LINK_OPEN)) {
+        head_ = (count_ == 0) ? 0 : (head_ + 1) % HISTORY;
+        count_ = std::min(count_ + 1, HISTORY);
+    }
+    history_[head_].reset(now);
+    active_ = true;
+}
+
+bool ConnectionTimelineRecorder::mark(ConnectionPhase phase, uint32_t now) {
+    if (!active_ || phase >= ConnectionPhase::COUNT) return false;
+
+    ConnectionTimeline& timeline = history_[head_];
+    if (timeline.reached(phase)) return false;
+
+    timeline.phase_ms[static_cast<size_t>(phase)] = now - timeline.started_at;
+    return true;
+}
+
+template<typename Filter>
+uint32_t ConnectionTimelineRecorder::median_of(ConnectionPhase phase, Filter filter) const {
+    uint32_t values[HISTORY];
+    size_t n = 0;
+    for (size_t i = 0; i < count_; i++) {
+        if (history_[i].reached(phase) && filter(history_[i])) {
+            values[n++] = history_[i].get(phase);
+        }
+    }
+    if (n == 0) return ConnectionTimeline::NOT_REACHED;
+
+    std::sort(values, values + n);
+    return (n % 2) ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+uint32_t ConnectionTimelineRecorder::median(ConnectionPhase phase) const {
+    return median_of(phase, [](const ConnectionTimeline&) { return true; });
+}
+
+uint32_t ConnectionTimelineRecorder::median(ConnectionPhase phase, bool cached_handles) const {
+    return median_of(phase, [cached_handles](const ConnectionTimeline& timeline) {
+        return timeline.cached_handles == cached_handles;
+    });
+}
+
+const char* ConnectionTimelineRecorder::phase_name(ConnectionPhase phase) {
+    switch (phase) {
+        case ConnectionPhase::LINK_OPEN: return "open";
+        case ConnectionPhase::MTU: return "mtu";
+        case ConnectionPhase::DISCOVERY: return "discovery";
+        case ConnectionPhase::READY: return "ready";
+        case ConnectionPhase::FIRST_RX: return "first_rx";
+        case ConnectionPhase::VCSEC_SESSION: return "vcsec";
+        case ConnectionPhase::INFOTAINMENT_SESSION: return "infotainment";
+        default: return "unknown";
+    }
+}
+
+const char* ConnectionTimelineRecorder::phase_sensor_id(ConnectionPhase phase) {
+    switch (phase) {
+        case ConnectionPhase::LINK_OPEN: return "connect_open_time";
+        case ConnectionPhase::MTU: return "connect_mtu_time";
+        case ConnectionPhase::DISCOVERY: return "connect_discovery_time";
+        case ConnectionPhase::READY: return "connect_ready_time";
+        case ConnectionPhase::FIRST_RX: return "connect_first_rx_time";
+        case ConnectionPhase::VCSEC_SESSION: return "connect_vcsec_time";
+        case ConnectionPhase::INFOTAINMENT_SESSION: return "connect_infotainment_time";
+        default: return "";
+    }
+}
+
+const char* ConnectionTimelineRecorder::phase_median_sensor_id(ConnectionPhase phase) {
+    switch (phase) {
+        case ConnectionPhase::LINK_OPEN: return "connect_open_median";
+        case ConnectionPhase::MTU: return "connect_mtu_median";
+        case ConnectionPhase::DISCOVERY: return "connect_discovery_median";
+        case ConnectionPhase::READY: return "connect_ready_median";
+        case ConnectionPhase::FIRST_RX: return "connect_first_rx_median";
+        case ConnectionPhase::VCSEC_SESSION: return "connect_vcsec_median";
+        case ConnectionPhase::INFOTAINMENT_SESSION: return "connect_infotainment_median";
+        default: return "";
+    }
+}
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+/**
+ * @brief Milestones of a single BLE connection, in the order they normally occur
+ */
+enum class ConnectionPhase : uint8_t {
+    LINK_OPEN = 0,          // ESP_GATTC_OPEN_EVT
+    MTU,                    // ESP_GATTC_CFG_MTU_EVT
+    DISCOVERY,              // ESP_GATTC_SEARCH_CMPL_EVT
+    READY,                  // ESP_GATTC_REG_FOR_NOTIFY_EVT (node ESTABLISHED)
+    FIRST_RX,               // first notification received
+    VCSEC_SESSION,          // first authenticated VCSEC response
+    INFOTAINMENT_SESSION,   // first authenticated infotainment response
+    COUNT,
+};
+
+/**
+ * @brief Per-connection timestamps, stored as ms offsets from the attempt start
+ */
+struct ConnectionTimeline {
+    static constexpr uint32_t NOT_REACHED = UINT32_MAX;
+
+    uint32_t started_at{0};
+    uint32_t phase_ms[static_cast<size_t>(ConnectionPhase::COUNT)];
+    bool cached_handles{false};  // GATT handles came from the cache
+
+    void reset(uint32_t now);
+    bool reached(ConnectionPhase phase) const { return phase_ms[static_cast<size_t>(phase)] != NOT_REACHED; }
+    uint32_t get(ConnectionPhase phase) const { return phase_ms[static_cast<size_t>(phase)]; }
+};
+
+/**
+ * @brief Ring of the last HISTORY connection timelines
+ *
+ * begin() starts a new timeline (reusing the current slot if the previous
+ * attempt never opened a link), mark() records the first time each phase is
+ * reached, and median() summarises a phase across the ring.
+ */
+class ConnectionTimelineRecorder {
+public:
+    static constexpr size_t HISTORY = 8;
+
+    void begin(uint32_t now);
+    bool active() const { return active_; }
+    void end() { active_ = false; }
+
+    // Returns true if the phase was reached for the first time on this connection
+    bool mark(ConnectionPhase phase, uint32_t now);
+    void set_cached_handles() { history_[head_].cached_handles = true; }
+
+    const ConnectionTimeline& current() const { return history_[head_]; }
+    uint32_t median(ConnectionPhase phase) const;
+    // Median over the connections that did (or did not) use cached handles
+    uint32_t median(ConnectionPhase phase, bool cached_handles) const;
+
+    static const char* phase_name(ConnectionPhase phase);
+    static const char* phase_sensor_id(ConnectionPhase phase);
+    static const char* phase_median_sensor_id(ConnectionPhase phase);
+
+private:
+    template<typename Filter>
+    uint32_t median_of(ConnectionPhase phase, Filter filter) const;
+
+    ConnectionTimeline history_[HISTORY];
+    size_t head_{0};
+    size_t count_{0};
+    bool active_{false};
+};
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
@@ -0,0 +1,110 @@
+#include "heap_stats.h"
+#include <sdkconfig.h>
+#include <esp_attr.h>
+#include <atomic>
+#include <cstddef>
+
+#ifdef USE_TESLA_BLE_HEAP_TELEMETRY
+#include "vehicle_state_manager.h"
+#include <esphome/core/hal.h>
+#include <esp_heap_caps.h>
+#include <algorithm>
+#include <cstdio>
+#endif
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+#ifdef CONFIG_HEAP_USE_HOOKS
+static std::atomic<uint32_t> alloc_count{0};
+
+bool has_alloc_counter() { return true; }
+uint32_t get_alloc_count() { return alloc_count.load(std::memory_order_relaxed); }
+#else
+bool has_alloc_counter() { return false; }
+uint32_t get_alloc_count() { return 0; }
+#endif
+
+#ifdef USE_TESLA_BLE_HEAP_TELEMETRY
+static constexpr size_t SCOPE_COUNT = static_cast<size_t>(HeapScope::COUNT);
+static constexpr uint32_t HEAP_PUBLISH_INTERVAL_MS = 60000;
+
+static const char *const SCOPE_NAMES[] = {"none", "tx", "rx", "state", "command"};
+static_assert(sizeof(SCOPE_NAMES) / sizeof(SCOPE_NAMES[0]) == SCOPE_COUNT,
+              "SCOPE_NAMES must cover every HeapScope");
+
+// Written by the heap hook, which may run on either core
+static std::atomic<uint8_t> current_scope{static_cast<uint8_t>(HeapScope::NONE)};
+static std::atomic<uint32_t> scope_allocs[SCOPE_COUNT];
+static std::atomic<uint32_t> scope_bytes[SCOPE_COUNT];
+
+// Only touched from the main loop
+static uint32_t scope_peak[SCOPE_COUNT];
+static uint32_t last_publish = 0;
+
+void heap_scope_enter(HeapScope scope, HeapScope& previous, uint32_t& bytes_at_enter) {
+    previous = static_cast<HeapScope>(current_scope.exchange(static_cast<uint8_t>(scope)));
+    bytes_at_enter = scope_bytes[static_cast<size_t>(scope)].load(std::memory_order_relaxed);
+}
+
+void heap_scope_exit(HeapScope scope, HeapScope previous, uint32_t bytes_at_enter) {
+    const size_t index = static_cast<size_t>(scope);
+    const uint32_t pass_bytes = scope_bytes[index].load(std::memory_order_relaxed) - bytes_at_enter;
+    scope_peak[index] = std::max(scope_peak[index], pass_bytes);
+    current_scope.store(static_cast<uint8_t>(previous));
+}
+
+void publish_heap_stats(VehicleStateManager* state_manager) {
+    const uint32_t now = millis();
+    if (now - last_publish < HEAP_PUBLISH_INTERVAL_MS) return;
+    last_publish = now;
+    if (state_manager == nullptr) return;
+
+    state_manager->update_diagnostic_sensor(
+        "heap_min_free", static_cast<float>(heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT)));
+    state_manager->update_diagnostic_sensor(
+        "heap_largest_block", static_cast<float>(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT)));
+
+    // "<scope> <allocs>/<bytes>B peak <bytes>B" per scope with allocations
+    uint32_t total_allocs = 0;
+    uint32_t total_bytes = 0;
+    char breakdown[200];
+    size_t len = 0;
+    breakdown[0] = '\0';
+    for (size_t i = 1; i < SCOPE_COUNT; i++) {
+        const uint32_t allocs = scope_allocs[i].exchange(0);
+        const uint32_t bytes = scope_bytes[i].exchange(0);
+        total_allocs += allocs;
+        total_bytes += bytes;
+        if (allocs > 0 && len < sizeof(breakdown)) {
+            len += snprintf(breakdown + len, sizeof(breakdown) - len, "%s%s %u/%uB peak %uB",
+                            len == 0 ? "" : ", ", SCOPE_NAMES[i], allocs, bytes, scope_peak[i]);
+        }
+        scope_peak[i] = 0;
+    }
+    state_manager->update_diagnostic_sensor("component_allocations", static_cast<float>(total_allocs));
+    state_manager->update_diagnostic_sensor("component_alloc_bytes", static_cast<float>(total_bytes));
+    state_manager->update_diagnostic_text_sensor("heap_scope_breakdown", len > 0 ? breakdown : "none");
+}
+#endif
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
+
+#ifdef CONFIG_HEAP_USE_HOOKS
+// Called by heap_caps for every allocation, possibly from an ISR or with the
+// flash cache disabled, so keep these in IRAM and lock-free
+extern "C" IRAM_ATTR void esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+    using namespace esphome::tesla_ble_vehicle;
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+#ifdef USE_TESLA_BLE_HEAP_TELEMETRY
+    const uint8_t scope = current_scope.load(std::memory_order_relaxed);
+    if (scope != static_cast<uint8_t>(HeapScope::NONE)) {
+        scope_allocs[scope].fetch_add(1, std::memory_order_relaxed);
+        scope_bytes[scope].fetch_add(size, std::memory_order_relaxed);
+    }
+#endif
+}
+
+extern "C" IRAM_ATTR void esp_heap_trace_free_hook(void* ptr) {}
+#endif
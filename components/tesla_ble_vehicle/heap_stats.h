@@ -0,0 +1,68 @@
+#pragma once
+
+#include <esphome/core/defines.h>
+#include <cstdint>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+class VehicleStateManager; // Forward declaration
+
+/**
+ * @brief Heap allocation counter fed by the ESP-IDF heap hooks
+ *
+ * Needs CONFIG_HEAP_USE_HOOKS; without it no allocations are counted and
+ * has_alloc_counter() returns false.
+ */
+bool has_alloc_counter();
+uint32_t get_alloc_count();
+
+/**
+ * @brief Hot paths whose allocations are accounted separately
+ */
+enum class HeapScope : uint8_t {
+    NONE = 0,
+    TX_ENQUEUE,     // fragmenting a message into the write queue
+    RX_NOTIFY,      // handing a notification to the library
+    STATE_UPDATE,   // state manager fan-out
+    COMMAND,        // building and sending a command
+    COUNT,
+};
+
+#ifdef USE_TESLA_BLE_HEAP_TELEMETRY
+void heap_scope_enter(HeapScope scope, HeapScope& previous, uint32_t& bytes_at_enter);
+void heap_scope_exit(HeapScope scope, HeapScope previous, uint32_t bytes_at_enter);
+
+// Per-scope counts, peak bytes per pass and heap watermarks, once a minute
+void publish_heap_stats(VehicleStateManager* state_manager);
+#endif
+
+/**
+ * @brief Attributes allocations in the enclosing scope to `scope`
+ *
+ * Scopes nest; allocations count towards the innermost one. Allocations
+ * made by other tasks while a scope is open are counted too, so the
+ * numbers are an upper bound. Compiles to nothing without heap telemetry.
+ */
+class HeapScopeGuard {
+public:
+#ifdef USE_TESLA_BLE_HEAP_TELEMETRY
+    explicit HeapScopeGuard(HeapScope scope) : scope_(scope) { heap_scope_enter(scope_, previous_, bytes_at_enter_); }
+    ~HeapScopeGuard() { heap_scope_exit(scope_, previous_, bytes_at_enter_); }
+#else
+    explicit HeapScopeGuard(HeapScope) {}
+#endif
+
+    HeapScopeGuard(const HeapScopeGuard&) = delete;
+    HeapScopeGuard& operator=(const HeapScopeGuard&) = delete;
+
+#ifdef USE_TESLA_BLE_HEAP_TELEMETRY
+private:
+    HeapScope scope_;
+    HeapScope previous_{HeapScope::NONE};
+    uint32_t bytes_at_enter_{0};
+#endif
+};
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
@@ -0,0 +1,60 @@
+#include "key_worker.h"
+#include <esphome/core/hal.h>
+#include <esphome/core/log.h>
+#include <sdkconfig.h>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+static const char *const KEY_WORKER_TAG = "tesla_ble_key_worker";
+
+// mbedTLS ECC key generation needs a few KB of stack
+static constexpr uint32_t KEY_WORKER_STACK_SIZE = 8192;
+static constexpr UBaseType_t KEY_WORKER_PRIORITY = 1;
+
+bool KeyWorker::start(const char* name, Job job) {
+    if (busy_) return false;
+
+    job_ = std::move(job);
+    finished_ = false;
+    busy_ = true;
+    started_at_ = millis();
+
+#if CONFIG_FREERTOS_UNICORE
+    const BaseType_t core = tskNO_AFFINITY;
+#else
+    const BaseType_t core = xPortGetCoreID() == 0 ? 1 : 0;
+#endif
+    if (xTaskCreatePinnedToCore(task_entry, name, KEY_WORKER_STACK_SIZE, this,
+                                KEY_WORKER_PRIORITY, nullptr, core) != pdPASS) {
+        ESP_LOGE(KEY_WORKER_TAG, "Failed to start %s task", name);
+        job_ = nullptr;
+        busy_ = false;
+        return false;
+    }
+    ESP_LOGD(KEY_WORKER_TAG, "Started %s", name);
+    return true;
+}
+
+void KeyWorker::task_entry(void* arg) {
+    auto* worker = static_cast<KeyWorker*>(arg);
+    {
+        std::lock_guard<std::recursive_mutex> lock(worker->vehicle_mutex_);
+        worker->job_();
+    }
+    worker->finished_ = true;
+    vTaskDelete(nullptr);
+}
+
+bool KeyWorker::poll_finished() {
+    if (!busy_ || !finished_) return false;
+
+    duration_ms_ = millis() - started_at_;
+    job_ = nullptr;
+    busy_ = false;
+    ESP_LOGD(KEY_WORKER_TAG, "Job finished in %ums", duration_ms_);
+    return true;
+}
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
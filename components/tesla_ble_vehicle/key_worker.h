@@ -0,0 +1,48 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+/**
+ * @brief Runs slow key operations (ECC key generation, pairing) off the main loop
+ *
+ * Each job runs on a short-lived FreeRTOS task, pinned to the core the main
+ * loop is not on where there is one. The job holds the vehicle mutex for
+ * its whole run; the loop try-locks the same mutex and skips protocol work
+ * until the job is done. Completion is picked up in loop() through
+ * poll_finished(), so entity updates stay on the main task.
+ */
+class KeyWorker {
+public:
+    using Job = std::function<void()>;
+
+    explicit KeyWorker(std::recursive_mutex& vehicle_mutex) : vehicle_mutex_(vehicle_mutex) {}
+
+    // Returns false if a job is still running or the task could not be created
+    bool start(const char* name, Job job);
+    // True from start() until poll_finished() has reported the completion
+    bool busy() const { return busy_; }
+    // Returns true exactly once, from the main loop, after the job finished
+    bool poll_finished();
+
+    uint32_t get_last_duration() const { return duration_ms_; }
+
+private:
+    std::recursive_mutex& vehicle_mutex_;
+    Job job_;
+    bool busy_{false};
+    std::atomic<bool> finished_{false};
+    uint32_t started_at_{0};
+    uint32_t duration_ms_{0};
+
+    static void task_entry(void* arg);
+};
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
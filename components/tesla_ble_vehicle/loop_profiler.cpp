@@ -0,0 +1,84 @@
+#include "loop_profiler.h"
+#include "vehicle_state_manager.h"
+#include <esphome/core/hal.h>
+#include <esphome/core/log.h>
+#include <esp_rom_sys.h>
+#include <algorithm>
+#include <cstdio>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+static const char *const PROFILER_TAG = "tesla_ble_loop";
+
+static constexpr uint32_t PROFILER_PUBLISH_INTERVAL_MS = 60000;
+
+static const char *const PHASE_NAMES[] = {"vehicle", "write", "notify", "publish"};
+static_assert(sizeof(PHASE_NAMES) / sizeof(PHASE_NAMES[0]) == static_cast<size_t>(LoopPhase::COUNT),
+              "PHASE_NAMES must cover every LoopPhase");
+
+uint32_t LoopProfiler::elapsed_us(uint32_t start_cycles) {
+    // Unsigned subtraction survives the counter wrapping around
+    return (now_cycles() - start_cycles) / esp_rom_get_cpu_ticks_per_us();
+}
+
+void LoopProfiler::add(LoopPhase phase, uint32_t start_cycles) {
+    const uint32_t us = elapsed_us(start_cycles);
+    PhaseStats& stats = phases_[static_cast<size_t>(phase)];
+    stats.max_us = std::max(stats.max_us, us);
+    stats.total_us += us;
+    stats.count++;
+    stats.iteration_us += us;
+}
+
+void LoopProfiler::end_iteration(uint32_t start_cycles) {
+    const uint32_t us = elapsed_us(start_cycles);
+    loop_.max_us = std::max(loop_.max_us, us);
+    loop_.total_us += us;
+    loop_.count++;
+
+    if (us > budget_us_) {
+        over_budget_++;
+        ESP_LOGW(PROFILER_TAG, "loop() took %.1fms (budget %.1fms): vehicle %.1fms, write %.1fms, "
+                 "publish %.1fms; notify %.1fms since last loop",
+                 us / 1000.0f, budget_us_ / 1000.0f,
+                 phases_[static_cast<size_t>(LoopPhase::VEHICLE_LOOP)].iteration_us / 1000.0f,
+                 phases_[static_cast<size_t>(LoopPhase::WRITE_QUEUE)].iteration_us / 1000.0f,
+                 phases_[static_cast<size_t>(LoopPhase::PUBLISH)].iteration_us / 1000.0f,
+                 phases_[static_cast<size_t>(LoopPhase::NOTIFY)].iteration_us / 1000.0f);
+    }
+    for (auto& stats : phases_) {
+        stats.iteration_us = 0;
+    }
+}
+
+void LoopProfiler::publish(VehicleStateManager* state_manager) {
+    const uint32_t now = millis();
+    if (now - last_publish_ < PROFILER_PUBLISH_INTERVAL_MS) return;
+    last_publish_ = now;
+    if (state_manager == nullptr || loop_.count == 0) return;
+
+    state_manager->update_diagnostic_sensor("loop_time_max", loop_.max_us / 1000.0f);
+    state_manager->update_diagnostic_sensor("loop_time_mean", loop_.total_us / 1000.0f / loop_.count);
+    state_manager->update_diagnostic_sensor("loop_over_budget", static_cast<float>(over_budget_));
+
+    // "<phase> <mean>/<max>ms" per phase that ran in this interval
+    char breakdown[160];
+    size_t len = 0;
+    for (size_t i = 0; i < static_cast<size_t>(LoopPhase::COUNT); i++) {
+        const PhaseStats& stats = phases_[i];
+        if (stats.count == 0 || len >= sizeof(breakdown)) continue;
+        len += snprintf(breakdown + len, sizeof(breakdown) - len, "%s%s %.2f/%.1fms",
+                        len == 0 ? "" : ", ", PHASE_NAMES[i],
+                        stats.total_us / 1000.0f / stats.count, stats.max_us / 1000.0f);
+    }
+    if (len > 0) state_manager->update_diagnostic_text_sensor("loop_time_breakdown", breakdown);
+
+    loop_ = PhaseStats{};
+    for (auto& stats : phases_) {
+        stats = PhaseStats{};
+    }
+}
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <esp_cpu.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+class VehicleStateManager; // Forward declaration
+
+/**
+ * @brief Parts of our work that run on the ESPHome main loop
+ */
+enum class LoopPhase : uint8_t {
+    VEHICLE_LOOP = 0,   // TeslaBLE::Vehicle::loop()
+    WRITE_QUEUE,        // BleAdapterImpl::process_write_queue()
+    NOTIFY,             // notification handling in gattc_event_handler
+    PUBLISH,            // state manager updates (nested in the phases above)
+    COUNT,
+};
+
+/**
+ * @brief Cycle-counter timing of TeslaBLEVehicle's share of the main loop
+ *
+ * Phases are timed with the CPU cycle counter, which costs a few cycles per
+ * read. Per-phase max and mean are published as diagnostics every interval;
+ * a loop() iteration over the budget is counted and logged with the time
+ * spent in each phase since the previous iteration.
+ */
+class LoopProfiler {
+public:
+    static uint32_t now_cycles() { return esp_cpu_get_cycle_count(); }
+
+    void set_budget_us(uint32_t budget_us) { budget_us_ = budget_us; }
+
+    void add(LoopPhase phase, uint32_t start_cycles);
+    void end_iteration(uint32_t start_cycles);
+    void publish(VehicleStateManager* state_manager);
+
+private:
+    struct PhaseStats {
+        uint32_t max_us{0};
+        uint64_t total_us{0};
+        uint32_t count{0};
+        uint32_t iteration_us{0};  // since the last end_iteration()
+    };
+
+    PhaseStats phases_[static_cast<size_t>(LoopPhase::COUNT)];
+    PhaseStats loop_;
+    uint32_t budget_us_{20000};
+    uint32_t over_budget_{0};
+    uint32_t last_publish_{0};
+
+    static uint32_t elapsed_us(uint32_t start_cycles);
+};
+
+/**
+ * @brief Times the enclosing scope as one phase
+ */
+class LoopPhaseTimer {
+public:
+    LoopPhaseTimer(LoopProfiler& profiler, LoopPhase phase)
+        : profiler_(profiler), phase_(phase), start_(LoopProfiler::now_cycles()) {}
+    ~LoopPhaseTimer() { profiler_.add(phase_, start_); }
+
+    LoopPhaseTimer(const LoopPhaseTimer&) = delete;
+    LoopPhaseTimer& operator=(const LoopPhaseTimer&) = delete;
+
+private:
+    LoopProfiler& profiler_;
+    LoopPhase phase_;
+    uint32_t start_;
+};
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
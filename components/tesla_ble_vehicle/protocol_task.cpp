@@ -0,0 +1,127 @@
+#include "protocol_task.h"
+
+#ifdef USE_TESLA_BLE_PROTOCOL_TASK
+
+#include <esphome/core/log.h>
+#include <sdkconfig.h>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+static const char *const PROTOCOL_TAG = "tesla_ble_protocol";
+
+// Decrypting and decoding a large infotainment response needs room for
+// mbedTLS and nanopb on the stack
+static constexpr uint32_t PROTOCOL_TASK_STACK_SIZE = 8192;
+// Above the loop task so frames are drained while the loop is busy
+static constexpr UBaseType_t PROTOCOL_TASK_PRIORITY = 2;
+
+bool ProtocolTask::start() {
+#if CONFIG_FREERTOS_UNICORE
+    ESP_LOGW(PROTOCOL_TAG, "Single-core chip - decoding stays on the main loop");
+    return false;
+#else
+    // Queue items are owning pointers to heap-allocated frames
+    rx_queue_ = xQueueCreate(RX_QUEUE_LENGTH, sizeof(std::vector<uint8_t>*));
+    if (rx_queue_ == nullptr) return false;
+
+    const BaseType_t core = xPortGetCoreID() == 0 ? 1 : 0;
+    if (xTaskCreatePinnedToCore(task_entry, "tesla_protocol", PROTOCOL_TASK_STACK_SIZE, this,
+                                PROTOCOL_TASK_PRIORITY, &task_, core) != pdPASS) {
+        vQueueDelete(rx_queue_);
+        rx_queue_ = nullptr;
+        ESP_LOGE(PROTOCOL_TAG, "Failed to start protocol task");
+        return false;
+    }
+    ESP_LOGI(PROTOCOL_TAG, "Decoding on core %d", static_cast<int>(core));
+    return true;
+#endif
+}
+
+// =============================================================================
+// RX: main loop -> protocol task
+// =============================================================================
+
+void ProtocolTask::submit_rx(const uint8_t* data, size_t len) {
+    auto* frame = new std::vector<uint8_t>(data, data + len);
+    // Behind a backlog the frame must wait its turn to keep chunks in order
+    if (rx_backlog_.empty() && xQueueSend(rx_queue_, &frame, 0) == pdTRUE) return;
+
+    if (rx_backlog_.empty())
+        ESP_LOGD(PROTOCOL_TAG, "RX queue full - holding frames on the main loop");
+    rx_backlog_.push_back(frame);
+    if (rx_backlog_.size() > rx_backlog_peak_) rx_backlog_peak_ = rx_backlog_.size();
+}
+
+void ProtocolTask::drain_rx_backlog() {
+    while (!rx_backlog_.empty()) {
+        auto* frame = rx_backlog_.front();
+        if (xQueueSend(rx_queue_, &frame, 0) != pdTRUE) return;
+        rx_backlog_.pop_front();
+    }
+}
+
+void ProtocolTask::task_entry(void* arg) {
+    auto* self = static_cast<ProtocolTask*>(arg);
+    std::vector<uint8_t>* frame = nullptr;
+    while (true) {
+        if (xQueueReceive(self->rx_queue_, &frame, portMAX_DELAY) != pdTRUE) continue;
+        {
+            std::lock_guard<std::recursive_mutex> lock(self->vehicle_mutex_);
+            self->handler_(*frame);
+        }
+        delete frame;
+    }
+}
+
+void ProtocolTask::clear() {
+    std::vector<uint8_t>* frame = nullptr;
+    while (rx_queue_ != nullptr && xQueueReceive(rx_queue_, &frame, 0) == pdTRUE) {
+        delete frame;
+    }
+    for (auto* held : rx_backlog_) {
+        delete held;
+    }
+    rx_backlog_.clear();
+    std::lock_guard<std::mutex> lock(deferred_mutex_);
+    deferred_.clear();
+}
+
+// =============================================================================
+// Results: protocol task -> main loop
+// =============================================================================
+
+void ProtocolTask::defer(Deferred fn, bool droppable) {
+    std::lock_guard<std::mutex> lock(deferred_mutex_);
+    if (deferred_.size() >= DEFERRED_QUEUE_LENGTH) {
+        // The loop has stalled for a while; give up the oldest call that may
+        // be lost. States and command results are never dropped.
+        for (auto it = deferred_.begin(); it != deferred_.end(); ++it) {
+            if (it->droppable) {
+                deferred_.erase(it);
+                deferred_drops_++;
+                break;
+            }
+        }
+    }
+    deferred_.push_back({std::move(fn), droppable});
+}
+
+void ProtocolTask::run_deferred() {
+    // Frames held back last iteration go first; the task has made room
+    drain_rx_backlog();
+
+    std::deque<DeferredCall> pending;
+    {
+        std::lock_guard<std::mutex> lock(deferred_mutex_);
+        pending.swap(deferred_);
+    }
+    for (auto& call : pending) {
+        call.fn();
+    }
+}
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
+
+#endif // USE_TESLA_BLE_PROTOCOL_TASK
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <esphome/core/defines.h>
+
+#ifdef USE_TESLA_BLE_PROTOCOL_TASK
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+/**
+ * @brief Decodes RX frames on the second core
+ *
+ * Notifications are queued to a task on the core the main loop is not on,
+ * which hands them to the library (AES-GCM, protobuf decode) with the
+ * vehicle mutex held. Whatever the library reports back on that task is
+ * turned into deferred calls, which the main loop applies to entities via
+ * run_deferred(). Nothing is dropped: a frame that does not fit the RX queue
+ * waits in a main-loop backlog (a lost chunk would corrupt reassembly), and
+ * only deferred calls marked droppable give way when the loop falls behind.
+ */
+class ProtocolTask {
+public:
+    using Handler = std::function<void(std::vector<uint8_t>&)>;
+    using Deferred = std::function<void()>;
+
+    // Enough 20-byte notifications for a large infotainment response at the
+    // default MTU; longer bursts wait in the backlog
+    static constexpr size_t RX_QUEUE_LENGTH = 128;
+    static constexpr size_t DEFERRED_QUEUE_LENGTH = 32;
+
+    ProtocolTask(std::recursive_mutex& vehicle_mutex, Handler handler)
+        : vehicle_mutex_(vehicle_mutex), handler_(std::move(handler)) {}
+
+    bool start();
+
+    // Main loop side
+    void submit_rx(const uint8_t* data, size_t len);
+    void run_deferred();
+    void clear();
+
+    // Protocol task side
+    bool on_task() const { return task_ != nullptr && xTaskGetCurrentTaskHandle() == task_; }
+    void defer(Deferred fn, bool droppable = false);
+
+    uint32_t get_rx_backlog_peak() const { return rx_backlog_peak_; }
+    uint32_t get_deferred_drops() const { return deferred_drops_; }
+
+private:
+    std::recursive_mutex& vehicle_mutex_;
+    Handler handler_;
+    TaskHandle_t task_{nullptr};
+    QueueHandle_t rx_queue_{nullptr};
+    // Frames the RX queue had no room for, oldest first (main loop only)
+    std::deque<std::vector<uint8_t>*> rx_backlog_;
+
+    struct DeferredCall {
+        Deferred fn;
+        bool droppable;
+    };
+    std::mutex deferred_mutex_;
+    std::deque<DeferredCall> deferred_;
+
+    uint32_t rx_backlog_peak_{0};
+    uint32_t deferred_drops_{0};
+
+    void drain_rx_backlog();
+    static void task_entry(void* arg);
+};
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
+
+#endif // USE_TESLA_BLE_PROTOCOL_TASK
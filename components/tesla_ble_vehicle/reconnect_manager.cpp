@@ -0,0 +1,169 @@
+#include "reconnect_manager.h"
+#include "tesla_ble_vehicle.h"
+#include <esphome/core/hal.h>
+#include <esphome/core/helpers.h>
+#include <algorithm>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+static const char *const RECONNECT_TAG = "tesla_ble_reconnect";
+
+// A garage door or a brief walk out of range: keep retrying quickly
+static constexpr uint32_t RECONNECT_FAST_WINDOW_MS = 60000;
+static constexpr uint32_t RECONNECT_FAST_DELAY_MS = 2000;
+// After that, double from the base delay up to the ceiling
+static constexpr uint32_t RECONNECT_BASE_DELAY_MS = 5000;
+static constexpr uint32_t RECONNECT_MAX_DELAY_MS = 900000;
+// Delays are spread by +/- this percentage so several nodes do not retry in lockstep
+static constexpr uint32_t RECONNECT_JITTER_PERCENT = 25;
+// Not seeing the car advertise for this long counts as "gone"
+static constexpr uint32_t RECONNECT_UNSEEN_RESET_MS = 60000;
+
+ReconnectManager::ReconnectManager(TeslaBLEVehicle* parent) : vehicle_(parent) {}
+
+// =============================================================================
+// Connection lifecycle
+// =============================================================================
+
+void ReconnectManager::on_client_state(esp32_ble_tracker::ClientState state) {
+    switch (state) {
+    case esp32_ble_tracker::ClientState::CONNECTING:
+        attempt_in_progress_ = true;
+        attempts_++;
+        publish();
+        break;
+
+    case esp32_ble_tracker::ClientState::IDLE:
+        // Back to idle without on_connected() in between: the attempt failed
+        if (attempt_in_progress_) {
+            attempt_in_progress_ = false;
+            schedule_retry();
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+void ReconnectManager::on_connected() {
+    attempt_in_progress_ = false;
+    attempts_ = 0;
+    failures_ = 0;
+    lost_at_ = 0;
+    backoff_ms_ = 0;
+    set_gate(false);
+    publish();
+}
+
+void ReconnectManager::on_disconnected() {
+    lost_at_ = millis();
+    failures_ = 0;
+}
+
+void ReconnectManager::schedule_retry() {
+    const uint32_t now = millis();
+    if (lost_at_ == 0) lost_at_ = now; // never connected since boot or reset
+
+    if (now - lost_at_ < RECONNECT_FAST_WINDOW_MS) {
+        backoff_ms_ = RECONNECT_FAST_DELAY_MS;
+    } else {
+        // Only failures past the fast window count towards the exponent
+        const uint32_t shift = std::min<uint32_t>(failures_++, 16);
+        backoff_ms_ = std::min<uint32_t>(RECONNECT_BASE_DELAY_MS << shift, RECONNECT_MAX_DELAY_MS);
+        const uint32_t spread = backoff_ms_ / 100 * RECONNECT_JITTER_PERCENT;
+        backoff_ms_ = backoff_ms_ - spread + random_uint32() % (2 * spread + 1);
+    }
+    next_attempt_at_ = now + backoff_ms_;
+
+    ESP_LOGD(RECONNECT_TAG, "Connection attempt %u failed - next attempt in %us",
+             attempts_, backoff_ms_ / 1000);
+    set_gate(true);
+    publish();
+}
+
+void ReconnectManager::reset(const char* reason) {
+    if (!gated_ && backoff_ms_ == 0) return;
+
+    ESP_LOGI(RECONNECT_TAG, "Reconnect backoff reset: %s", reason);
+    lost_at_ = millis();
+    failures_ = 0;
+    backoff_ms_ = 0;
+    set_gate(false);
+    publish();
+}
+
+void ReconnectManager::loop() {
+    if (gated_ && static_cast<int32_t>(millis() - next_attempt_at_) >= 0) {
+        set_gate(false);
+    }
+}
+
+void ReconnectManager::set_vehicle_gone(bool gone) {
+    if (gone == vehicle_gone_) return;
+    vehicle_gone_ = gone;
+
+    if (gone) {
+        ESP_LOGI(RECONNECT_TAG, "Vehicle out of range - not attempting connections");
+        apply_gate();
+    } else {
+        reset("vehicle back in range");
+        apply_gate();
+    }
+}
+
+void ReconnectManager::set_slot_granted(bool granted) {
+    if (granted != slot_denied_) return;
+    slot_denied_ = !granted;
+    ESP_LOGD(RECONNECT_TAG, "Connection slot %s", granted ? "granted" : "withheld");
+    apply_gate();
+}
+
+// =============================================================================
+// Advertisements
+// =============================================================================
+
+bool ReconnectManager::parse_device(const esp32_ble_tracker::ESPBTDevice& device) {
+    auto* client = vehicle_->parent();
+    if (client == nullptr || device.address_uint64() != client->get_address()) return false;
+
+    const uint32_t now = millis();
+    const bool was_gone = last_seen_ == 0 || now - last_seen_ >= RECONNECT_UNSEEN_RESET_MS;
+    last_seen_ = now;
+    if (was_gone) reset("vehicle advertising again");
+
+    // Let ble_client handle the device as usual
+    return false;
+}
+
+// =============================================================================
+// Helpers
+// =============================================================================
+
+void ReconnectManager::set_gate(bool closed) {
+    if (closed == gated_) return;
+    gated_ = closed;
+    apply_gate();
+}
+
+void ReconnectManager::apply_gate() {
+    const bool block = gated_ || vehicle_gone_ || slot_denied_;
+    if (block == auto_connect_blocked_) return;
+
+    auto* client = vehicle_->parent();
+    // A client the user switched off stays off
+    if (client == nullptr || !client->enabled) return;
+    client->set_auto_connect(!block);
+    auto_connect_blocked_ = block;
+}
+
+void ReconnectManager::publish() {
+    if (auto* state_manager = vehicle_->get_state_manager()) {
+        state_manager->update_diagnostic_sensor("reconnect_attempts", static_cast<float>(attempts_));
+        state_manager->update_diagnostic_sensor("reconnect_backoff", backoff_ms_ / 1000.0f);
+    }
+}
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
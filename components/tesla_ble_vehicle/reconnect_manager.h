@@ -0,0 +1,66 @@
+#pragma once
+
+#include <esphome/components/esp32_ble_tracker/esp32_ble_tracker.h>
+#include <cstdint>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+class TeslaBLEVehicle; // Forward declaration
+
+/**
+ * @brief Reconnect policy for the vehicle link
+ *
+ * ble_client connects whenever it sees the car advertise, so a car at the
+ * edge of range (or one that keeps refusing us) is retried back to back.
+ * This manager gates the client's auto-connect: retries are quick for the
+ * first minute after the link drops, then back off exponentially with
+ * jitter up to a ceiling. An advertisement after the car was out of sight
+ * for a while means it came back, and resets the backoff.
+ */
+class ReconnectManager : public esp32_ble_tracker::ESPBTDeviceListener {
+public:
+    explicit ReconnectManager(TeslaBLEVehicle* parent);
+
+    // Connection lifecycle, driven by TeslaBLEVehicle
+    void on_client_state(esp32_ble_tracker::ClientState state);
+    void on_connected();
+    void on_disconnected();
+
+    void loop();
+
+    // Presence from a passive listener: while the car is clearly gone no
+    // connection is attempted at all
+    void set_vehicle_gone(bool gone);
+    // Connection slot from the multi-vehicle coordinator
+    void set_slot_granted(bool granted);
+
+    bool parse_device(const esp32_ble_tracker::ESPBTDevice& device) override;
+
+    uint32_t get_attempts() const { return attempts_; }
+    uint32_t get_backoff() const { return backoff_ms_; }
+
+private:
+    TeslaBLEVehicle* vehicle_;  // not parent_: that is the tracker in ESPBTDeviceListener
+
+    bool attempt_in_progress_{false};
+    bool gated_{false};
+    bool vehicle_gone_{false};
+    bool slot_denied_{false};
+    bool auto_connect_blocked_{false};
+    uint32_t attempts_{0};
+    uint32_t failures_{0};
+    uint32_t lost_at_{0};
+    uint32_t next_attempt_at_{0};
+    uint32_t backoff_ms_{0};
+    uint32_t last_seen_{0};
+
+    void schedule_retry();
+    void reset(const char* reason);
+    void set_gate(bool closed);
+    void apply_gate();
+    void publish();
+};
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
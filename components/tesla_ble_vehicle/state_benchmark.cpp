@@ -0,0 +1,82 @@
+#include "state_benchmark.h"
+
+#ifdef USE_TESLA_BLE_BENCHMARK
+
+#include "heap_stats.h"
+#include "state_fixtures.h"
+#include "vehicle_state_manager.h"
+#include <esphome/core/application.h>
+#include <esphome/core/log.h>
+#include <esphome/core/version.h>
+#include <esp_timer.h>
+#include <cstdio>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+static const char *const BENCHMARK_TAG = "tesla_ble_benchmark";
+
+template<typename T>
+void StateBenchmark::measure(const char* name, const T (&payloads)[2],
+                             void (VehicleStateManager::*update)(const T&),
+                             uint32_t iterations) {
+    // One untimed pass so the first timed update already changes state
+    (state_manager_->*update)(payloads[1]);
+    state_manager_->flush_all();
+
+    const uint32_t publishes_before = state_manager_->get_publish_count();
+    const uint32_t allocs_before = get_alloc_count();
+    const int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        // Include the deferred publishes in the cost of the update
+        (state_manager_->*update)(payloads[i % 2]);
+        state_manager_->flush_all();
+    }
+    const int64_t elapsed_us = esp_timer_get_time() - start;
+    const uint32_t allocs = get_alloc_count() - allocs_before;
+    const uint32_t publishes = state_manager_->get_publish_count() - publishes_before;
+
+    char allocs_str[16];
+    if (has_alloc_counter()) {
+        snprintf(allocs_str, sizeof(allocs_str), "%.2f", static_cast<float>(allocs) / iterations);
+    } else {
+        snprintf(allocs_str, sizeof(allocs_str), "null");
+    }
+
+    // One line per update, each a complete JSON object so a run never
+    // outgrows the logger's line buffer; prefixed so the lines can be
+    // grepped out of the device log
+    ESP_LOGI(BENCHMARK_TAG,
+             "BENCHMARK {\"esphome\":\"%s\",\"build\":\"%s\",\"iterations\":%u,\"update\":\"%s\","
+             "\"ns_per_update\":%lld,\"allocs_per_update\":%s,\"publishes_per_update\":%.2f}",
+             ESPHOME_VERSION, App.get_compilation_time().c_str(), iterations, name,
+             static_cast<long long>(elapsed_us * 1000 / iterations), allocs_str,
+             static_cast<float>(publishes) / iterations);
+}
+
+void StateBenchmark::run(uint32_t iterations) {
+    if (iterations == 0) return;
+    ESP_LOGI(BENCHMARK_TAG, "Replaying fixture payloads %u times each", iterations);
+
+    const StateFixtures& fixtures = get_state_fixtures();
+    measure("vehicle_status", fixtures.vehicle_status, &VehicleStateManager::update_vehicle_status, iterations);
+    measure("charge_state", fixtures.charge_state, &VehicleStateManager::update_charge_state, iterations);
+#ifdef USE_TESLA_BLE_CLIMATE_STATE
+    measure("climate_state", fixtures.climate_state, &VehicleStateManager::update_climate_state, iterations);
+#endif
+#ifdef USE_TESLA_BLE_DRIVE_STATE
+    measure("drive_state", fixtures.drive_state, &VehicleStateManager::update_drive_state, iterations);
+#endif
+#ifdef USE_TESLA_BLE_TIRE_PRESSURE_STATE
+    measure("tire_pressure_state", fixtures.tire_pressure_state, &VehicleStateManager::update_tire_pressure_state,
+            iterations);
+#endif
+#ifdef USE_TESLA_BLE_CLOSURES_STATE
+    measure("closures_state", fixtures.closures_state, &VehicleStateManager::update_closures_state, iterations);
+#endif
+}
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
+
+#endif // USE_TESLA_BLE_BENCHMARK
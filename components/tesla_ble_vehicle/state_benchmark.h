@@ -0,0 +1,42 @@
+#pragma once
+
+#include <esphome/core/defines.h>
+
+#ifdef USE_TESLA_BLE_BENCHMARK
+
+#include <cstdint>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+class VehicleStateManager; // Forward declaration
+
+/**
+ * @brief Measures the cost of VehicleStateManager updates
+ *
+ * Replays the two variants of each payload in state_fixtures.h through the
+ * state manager alternately, so every update changes state and publishes.
+ * Reports time, heap allocations and entity publishes per update as one
+ * JSON log line per payload type, so runs can be compared across builds. The host
+ * build runs it as tesla_ble_state_bench; the benchmark action runs the
+ * same fixtures on the device.
+ */
+class StateBenchmark {
+public:
+    explicit StateBenchmark(VehicleStateManager* state_manager) : state_manager_(state_manager) {}
+
+    void run(uint32_t iterations);
+
+private:
+    VehicleStateManager* state_manager_;
+
+    template<typename T>
+    void measure(const char* name, const T (&payloads)[2],
+                 void (VehicleStateManager::*update)(const T&),
+                 uint32_t iterations);
+};
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
+
+#endif // USE_TESLA_BLE_BENCHMARK
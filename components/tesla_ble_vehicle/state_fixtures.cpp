@@ -0,0 +1,149 @@
+#include "state_fixtures.h"
+
+#ifdef USE_TESLA_BLE_BENCHMARK
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+static VCSEC_VehicleStatus make_vehicle_status(bool later) {
+    VCSEC_VehicleStatus status = VCSEC_VehicleStatus_init_zero;
+    status.vehicleSleepStatus = later ? VCSEC_VehicleSleepStatus_E_VEHICLE_SLEEP_STATUS_ASLEEP
+                                      : VCSEC_VehicleSleepStatus_E_VEHICLE_SLEEP_STATUS_AWAKE;
+    status.vehicleLockState = later ? VCSEC_VehicleLockState_E_VEHICLELOCKSTATE_LOCKED
+                                    : VCSEC_VehicleLockState_E_VEHICLELOCKSTATE_UNLOCKED;
+    status.userPresence = later ? VCSEC_UserPresence_E_VEHICLE_USER_PRESENCE_NOT_PRESENT
+                                : VCSEC_UserPresence_E_VEHICLE_USER_PRESENCE_PRESENT;
+    status.has_closureStatuses = true;
+    status.closureStatuses.chargePort = later ? VCSEC_ClosureState_E_CLOSURESTATE_CLOSED
+                                              : VCSEC_ClosureState_E_CLOSURESTATE_OPEN;
+    return status;
+}
+
+static CarServer_ChargeState make_charge_state(bool later) {
+    CarServer_ChargeState state = CarServer_ChargeState_init_zero;
+    state.has_charging_state = true;
+    state.charging_state.which_type = later ? CarServer_ChargeState_ChargingState_Complete_tag
+                                            : CarServer_ChargeState_ChargingState_Charging_tag;
+    state.has_charge_port_latch = true;
+    state.charge_port_latch.which_type = later ? CarServer_ChargePortLatchState_Disengaged_tag
+                                               : CarServer_ChargePortLatchState_Engaged_tag;
+    state.which_optional_battery_level = CarServer_ChargeState_battery_level_tag;
+    state.optional_battery_level.battery_level = later ? 80 : 79;
+    state.which_optional_charger_power = CarServer_ChargeState_charger_power_tag;
+    state.optional_charger_power.charger_power = later ? 0 : 11;
+    state.which_optional_battery_range = CarServer_ChargeState_battery_range_tag;
+    state.optional_battery_range.battery_range = later ? 251.5f : 248.25f;
+    state.which_optional_charge_energy_added = CarServer_ChargeState_charge_energy_added_tag;
+    state.optional_charge_energy_added.charge_energy_added = later ? 12.5f : 12.25f;
+    state.which_optional_minutes_to_full_charge = CarServer_ChargeState_minutes_to_full_charge_tag;
+    state.optional_minutes_to_full_charge.minutes_to_full_charge = later ? 0 : 5;
+    state.which_optional_charger_voltage = CarServer_ChargeState_charger_voltage_tag;
+    state.optional_charger_voltage.charger_voltage = later ? 0 : 229;
+    state.which_optional_charger_actual_current = CarServer_ChargeState_charger_actual_current_tag;
+    state.optional_charger_actual_current.charger_actual_current = later ? 0 : 16;
+    state.which_optional_charger_pilot_current = CarServer_ChargeState_charger_pilot_current_tag;
+    state.optional_charger_pilot_current.charger_pilot_current = later ? 32 : 16;
+    state.which_optional_charge_current_request_max = CarServer_ChargeState_charge_current_request_max_tag;
+    state.optional_charge_current_request_max.charge_current_request_max = later ? 32 : 16;
+    state.which_optional_charge_current_request = CarServer_ChargeState_charge_current_request_tag;
+    state.optional_charge_current_request.charge_current_request = later ? 24 : 16;
+    state.which_optional_charge_limit_reason = CarServer_ChargeState_charge_limit_reason_tag;
+    state.optional_charge_limit_reason.charge_limit_reason =
+        later ? CarServer_ChargeState_ChargeLimitReason_ChargeLimitReasonNone
+              : CarServer_ChargeState_ChargeLimitReason_ChargeLimitReasonEvse;
+    state.which_optional_charge_rate_mph = CarServer_ChargeState_charge_rate_mph_tag;
+    state.optional_charge_rate_mph.charge_rate_mph = later ? 0 : 30;
+    state.which_optional_charge_limit_soc = CarServer_ChargeState_charge_limit_soc_tag;
+    state.optional_charge_limit_soc.charge_limit_soc = later ? 80 : 90;
+    state.which_optional_charge_port_door_open = CarServer_ChargeState_charge_port_door_open_tag;
+    state.optional_charge_port_door_open.charge_port_door_open = !later;
+    state.which_optional_charger_phases = CarServer_ChargeState_charger_phases_tag;
+    state.optional_charger_phases.charger_phases = later ? 1 : 3;
+    return state;
+}
+
+static CarServer_ClimateState make_climate_state(bool later) {
+    CarServer_ClimateState state = CarServer_ClimateState_init_zero;
+    state.which_optional_inside_temp_celsius = CarServer_ClimateState_inside_temp_celsius_tag;
+    state.optional_inside_temp_celsius.inside_temp_celsius = later ? 21.5f : 18.0f;
+    state.which_optional_outside_temp_celsius = CarServer_ClimateState_outside_temp_celsius_tag;
+    state.optional_outside_temp_celsius.outside_temp_celsius = later ? 7.5f : 8.0f;
+    state.which_optional_driver_temp_setting = CarServer_ClimateState_driver_temp_setting_tag;
+    state.optional_driver_temp_setting.driver_temp_setting = later ? 21.0f : 22.0f;
+    state.which_optional_is_climate_on = CarServer_ClimateState_is_climate_on_tag;
+    state.optional_is_climate_on.is_climate_on = !later;
+    state.which_optional_steering_wheel_heater = CarServer_ClimateState_steering_wheel_heater_tag;
+    state.optional_steering_wheel_heater.steering_wheel_heater = !later;
+    return state;
+}
+
+static CarServer_DriveState make_drive_state(bool later) {
+    CarServer_DriveState state = CarServer_DriveState_init_zero;
+    state.has_shift_state = true;
+    state.shift_state.which_type = later ? CarServer_ShiftState_D_tag : CarServer_ShiftState_P_tag;
+    state.which_optional_odometer_in_hundredths_of_a_mile = CarServer_DriveState_odometer_in_hundredths_of_a_mile_tag;
+    state.optional_odometer_in_hundredths_of_a_mile.odometer_in_hundredths_of_a_mile = later ? 1234567 : 1234500;
+    return state;
+}
+
+static CarServer_TirePressureState make_tire_pressure_state(bool later) {
+    CarServer_TirePressureState state = CarServer_TirePressureState_init_zero;
+    state.which_optional_tpms_pressure_fl = CarServer_TirePressureState_tpms_pressure_fl_tag;
+    state.optional_tpms_pressure_fl.tpms_pressure_fl = later ? 2.95f : 2.9f;
+    state.which_optional_tpms_pressure_fr = CarServer_TirePressureState_tpms_pressure_fr_tag;
+    state.optional_tpms_pressure_fr.tpms_pressure_fr = later ? 2.925f : 2.875f;
+    state.which_optional_tpms_pressure_rl = CarServer_TirePressureState_tpms_pressure_rl_tag;
+    state.optional_tpms_pressure_rl.tpms_pressure_rl = later ? 3.0f : 2.95f;
+    state.which_optional_tpms_pressure_rr = CarServer_TirePressureState_tpms_pressure_rr_tag;
+    state.optional_tpms_pressure_rr.tpms_pressure_rr = later ? 2.975f : 2.925f;
+    return state;
+}
+
+static CarServer_ClosuresState make_closures_state(bool later) {
+    CarServer_ClosuresState state = CarServer_ClosuresState_init_zero;
+    state.which_optional_door_open_driver_front = CarServer_ClosuresState_door_open_driver_front_tag;
+    state.optional_door_open_driver_front.door_open_driver_front = !later;
+    state.which_optional_door_open_driver_rear = CarServer_ClosuresState_door_open_driver_rear_tag;
+    state.optional_door_open_driver_rear.door_open_driver_rear = later;
+    state.which_optional_door_open_passenger_front = CarServer_ClosuresState_door_open_passenger_front_tag;
+    state.optional_door_open_passenger_front.door_open_passenger_front = !later;
+    state.which_optional_door_open_passenger_rear = CarServer_ClosuresState_door_open_passenger_rear_tag;
+    state.optional_door_open_passenger_rear.door_open_passenger_rear = later;
+    state.which_optional_door_open_trunk_front = CarServer_ClosuresState_door_open_trunk_front_tag;
+    state.optional_door_open_trunk_front.door_open_trunk_front = later;
+    state.which_optional_door_open_trunk_rear = CarServer_ClosuresState_door_open_trunk_rear_tag;
+    state.optional_door_open_trunk_rear.door_open_trunk_rear = !later;
+    state.which_optional_window_open_driver_front = CarServer_ClosuresState_window_open_driver_front_tag;
+    state.optional_window_open_driver_front.window_open_driver_front = !later;
+    state.which_optional_window_open_driver_rear = CarServer_ClosuresState_window_open_driver_rear_tag;
+    state.optional_window_open_driver_rear.window_open_driver_rear = later;
+    state.which_optional_window_open_passenger_front = CarServer_ClosuresState_window_open_passenger_front_tag;
+    state.optional_window_open_passenger_front.window_open_passenger_front = !later;
+    state.which_optional_window_open_passenger_rear = CarServer_ClosuresState_window_open_passenger_rear_tag;
+    state.optional_window_open_passenger_rear.window_open_passenger_rear = later;
+    state.which_optional_sun_roof_percent_open = CarServer_ClosuresState_sun_roof_percent_open_tag;
+    state.optional_sun_roof_percent_open.sun_roof_percent_open = later ? 0 : 15;
+    state.has_sentry_mode_state = true;
+    state.sentry_mode_state.which_type = later ? CarServer_ClosuresState_SentryModeState_Armed_tag
+                                               : CarServer_ClosuresState_SentryModeState_Off_tag;
+    state.which_optional_locked = CarServer_ClosuresState_locked_tag;
+    state.optional_locked.locked = later;
+    return state;
+}
+
+const StateFixtures& get_state_fixtures() {
+    static const StateFixtures fixtures = {
+        {make_vehicle_status(false), make_vehicle_status(true)},
+        {make_charge_state(false), make_charge_state(true)},
+        {make_climate_state(false), make_climate_state(true)},
+        {make_drive_state(false), make_drive_state(true)},
+        {make_tire_pressure_state(false), make_tire_pressure_state(true)},
+        {make_closures_state(false), make_closures_state(true)},
+    };
+    return fixtures;
+}
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
+
+#endif // USE_TESLA_BLE_BENCHMARK
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <esphome/core/defines.h>
+
+#ifdef USE_TESLA_BLE_BENCHMARK
+
+#include <car_server.pb.h>
+#include <vcsec.pb.h>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+/**
+ * @brief Fixed payloads for the state benchmark
+ *
+ * Two variants of each payload a poll can deliver, a plugged-in car at home
+ * and the same car a poll later. Every field the state manager reads differs
+ * between the variants, so replaying them alternately changes every entity
+ * on every update and the benchmark measures the publish path rather than
+ * deduplication. They are fixed so that runs from different builds compare.
+ */
+struct StateFixtures {
+    VCSEC_VehicleStatus vehicle_status[2];
+    CarServer_ChargeState charge_state[2];
+    CarServer_ClimateState climate_state[2];
+    CarServer_DriveState drive_state[2];
+    CarServer_TirePressureState tire_pressure_state[2];
+    CarServer_ClosuresState closures_state[2];
+};
+
+const StateFixtures& get_state_fixtures();
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
+
+#endif // USE_TESLA_BLE_BENCHMARK
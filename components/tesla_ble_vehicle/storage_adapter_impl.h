@@ -1,6 +1,7 @@
 #pragma once
 
 #include "adapters.h"
+#include <map>
 #include <vector>
 #include <string>
 #include <nvs_flash.h>
@@ -9,29 +10,67 @@
 namespace esphome {
 namespace tesla_ble_vehicle {
 
+/**
+ * @brief Write-behind cache entry for a single logical storage key
+ */
+struct CachedBlob {
+    std::vector<uint8_t> data;
+    bool dirty{false};
+};
+
 class StorageAdapterImpl : public ::TeslaBLE::StorageAdapter {
 public:
     StorageAdapterImpl();
     ~StorageAdapterImpl();
-    
+
     bool load(const std::string& key, std::vector<uint8_t>& buffer) override;
     bool save(const std::string& key, const std::vector<uint8_t>& buffer) override;
     bool remove(const std::string& key) override;
-    
-    // Initialize NVS
-    bool initialize();
+
+    // Initialize NVS. Keys are stored in a namespace derived from the VIN so
+    // several vehicles can share one node; an empty VIN uses the legacy one.
+    bool initialize(const std::string& vin = "");
+    const std::string& get_namespace() const { return namespace_; }
+
+    // Write-behind cache: session saves are kept in RAM and committed to flash
+    // at most once per flush interval (and on disconnect/shutdown via flush()).
+    void set_flush_interval(uint32_t interval_ms) { flush_interval_ = interval_ms; }
+    void loop();
+    bool flush();
+    bool has_pending_writes() const { return dirty_since_ != 0; }
+
+    // Statistics; flash writes count blobs that reached flash
+    uint32_t get_flash_writes() const { return flash_writes_; }
+    uint32_t get_writes_avoided() const { return writes_avoided_; }
 
 private:
     nvs_handle_t storage_handle_;
     bool initialized_;
-    
-    // Helper to map string keys to consistent NVS keys (since NVS keys are max 15 chars)
-    // Actually SessionManager used fixed keys "tk_vcsec", "tk_infotainment".
-    // TeslaBLE library passes "session_vcsec", "session_infotainment".
-    // We can just map them directly or use a hash or use the library keys if short enough?
-    // "session_vcsec" is 13 chars. "session_infotainment" is 20 chars (Too long!)
-    // So we MUST map them.
-    const char* map_key(const std::string& key);
+    std::string namespace_;
+
+    // Logical key -> NVS key for keys that had to be hashed, persisted so a
+    // probed (collision-resolved) key stays stable across reboots
+    std::map<std::string, std::string> key_index_;
+
+    std::map<std::string, CachedBlob> cache_;
+    uint32_t flush_interval_{60000};
+    uint32_t dirty_since_{0};
+    uint32_t flash_writes_{0};
+    uint32_t writes_avoided_{0};
+
+    bool write_blob(const std::string& key, const std::vector<uint8_t>& data);
+
+    // Map a logical library key to an NVS key (max 15 chars). Short keys are
+    // used as-is, the known session keys keep their legacy names, anything
+    // else is hashed and registered in key_index_. Returns empty on failure.
+    std::string map_key(const std::string& key);
+    void load_key_index();
+    bool save_key_index();
+    void migrate_legacy_keys();
+
+    // Keys that must never sit in the write-behind cache (losing them on a
+    // power cut would unpair the device)
+    static bool is_write_through_key(const std::string& key) { return key == "private_key"; }
 };
 
 } // namespace tesla_ble_vehicle
@@ -61,13 +61,25 @@ void TeslaBLEVehicle::setup() {
   setup_button_callbacks();
 }
 
+template<typename T>
+void TeslaBLEVehicle::apply_state(ConnectionPhase phase, const T &state,
+                                  void (VehicleStateManager::*update)(const T &)) {
+  record_connection_phase(phase);
+  if (state_manager_) {
+    LoopPhaseTimer timer(loop_profiler_, LoopPhase::PUBLISH);
+    HeapScopeGuard heap_scope(HeapScope::STATE_UPDATE);
+    (state_manager_.get()->*update)(state);
+  }
+}
+
 void TeslaBLEVehicle::initialize_managers() {
   ESP_LOGD(TAG, "Initializing components...");
 
   ble_adapter_ = std::make_shared<BleAdapterImpl>(this);
   storage_adapter_ = std::make_shared<StorageAdapterImpl>();
 
-  if (!storage_adapter_->initialize()) {
+  storage_adapter_->set_flush_interval(session_flush_interval_);
+  if (!storage_adapter_->initialize(vin_)) {
     ESP_LOGE(TAG, "Failed to initialize storage adapter");
   }
 
@@ -75,48 +87,100 @@ void TeslaBLEVehicle::initialize_managers() {
   vehicle_ =
       std::make_shared<TeslaBLE::Vehicle>(ble_adapter_, storage_adapter_);
   state_manager_ = std::make_unique<VehicleStateManager>(this);
+  state_manager_->set_publish_budget(publish_budget_us_);
+  link_manager_ = std::make_unique<BleLinkManager>(this);
+  link_manager_->set_idle_timeout(link_idle_timeout_);
+  esp32_ble::global_ble->register_gap_event_handler(link_manager_.get());
+  reconnect_manager_ = std::make_unique<ReconnectManager>(this);
+  espbt::global_esp32_ble_tracker->register_listener(reconnect_manager_.get());
+  coordinator_ = BleCoordinator::get();
+  coordinator_->register_vehicle(this);
+#ifdef USE_TESLA_BLE_BENCHMARK
+  benchmark_ = std::make_unique<StateBenchmark>(state_manager_.get());
+#endif
+#ifdef USE_TESLA_BLE_CAPTURE
+  traffic_capture_ = std::make_unique<TrafficCapture>(capture_buffer_size_);
+#endif
 
   ESP_LOGD(TAG, "Wiring up callbacks...");
 
   vehicle_->set_raw_message_callback([this](const std::vector<uint8_t> &data) {
-    std::string hex = TeslaBLE::format_hex(data.data(), data.size());
-    if (hex != last_rx_hex_) {
-      ESP_LOGV(TAG, "BLE RX: %s", hex.c_str());
-      last_rx_hex_ = hex;
-    }
+    // Only logging; may be dropped if the loop falls behind
+    run_on_loop(
+        [this, data]() {
+          std::string hex = TeslaBLE::format_hex(data.data(), data.size());
+          if (hex != last_rx_hex_) {
+            ESP_LOGV(TAG, "BLE RX: %s", hex.c_str());
+            last_rx_hex_ = hex;
+          }
+        },
+        true);
   });
 
   vehicle_->set_vehicle_status_callback([this](const VCSEC_VehicleStatus &s) {
-    if (state_manager_)
-      state_manager_->update_vehicle_status(s);
+    run_on_loop([this, s]() {
+      apply_state(ConnectionPhase::VCSEC_SESSION, s,
+                  &VehicleStateManager::update_vehicle_status);
+      on_bring_up_vcsec_status();
+    });
   });
 
   vehicle_->set_charge_state_callback([this](const CarServer_ChargeState &s) {
-    if (state_manager_)
-      state_manager_->update_charge_state(s);
+    run_on_loop([this, s]() {
+      apply_state(ConnectionPhase::INFOTAINMENT_SESSION, s,
+                  &VehicleStateManager::update_charge_state);
+    });
   });
 
+  // Only states some configured entity consumes are handed to the
+  // state manager (see entity_groups and role in __init__.py)
+#ifdef USE_TESLA_BLE_CLIMATE_STATE
   vehicle_->set_climate_state_callback([this](const CarServer_ClimateState &s) {
-    if (state_manager_)
-      state_manager_->update_climate_state(s);
+    run_on_loop([this, s]() {
+      apply_state(ConnectionPhase::INFOTAINMENT_SESSION, s,
+                  &VehicleStateManager::update_climate_state);
+    });
   });
+#endif
 
+#ifdef USE_TESLA_BLE_DRIVE_STATE
   vehicle_->set_drive_state_callback([this](const CarServer_DriveState &s) {
-    if (state_manager_)
-      state_manager_->update_drive_state(s);
+    run_on_loop([this, s]() {
+      apply_state(ConnectionPhase::INFOTAINMENT_SESSION, s,
+                  &VehicleStateManager::update_drive_state);
+    });
   });
+#endif
 
+#ifdef USE_TESLA_BLE_TIRE_PRESSURE_STATE
   vehicle_->set_tire_pressure_state_callback(
       [this](const CarServer_TirePressureState &s) {
-        if (state_manager_)
-          state_manager_->update_tire_pressure_state(s);
+        run_on_loop([this, s]() {
+          apply_state(ConnectionPhase::INFOTAINMENT_SESSION, s,
+                      &VehicleStateManager::update_tire_pressure_state);
+        });
       });
+#endif
 
+#ifdef USE_TESLA_BLE_CLOSURES_STATE
   vehicle_->set_closures_state_callback(
       [this](const CarServer_ClosuresState &s) {
-        if (state_manager_)
-          state_manager_->update_closures_state(s);
+        run_on_loop([this, s]() {
+          apply_state(ConnectionPhase::INFOTAINMENT_SESSION, s,
+                      &VehicleStateManager::update_closures_state);
+        });
       });
+#endif
+
+#ifdef USE_TESLA_BLE_PROTOCOL_TASK
+  if (protocol_task_enabled_) {
+    protocol_task_ = std::make_unique<ProtocolTask>(
+        vehicle_mutex_,
+        [this](std::vector<uint8_t> &frame) { vehicle_->on_rx_data(frame); });
+    if (!protocol_task_->start())
+      protocol_task_.reset();
+  }
+#endif
 
   ESP_LOGD(TAG, "All components initialized");
 }
@@ -176,24 +240,129 @@ void TeslaBLEVehicle::configure_pending_sensors() {
 }
 
 void TeslaBLEVehicle::loop() {
-  if (vehicle_)
+  const uint32_t loop_start = LoopProfiler::now_cycles();
+
+  // A new connection attempt starts the timeline; the BLE events below only
+  // tell us when the link opened
+  const auto client_state = this->parent()->state();
+  if (client_state != last_client_state_) {
+    if (client_state == espbt::ClientState::CONNECTING)
+      connection_timeline_.begin(millis());
+    if (reconnect_manager_)
+      reconnect_manager_->on_client_state(client_state);
+    if (coordinator_)
+      coordinator_->on_client_state(this, client_state);
+    last_client_state_ = client_state;
+  }
+  if (coordinator_ && coordinator_->is_leader(this))
+    coordinator_->loop();
+#ifdef USE_TESLA_BLE_LISTENER
+  // The car may stop advertising (and we may stop scanning) while
+  // connected, so presence only matters between connections
+  if (listener_ && !is_connected()) {
+    if (reconnect_manager_)
+      reconnect_manager_->set_vehicle_gone(listener_->is_gone(vin_));
+    // Follow the car if its MAC changed (e.g. after a service visit)
+    const uint64_t address = listener_->resolve_address(vin_);
+    if (address != 0 && address != this->parent()->get_address() &&
+        client_state == espbt::ClientState::IDLE) {
+      ESP_LOGW(TAG, "Vehicle address changed - connecting to %012llx",
+               static_cast<unsigned long long>(address));
+      // GATT handles are cached per address, so nothing to invalidate
+      this->parent()->set_address(address);
+    }
+  }
+#endif
+  if (reconnect_manager_)
+    reconnect_manager_->loop();
+
+  if (key_worker_.poll_finished())
+    on_key_job_finished();
+  {
+    // While the key worker runs, it owns the vehicle and the adapters.
+    // Nothing on the main loop waits for it: events and commands are held.
+    std::unique_lock<std::recursive_mutex> lock(vehicle_mutex_,
+                                                std::try_to_lock);
+    if (lock.owns_lock())
+      loop_vehicle();
+  }
+  if (state_manager_) {
+    // Staged entity updates, a slice per iteration
+    LoopPhaseTimer timer(loop_profiler_, LoopPhase::PUBLISH);
+    state_manager_->flush_pending();
+  }
+
+  loop_profiler_.end_iteration(loop_start);
+  loop_profiler_.publish(state_manager_.get());
+#ifdef USE_TESLA_BLE_HEAP_TELEMETRY
+  // Heap statistics are node-wide, so only one vehicle publishes them
+  if (coordinator_ && coordinator_->is_leader(this))
+    publish_heap_stats(state_manager_.get());
+#endif
+}
+
+// Protocol work; called with vehicle_mutex_ held
+void TeslaBLEVehicle::loop_vehicle() {
+  // Events and commands that found the vehicle busy
+  run_held_work();
+  if (update_pending_)
+    update();
+#ifdef USE_TESLA_BLE_PROTOCOL_TASK
+  if (protocol_task_)
+    protocol_task_->run_deferred();
+#endif
+  if (vehicle_) {
+    LoopPhaseTimer timer(loop_profiler_, LoopPhase::VEHICLE_LOOP);
     vehicle_->loop();
-  if (ble_adapter_)
+  }
+  // Writes queued during discovery (bring-up on cached handles) go out once
+  // it completes, so they never race it or a stale write handle
+  if (ble_adapter_ && !discovery_pending_) {
+    LoopPhaseTimer timer(loop_profiler_, LoopPhase::WRITE_QUEUE);
     ble_adapter_->process_write_queue();
+  }
+  process_bring_up();
+  if (link_manager_) {
+    // Queued chunks of an infotainment burst count as link activity
+    link_manager_->update_tx_state(ble_adapter_ &&
+                                   ble_adapter_->has_pending_writes());
+    link_manager_->loop();
+  }
+  if (storage_adapter_ && storage_adapter_->has_pending_writes()) {
+    storage_adapter_->loop();
+    if (!storage_adapter_->has_pending_writes())
+      flush_storage();
+  }
 }
 
 void TeslaBLEVehicle::update() {
   if (!is_connected() || !vehicle_)
     return;
 
+  if (key_worker_.busy())
+    return;
+  // The protocol task holds the lock while it decodes a frame; poll on the
+  // next loop() instead of waiting for it
+  std::unique_lock<std::recursive_mutex> lock(vehicle_mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    update_pending_ = true;
+    return;
+  }
+  update_pending_ = false;
+
   uint32_t now = millis();
 
-  // VCSEC Polling
-  if (now - last_vcsec_poll_ >= vcsec_poll_interval_) {
-    ESP_LOGI(TAG, "Polling VCSEC");
-    vehicle_->vcsec_poll();
-    last_vcsec_poll_ = now;
-  }
+  // The bring-up pipeline owns the link until the first VCSEC status
+  if (bring_up_stage_ == BringUpStage::VCSEC)
+    return;
+
+  // Another vehicle on this node is handling a user command
+  if (coordinator_ && !coordinator_->polls_allowed(this))
+    return;
+
+  const auto link_quality = link_manager_
+                                ? link_manager_->get_quality()
+                                : BleLinkManager::LinkQuality::GOOD;
 
   // Infotainment Polling - use faster interval when vehicle is active
   const bool is_asleep = state_manager_->is_asleep();
@@ -219,10 +388,37 @@ void TeslaBLEVehicle::update() {
     infotainment_interval = infotainment_poll_interval_active_;
   }
 
-  if (now - last_infotainment_poll_ >= infotainment_interval) {
+  // On a marginal link the large infotainment responses are the first to
+  // time out: poll them less often and never in the same tick as VCSEC, so
+  // the small VCSEC status keeps getting through
+  const bool split_polls =
+      link_quality != BleLinkManager::LinkQuality::GOOD && !effective_asleep;
+  if (split_polls)
+    infotainment_interval *= (link_quality == BleLinkManager::LinkQuality::POOR) ? 4 : 2;
+
+  bool poll_infotainment = now - last_infotainment_poll_ >= infotainment_interval;
+  // Never overlap two vehicles' infotainment bursts; retry next tick
+  if (poll_infotainment && coordinator_ && !coordinator_->request_heavy_poll(this)) {
+    ESP_LOGD(TAG, "Infotainment poll deferred - another vehicle is polling");
+    poll_infotainment = false;
+  }
+
+  // VCSEC Polling. The update interval defaults to the VCSEC interval, so
+  // when both polls are due on a split tick VCSEC is the one that waits for
+  // the next tick; otherwise infotainment would never get a tick of its own
+  if (now - last_vcsec_poll_ >= vcsec_poll_interval_ &&
+      !(split_polls && poll_infotainment)) {
+    ESP_LOGI(TAG, "Polling VCSEC");
+    vehicle_->vcsec_poll();
+    last_vcsec_poll_ = now;
+  }
+
+  if (poll_infotainment) {
     ESP_LOGI(TAG, "Polling Infotainment");
     auto policy = effective_asleep ? TeslaBLE::WakePolicy::NO_WAKE_SKIP
                                    : TeslaBLE::WakePolicy::WAKE_IF_NEEDED;
+    if (link_manager_)
+      link_manager_->begin_rx_measurement();
     vehicle_->infotainment_poll(policy);
     last_infotainment_poll_ = now;
   }
@@ -240,6 +436,36 @@ void TeslaBLEVehicle::dump_config() {
   ESP_LOGCONFIG(TAG, "  Sensors: %d binary, %d numeric, %d text",
                 pending_binary_sensors_.size(), pending_sensors_.size(),
                 pending_text_sensors_.size());
+  ESP_LOGCONFIG(TAG, "  Storage namespace: %s",
+                storage_adapter_ ? storage_adapter_->get_namespace().c_str() : "n/a");
+  ESP_LOGCONFIG(TAG, "  Session flush interval: %ums", session_flush_interval_);
+  ESP_LOGCONFIG(TAG, "  Pause scan while connected: %s",
+                YESNO(pause_scan_while_connected_));
+  if (link_manager_)
+    link_manager_->dump_config();
+}
+
+void TeslaBLEVehicle::on_shutdown() {
+  // Reboot or OTA - commit any cached session counters before we go down
+  std::unique_lock<std::recursive_mutex> lock(vehicle_mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    ESP_LOGW(TAG, "Shutting down during a key operation - session state not flushed");
+    return;
+  }
+  flush_storage();
+}
+
+void TeslaBLEVehicle::flush_storage() {
+  if (!storage_adapter_)
+    return;
+  if (!storage_adapter_->flush()) {
+    ESP_LOGW(TAG, "Failed to flush session cache to flash");
+  }
+  if (state_manager_) {
+    state_manager_->update_diagnostic_sensor(
+        "storage_writes_avoided",
+        static_cast<float>(storage_adapter_->get_writes_avoided()));
+  }
 }
 
 // =============================================================================
@@ -303,6 +529,37 @@ void TeslaBLEVehicle::set_infotainment_sleep_timeout(uint32_t interval_ms) {
   infotainment_sleep_timeout_ = interval_ms;
 }
 
+void TeslaBLEVehicle::set_link_idle_timeout(uint32_t timeout_ms) {
+  ESP_LOGD(TAG, "Setting link idle timeout: %u ms", timeout_ms);
+  link_idle_timeout_ = timeout_ms;
+  if (link_manager_)
+    link_manager_->set_idle_timeout(timeout_ms);
+}
+
+void TeslaBLEVehicle::set_loop_time_budget(uint32_t budget_us) {
+  ESP_LOGD(TAG, "Setting loop time budget: %u us", budget_us);
+  loop_profiler_.set_budget_us(budget_us);
+}
+
+void TeslaBLEVehicle::set_publish_budget(uint32_t budget_us) {
+  ESP_LOGD(TAG, "Setting publish budget: %u us", budget_us);
+  publish_budget_us_ = budget_us;
+  if (state_manager_)
+    state_manager_->set_publish_budget(budget_us);
+}
+
+void TeslaBLEVehicle::set_pause_scan_while_connected(bool pause) {
+  ESP_LOGD(TAG, "Setting pause scan while connected: %s", YESNO(pause));
+  pause_scan_while_connected_ = pause;
+}
+
+void TeslaBLEVehicle::set_session_flush_interval(uint32_t interval_ms) {
+  ESP_LOGD(TAG, "Setting session flush interval: %u ms", interval_ms);
+  session_flush_interval_ = interval_ms;
+  if (storage_adapter_)
+    storage_adapter_->set_flush_interval(interval_ms);
+}
+
 // =============================================================================
 // Generic sensor setters
 // =============================================================================
@@ -475,13 +732,28 @@ void TeslaBLEVehicle::send_command_with_tracking(
     return;
   }
 
-  last_command_name_ = name;
-  vehicle_->send_command_result(
-      domain, name, std::move(builder),
-      [this](TeslaBLE::OperationResult result) {
-        handle_command_result(std::move(result));
-      },
-      wake_policy);
+  if (key_worker_.busy()) {
+    ESP_LOGW(TAG, "Cannot send command '%s': key operation in progress", name.c_str());
+    return;
+  }
+  // If the protocol task is decoding a frame, the command is queued for the
+  // next loop() rather than dropped
+  with_vehicle_lock([this, domain, name, builder = std::move(builder),
+                     wake_policy]() mutable {
+    HeapScopeGuard heap_scope(HeapScope::COMMAND);
+    last_command_name_ = name;
+    if (coordinator_)
+      coordinator_->note_command(this);
+    // Switch to the low-latency profile before the command goes on air
+    if (link_manager_)
+      link_manager_->notify_activity();
+    vehicle_->send_command_result(
+        domain, name, std::move(builder),
+        [this](TeslaBLE::OperationResult result) {
+          run_on_loop([this, result]() { handle_command_result(result); });
+        },
+        wake_policy);
+  });
 }
 
 // =============================================================================
@@ -531,8 +803,10 @@ int TeslaBLEVehicle::start_pairing() {
     role_enum = Keys_Role_ROLE_CHARGING_MANAGER;
   }
 
-  vehicle_->pair(role_enum);
-  return 0;
+  // Loading or creating the key and signing the request is slow
+  return start_key_job("tesla_pair", "Preparing pairing request",
+                       "Pairing request sent - tap key card",
+                       [this, role_enum]() { vehicle_->pair(role_enum); });
 }
 
 int TeslaBLEVehicle::regenerate_key() {
@@ -543,10 +817,37 @@ int TeslaBLEVehicle::regenerate_key() {
     return -1;
   }
 
-  vehicle_->regenerate_key();
+  return start_key_job("tesla_keygen", "Generating key", "New key ready",
+                       [this]() { vehicle_->regenerate_key(); });
+}
+
+int TeslaBLEVehicle::start_key_job(const char *task_name,
+                                   const char *progress,
+                                   const char *done_text,
+                                   KeyWorker::Job job) {
+  if (key_worker_.busy()) {
+    ESP_LOGW(TAG, "Key operation already in progress");
+    return -1;
+  }
+  if (!key_worker_.start(task_name, std::move(job))) {
+    if (state_manager_)
+      state_manager_->update_diagnostic_text_sensor("key_operation", "Failed to start");
+    return -1;
+  }
+  key_job_done_text_ = done_text;
+  if (state_manager_)
+    state_manager_->update_diagnostic_text_sensor("key_operation", progress);
   return 0;
 }
 
+void TeslaBLEVehicle::on_key_job_finished() {
+  ESP_LOGI(TAG, "%s (%ums)", key_job_done_text_,
+           key_worker_.get_last_duration());
+  if (state_manager_)
+    state_manager_->update_diagnostic_text_sensor("key_operation",
+                                                  key_job_done_text_);
+}
+
 void TeslaBLEVehicle::force_update() {
   uint32_t now = millis();
   if (now - last_infotainment_poll_ < infotainment_poll_interval_active_) {
@@ -555,14 +856,37 @@ void TeslaBLEVehicle::force_update() {
     return;
   }
 
+  if (key_worker_.busy()) {
+    ESP_LOGW(TAG, "Force update ignored: key operation in progress");
+    return;
+  }
   ESP_LOGI(TAG, "Force update requested");
   last_infotainment_poll_ = now;
 
-  if (vehicle_) {
+  with_vehicle_lock([this]() {
+    if (!vehicle_)
+      return;
     vehicle_->vcsec_poll();
+    if (link_manager_)
+      link_manager_->begin_rx_measurement();
     vehicle_->infotainment_poll(TeslaBLE::WakePolicy::WAKE_IF_NEEDED);
-  }
+  });
+}
+
+#ifdef USE_TESLA_BLE_CAPTURE
+void TeslaBLEVehicle::dump_capture() {
+  if (traffic_capture_)
+    traffic_capture_->dump();
 }
+#endif
+
+#ifdef USE_TESLA_BLE_BENCHMARK
+void TeslaBLEVehicle::run_benchmark(uint32_t iterations) {
+  if (!benchmark_)
+    return;
+  benchmark_->run(iterations);
+}
+#endif
 
 int TeslaBLEVehicle::set_charging_state(bool charging) {
   ESP_LOGI(TAG, "Set charging state: %s", charging ? "ON" : "OFF");
@@ -854,6 +1178,65 @@ void TeslaBLEVehicle::close_windows() {
 // BLE event handling
 // =============================================================================
 
+void TeslaBLEVehicle::deliver_rx(std::vector<uint8_t> &data) {
+  if (!vehicle_)
+    return;
+  LoopPhaseTimer timer(loop_profiler_, LoopPhase::NOTIFY);
+#ifdef USE_TESLA_BLE_PROTOCOL_TASK
+  // Frames must not overtake a held connection transition
+  if (protocol_task_ && held_work_.empty()) {
+    protocol_task_->submit_rx(data.data(), data.size());
+    return;
+  }
+#endif
+  std::unique_lock<std::recursive_mutex> lock(vehicle_mutex_, std::try_to_lock);
+  if (!lock.owns_lock() || !held_work_.empty()) {
+    hold_work([this, data]() mutable { deliver_rx(data); });
+    return;
+  }
+#ifdef USE_TESLA_BLE_PROTOCOL_TASK
+  if (protocol_task_) {
+    protocol_task_->submit_rx(data.data(), data.size());
+    return;
+  }
+#endif
+  HeapScopeGuard heap_scope(HeapScope::RX_NOTIFY);
+  vehicle_->on_rx_data(data);
+}
+
+void TeslaBLEVehicle::with_vehicle_lock(std::function<void()> fn) {
+  std::unique_lock<std::recursive_mutex> lock(vehicle_mutex_, std::try_to_lock);
+  if (!lock.owns_lock() || !held_work_.empty()) {
+    hold_work(std::move(fn));
+    return;
+  }
+  fn();
+}
+
+void TeslaBLEVehicle::hold_work(std::function<void()> fn) {
+  if (held_work_.empty())
+    ESP_LOGD(TAG, "Vehicle busy - holding work until it is free");
+  held_work_.push_back(std::move(fn));
+}
+
+void TeslaBLEVehicle::run_held_work() {
+  // Swap first so the work can run (or hold itself again) in order
+  std::deque<std::function<void()>> pending;
+  pending.swap(held_work_);
+  for (auto &fn : pending)
+    fn();
+}
+
+void TeslaBLEVehicle::run_on_loop(std::function<void()> fn, bool droppable) {
+#ifdef USE_TESLA_BLE_PROTOCOL_TASK
+  if (protocol_task_ && protocol_task_->on_task()) {
+    protocol_task_->defer(std::move(fn), droppable);
+    return;
+  }
+#endif
+  fn();
+}
+
 void TeslaBLEVehicle::gattc_event_handler(esp_gattc_cb_event_t event,
                                           esp_gatt_if_t gattc_if,
                                           esp_ble_gattc_cb_param_t *param) {
@@ -863,73 +1246,146 @@ void TeslaBLEVehicle::gattc_event_handler(esp_gattc_cb_event_t event,
   case ESP_GATTC_OPEN_EVT:
     if (param->open.status == ESP_GATT_OK) {
       ESP_LOGI(TAG, "BLE physical link established");
+      link_opened_at_ = millis();
+      if (!connection_timeline_.active())
+        connection_timeline_.begin(link_opened_at_);
+      record_connection_phase(ConnectionPhase::LINK_OPEN);
+      discovery_pending_ = true;
+      // Fast path: the Tesla service layout is fixed per car, so reuse the
+      // handles from the last discovery and register for notifications now.
+      // The client base still runs discovery, which verifies the cached
+      // values; writes are held until it completes.
+      if (load_gatt_handles(param->open.remote_bda)) {
+        ESP_LOGD(TAG, "Using cached GATT handles (read=0x%04x, write=0x%04x)",
+                 read_handle_, write_handle_);
+        connection_timeline_.set_cached_handles();
+        register_for_notify();
+      }
+      if (link_manager_)
+        link_manager_->on_connected(param->open.remote_bda);
     }
     break;
 
   case ESP_GATTC_CLOSE_EVT:
     ESP_LOGW(TAG, "BLE connection closed");
-    handle_connection_lost();
+    with_vehicle_lock([this]() { handle_connection_lost(); });
     break;
 
   case ESP_GATTC_DISCONNECT_EVT:
     ESP_LOGW(TAG, "BLE disconnected");
     this->read_handle_ = 0;
     this->write_handle_ = 0;
+    this->cccd_handle_ = 0;
+    this->using_cached_handles_ = false;
+    this->discovery_pending_ = false;
+    if (link_manager_)
+      link_manager_->on_disconnected();
     this->node_state = espbt::ClientState::DISCONNECTING;
     break;
 
+  case ESP_GATTC_CFG_MTU_EVT:
+    if (param->cfg_mtu.conn_id != this->parent()->get_conn_id())
+      break;
+    record_connection_phase(ConnectionPhase::MTU);
+    break;
+
   case ESP_GATTC_SEARCH_CMPL_EVT: {
+    record_connection_phase(ConnectionPhase::DISCOVERY);
+    discovery_pending_ = false;
     auto *readChar = this->parent()->get_characteristic(this->service_uuid_,
                                                         this->read_uuid_);
     if (readChar == nullptr) {
       ESP_LOGE(TAG, "Read characteristic not found");
       break;
     }
-    this->read_handle_ = readChar->handle;
-
-    auto reg_status = esp_ble_gattc_register_for_notify(
-        this->parent()->get_gattc_if(), this->parent()->get_remote_bda(),
-        readChar->handle);
-    if (reg_status) {
-      ESP_LOGE(TAG, "Failed to register for notifications: %d", reg_status);
-    }
-
     auto *writeChar = this->parent()->get_characteristic(this->service_uuid_,
                                                          this->write_uuid_);
     if (writeChar == nullptr) {
       ESP_LOGE(TAG, "Write characteristic not found");
       break;
     }
+    auto *cccd = this->parent()->get_config_descriptor(readChar->handle);
+    const uint16_t cccd_handle = cccd != nullptr ? cccd->handle : 0;
+
+    if (using_cached_handles_ && readChar->handle == this->read_handle_ &&
+        writeChar->handle == this->write_handle_ &&
+        cccd_handle == this->cccd_handle_) {
+      ESP_LOGD(TAG, "Cached GATT handles verified by discovery");
+      this->using_cached_handles_ = false;
+      break;
+    }
+    if (using_cached_handles_) {
+      // Nothing was written yet; registering on the discovered handles is
+      // all that needs redoing
+      ESP_LOGW(TAG, "Cached GATT handles are stale - using discovered handles");
+    }
+
+    this->read_handle_ = readChar->handle;
     this->write_handle_ = writeChar->handle;
+    this->cccd_handle_ = cccd_handle;
+    this->using_cached_handles_ = false;
+    register_for_notify();
+    save_gatt_handles();
     break;
   }
 
   case ESP_GATTC_REG_FOR_NOTIFY_EVT:
     if (param->reg_for_notify.status != ESP_GATT_OK) {
       ESP_LOGE(TAG, "Failed to register for notifications");
+      if (using_cached_handles_)
+        invalidate_gatt_handles();
       break;
     }
 
+    if (using_cached_handles_ && cccd_handle_ != 0) {
+      // Before discovery the client base cannot look up the CCCD itself
+      uint16_t notify_en = 1;
+      auto status = esp_ble_gattc_write_char_descr(
+          this->parent()->get_gattc_if(), this->parent()->get_conn_id(),
+          cccd_handle_, sizeof(notify_en), reinterpret_cast<uint8_t *>(&notify_en),
+          ESP_GATT_WRITE_TYPE_RSP, ESP_GATT_AUTH_REQ_NONE);
+      if (status) {
+        ESP_LOGW(TAG, "Failed to enable notifications via cached CCCD: %d", status);
+      }
+    }
+
+    if (this->node_state == espbt::ClientState::ESTABLISHED)
+      break;
+
     this->node_state = espbt::ClientState::ESTABLISHED;
-    ESP_LOGI(TAG, "BLE connection fully established");
-    handle_connection_established();
+    record_connection_phase(ConnectionPhase::READY);
+    ESP_LOGI(TAG, "BLE connection fully established in %ums (%s)",
+             millis() - link_opened_at_,
+             using_cached_handles_ ? "cached handles" : "full discovery");
+    with_vehicle_lock([this]() { handle_connection_established(); });
     break;
 
   case ESP_GATTC_NOTIFY_EVT: {
     if (param->notify.conn_id != this->parent()->get_conn_id())
       break;
+    record_connection_phase(ConnectionPhase::FIRST_RX);
+    if (link_manager_)
+      link_manager_->record_rx(param->notify.value_len);
 
     std::vector<unsigned char> data(
         param->notify.value, param->notify.value + param->notify.value_len);
+#ifdef USE_TESLA_BLE_CAPTURE
+    if (traffic_capture_)
+      traffic_capture_->record(TrafficCapture::Direction::RX,
+                               param->notify.conn_id, data.data(), data.size());
+#endif
 
-    if (vehicle_)
-      vehicle_->on_rx_data(data);
+    deliver_rx(data);
     break;
   }
 
   case ESP_GATTC_WRITE_CHAR_EVT:
     if (param->write.status != ESP_GATT_OK) {
       ESP_LOGW(TAG, "BLE write failed: %d", param->write.status);
+      if (link_manager_)
+        link_manager_->record_write_result(false);
+      if (param->write.status == ESP_GATT_INVALID_HANDLE && using_cached_handles_)
+        invalidate_gatt_handles();
     }
     break;
 
@@ -938,17 +1394,147 @@ void TeslaBLEVehicle::gattc_event_handler(esp_gattc_cb_event_t event,
   }
 }
 
+// =============================================================================
+// GATT handle cache
+// =============================================================================
+
+static const uint8_t GATT_CACHE_VERSION = 1;
+
+std::string TeslaBLEVehicle::gatt_cache_key(const esp_bd_addr_t bda) const {
+  char key[18];
+  snprintf(key, sizeof(key), "gatt_%02x%02x%02x%02x%02x%02x", bda[0], bda[1],
+           bda[2], bda[3], bda[4], bda[5]);
+  return key;
+}
+
+bool TeslaBLEVehicle::load_gatt_handles(const esp_bd_addr_t bda) {
+  if (!storage_adapter_)
+    return false;
+
+  std::vector<uint8_t> blob;
+  if (!storage_adapter_->load(gatt_cache_key(bda), blob) || blob.size() != 7 ||
+      blob[0] != GATT_CACHE_VERSION)
+    return false;
+
+  read_handle_ = blob[1] | (blob[2] << 8);
+  write_handle_ = blob[3] | (blob[4] << 8);
+  cccd_handle_ = blob[5] | (blob[6] << 8);
+  using_cached_handles_ = read_handle_ != 0 && write_handle_ != 0;
+  return using_cached_handles_;
+}
+
+void TeslaBLEVehicle::save_gatt_handles() {
+  if (!storage_adapter_ || read_handle_ == 0 || write_handle_ == 0)
+    return;
+
+  std::vector<uint8_t> blob = {
+      GATT_CACHE_VERSION,
+      static_cast<uint8_t>(read_handle_ & 0xFF),
+      static_cast<uint8_t>(read_handle_ >> 8),
+      static_cast<uint8_t>(write_handle_ & 0xFF),
+      static_cast<uint8_t>(write_handle_ >> 8),
+      static_cast<uint8_t>(cccd_handle_ & 0xFF),
+      static_cast<uint8_t>(cccd_handle_ >> 8),
+  };
+  storage_adapter_->save(gatt_cache_key(this->parent()->get_remote_bda()), blob);
+}
+
+void TeslaBLEVehicle::invalidate_gatt_handles() {
+  ESP_LOGW(TAG, "Cached GATT handles rejected - waiting for full discovery");
+  if (storage_adapter_)
+    storage_adapter_->remove(gatt_cache_key(this->parent()->get_remote_bda()));
+  read_handle_ = 0;
+  write_handle_ = 0;
+  cccd_handle_ = 0;
+  using_cached_handles_ = false;
+  if (this->node_state == espbt::ClientState::ESTABLISHED)
+    this->node_state = espbt::ClientState::CONNECTED;
+}
+
+void TeslaBLEVehicle::register_for_notify() {
+  auto reg_status = esp_ble_gattc_register_for_notify(
+      this->parent()->get_gattc_if(), this->parent()->get_remote_bda(),
+      read_handle_);
+  if (reg_status) {
+    ESP_LOGE(TAG, "Failed to register for notifications: %d", reg_status);
+    if (using_cached_handles_)
+      invalidate_gatt_handles();
+  }
+}
+
+// =============================================================================
+// Connection-establishment timeline
+// =============================================================================
+
+void TeslaBLEVehicle::record_connection_phase(ConnectionPhase phase) {
+  if (!connection_timeline_.mark(phase, millis()))
+    return;
+
+  const auto &timeline = connection_timeline_.current();
+  const uint32_t elapsed = timeline.get(phase);
+  ESP_LOGD(TAG, "Connection timeline: %s at +%ums",
+           ConnectionTimelineRecorder::phase_name(phase), elapsed);
+
+  if (!state_manager_)
+    return;
+  state_manager_->update_diagnostic_sensor(
+      ConnectionTimelineRecorder::phase_sensor_id(phase),
+      static_cast<float>(elapsed));
+  state_manager_->update_diagnostic_sensor(
+      ConnectionTimelineRecorder::phase_median_sensor_id(phase),
+      static_cast<float>(connection_timeline_.median(phase)));
+
+  if (phase == ConnectionPhase::VCSEC_SESSION) {
+    // Connections on cached GATT handles against those that waited for a
+    // full discovery, i.e. what the handle cache saves
+    state_manager_->update_diagnostic_sensor(
+        timeline.cached_handles ? "connect_vcsec_cached_median"
+                                : "connect_vcsec_discovery_median",
+        static_cast<float>(connection_timeline_.median(
+            ConnectionPhase::VCSEC_SESSION, timeline.cached_handles)));
+
+    auto fmt = [&timeline](ConnectionPhase p) -> int32_t {
+      return timeline.reached(p) ? static_cast<int32_t>(timeline.get(p)) : -1;
+    };
+    ESP_LOGI(TAG,
+             "Connection timeline (ms): open=%d mtu=%d discovery=%d ready=%d "
+             "first_rx=%d vcsec=%d (%s)",
+             fmt(ConnectionPhase::LINK_OPEN), fmt(ConnectionPhase::MTU),
+             fmt(ConnectionPhase::DISCOVERY),
+             fmt(ConnectionPhase::READY), fmt(ConnectionPhase::FIRST_RX),
+             fmt(ConnectionPhase::VCSEC_SESSION),
+             timeline.cached_handles ? "cached handles" : "full discovery");
+  }
+}
+
+// Called with vehicle_mutex_ held (see with_vehicle_lock). Notification
+// registration can complete twice on one link (cached handles, then the
+// discovered ones); only the first starts the connection.
 void TeslaBLEVehicle::handle_connection_established() {
+  if (connection_established_)
+    return;
+  connection_established_ = true;
+  if (reconnect_manager_)
+    reconnect_manager_->on_connected();
   if (vehicle_) {
     vehicle_->set_connected(true);
-    ESP_LOGI(TAG, "Connection established - triggering initial polls");
+    ESP_LOGI(TAG, "Connection established - starting VCSEC bring-up");
+    // Remember whether the car was awake when we last saw it, before the
+    // availability reset below marks the cached state as current
+    bring_up_was_awake_ = state_manager_ && state_manager_->is_known_awake();
+    bring_up_infotainment_sent_ = false;
+    bring_up_stage_ = BringUpStage::VCSEC;
+    bring_up_started_at_ = millis();
     vehicle_->vcsec_poll();
-    vehicle_->infotainment_poll(TeslaBLE::WakePolicy::WAKE_IF_NEEDED);
-    last_vcsec_poll_ = millis();
-    last_infotainment_poll_ = millis();
+    last_vcsec_poll_ = bring_up_started_at_;
+    last_infotainment_poll_ = bring_up_started_at_;
     last_awake_idle_start_ = 0;
   }
 
+  // Scan windows steal radio time from our connection events
+  if (pause_scan_while_connected_ && coordinator_)
+    coordinator_->set_scan_pause(this, true);
+
   // Reset charging amps max to configured value on each connection
   if (state_manager_) {
     state_manager_->set_charging_amps_max(configured_charging_amps_max_);
@@ -957,11 +1543,82 @@ void TeslaBLEVehicle::handle_connection_established() {
   this->status_clear_warning();
 }
 
+void TeslaBLEVehicle::process_bring_up() {
+  if (bring_up_stage_ != BringUpStage::VCSEC || !vehicle_)
+    return;
+
+  // Overlap the infotainment session handshake with the VCSEC round trip,
+  // but only once the VCSEC request is fully on air and only if the car was
+  // awake last time - NO_WAKE_SKIP never wakes a sleeping car
+  if (!bring_up_infotainment_sent_ && bring_up_was_awake_ && ble_adapter_ &&
+      !ble_adapter_->has_pending_writes() &&
+      (!coordinator_ || coordinator_->request_heavy_poll(this))) {
+    ESP_LOGD(TAG, "Bring-up: VCSEC request sent, starting infotainment");
+    if (link_manager_)
+      link_manager_->begin_rx_measurement();
+    vehicle_->infotainment_poll(TeslaBLE::WakePolicy::NO_WAKE_SKIP);
+    last_infotainment_poll_ = millis();
+    bring_up_infotainment_sent_ = true;
+  }
+
+  if (millis() - bring_up_started_at_ >= BRING_UP_VCSEC_TIMEOUT_MS) {
+    ESP_LOGW(TAG, "Bring-up: no VCSEC status after %ums - resuming regular polling",
+             BRING_UP_VCSEC_TIMEOUT_MS);
+    bring_up_stage_ = BringUpStage::DONE;
+  }
+}
+
+void TeslaBLEVehicle::on_bring_up_vcsec_status() {
+  if (bring_up_stage_ != BringUpStage::VCSEC)
+    return;
+
+  const uint32_t elapsed = millis() - bring_up_started_at_;
+  ESP_LOGI(TAG, "Bring-up: first VCSEC status after %ums", elapsed);
+  if (state_manager_)
+    state_manager_->update_diagnostic_sensor("time_to_first_state",
+                                             static_cast<float>(elapsed));
+
+  if (state_manager_ && state_manager_->is_asleep()) {
+    ESP_LOGI(TAG, "Bring-up: vehicle asleep - skipping infotainment poll");
+    bring_up_stage_ = BringUpStage::DONE;
+    return;
+  }
+
+  if (!bring_up_infotainment_sent_ && coordinator_ &&
+      !coordinator_->request_heavy_poll(this)) {
+    // Leave it to the next update() tick once the other vehicle is done
+    ESP_LOGD(TAG, "Bring-up: infotainment deferred - another vehicle is polling");
+    last_infotainment_poll_ = 0;
+  } else if (!bring_up_infotainment_sent_) {
+    ESP_LOGD(TAG, "Bring-up: vehicle awake - polling infotainment");
+    if (link_manager_)
+      link_manager_->begin_rx_measurement();
+    vehicle_->infotainment_poll(TeslaBLE::WakePolicy::WAKE_IF_NEEDED);
+    last_infotainment_poll_ = millis();
+    bring_up_infotainment_sent_ = true;
+  }
+  bring_up_stage_ = BringUpStage::DONE;
+}
+
+// Called with vehicle_mutex_ held (see with_vehicle_lock)
 void TeslaBLEVehicle::handle_connection_lost() {
+#ifdef USE_TESLA_BLE_PROTOCOL_TASK
+  // Frames and results of the old session must not reach the next one
+  if (protocol_task_)
+    protocol_task_->clear();
+#endif
   if (vehicle_)
     vehicle_->set_connected(false);
   if (ble_adapter_)
     ble_adapter_->clear_queues();
+  flush_storage();
+  connection_timeline_.end();
+  connection_established_ = false;
+  bring_up_stage_ = BringUpStage::IDLE;
+  if (reconnect_manager_)
+    reconnect_manager_->on_disconnected();
+  if (coordinator_)
+    coordinator_->set_scan_pause(this, false);
 
   last_infotainment_poll_ = 0;
   last_vcsec_poll_ = 0;
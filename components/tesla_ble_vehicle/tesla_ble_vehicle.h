@@ -1,9 +1,12 @@
 #pragma once
 
 #include <memory>
+#include <deque>
 #include <map>
 #include <string>
+#include <vector>
 #include <functional>
+#include <mutex>
 #include <esphome/components/ble_client/ble_client.h>
 #include <esphome/components/esp32_ble_tracker/esp32_ble_tracker.h>
 #include <esphome/components/binary_sensor/binary_sensor.h>
@@ -17,9 +20,23 @@
 #include <esphome/components/climate/climate.h>
 #include <esphome/core/component.h>
 #include <esphome/core/automation.h>
+#include <esphome/core/defines.h>
+#ifdef USE_TESLA_BLE_LISTENER
+#include <esphome/components/tesla_ble_listener/tesla_ble_listener.h>
+#endif
 
 #include "ble_adapter_impl.h"
+#include "ble_coordinator.h"
+#include "ble_link_manager.h"
+#include "connection_timeline.h"
+#include "heap_stats.h"
+#include "key_worker.h"
+#include "loop_profiler.h"
+#include "protocol_task.h"
+#include "reconnect_manager.h"
+#include "state_benchmark.h"
 #include "storage_adapter_impl.h"
+#include "traffic_capture.h"
 #include <vehicle.h>
 #include "vehicle_state_manager.h"
 
@@ -35,6 +52,9 @@ static const char *const SERVICE_UUID = "00000211-b2d1-43f0-9b88-960cebf8b91e";
 static const char *const READ_UUID = "00000213-b2d1-43f0-9b88-960cebf8b91e";
 static const char *const WRITE_UUID = "00000212-b2d1-43f0-9b88-960cebf8b91e";
 
+// Give up waiting for the first VCSEC status after connecting
+static constexpr uint32_t BRING_UP_VCSEC_TIMEOUT_MS = 5000;
+
 /**
  * @brief Main Tesla BLE Vehicle component
  * 
@@ -58,6 +78,7 @@ public:
     void loop() override;
     void update() override;
     void dump_config() override;
+    void on_shutdown() override;
 
     // BLE event handling
     void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_if,
@@ -75,6 +96,17 @@ public:
     void set_infotainment_poll_interval_awake(uint32_t interval_ms);
     void set_infotainment_poll_interval_active(uint32_t interval_ms);
     void set_infotainment_sleep_timeout(uint32_t interval_ms);
+    void set_session_flush_interval(uint32_t interval_ms);
+    void set_link_idle_timeout(uint32_t timeout_ms);
+    void set_pause_scan_while_connected(bool pause);
+    void set_loop_time_budget(uint32_t budget_us);
+    void set_publish_budget(uint32_t budget_us);
+#ifdef USE_TESLA_BLE_LISTENER
+    void set_listener(tesla_ble_listener::TeslaBLEListener *listener) { listener_ = listener; }
+#endif
+#ifdef USE_TESLA_BLE_PROTOCOL_TASK
+    void set_protocol_task(bool enabled) { protocol_task_enabled_ = enabled; }
+#endif
 
     // ==========================================================================
     // Generic sensor setters - delegates to state manager
@@ -119,6 +151,14 @@ public:
     int start_pairing();
     int regenerate_key();
     void force_update();
+#ifdef USE_TESLA_BLE_BENCHMARK
+    void run_benchmark(uint32_t iterations);
+#endif
+#ifdef USE_TESLA_BLE_CAPTURE
+    void set_capture_buffer_size(size_t size) { capture_buffer_size_ = size; }
+    TrafficCapture* get_traffic_capture() const { return traffic_capture_.get(); }
+    void dump_capture();
+#endif
 
     // Vehicle control actions
     int set_charging_state(bool charging);
@@ -156,6 +196,8 @@ public:
 
     // Manager accessors
     VehicleStateManager* get_state_manager() const { return state_manager_.get(); }
+    BleLinkManager* get_link_manager() const { return link_manager_.get(); }
+    ReconnectManager* get_reconnect_manager() const { return reconnect_manager_.get(); }
     
     // BLE connection state
     bool is_connected() const { return node_state == espbt::ClientState::ESTABLISHED; }
@@ -173,11 +215,78 @@ private:
     void handle_connection_established();
     void handle_connection_lost();
 
+    // Connection bring-up pipeline: VCSEC status first, then infotainment
+    // only once the car is known to be awake
+    enum class BringUpStage : uint8_t { IDLE, VCSEC, DONE };
+    void process_bring_up();
+    void on_bring_up_vcsec_status();
+
+    // Persist cached session state and publish storage statistics
+    void flush_storage();
+
+    // Protocol part of loop(), skipped while the key worker owns the vehicle
+    void loop_vehicle();
+
+    // Key generation and pairing on the key worker
+    int start_key_job(const char *task_name, const char *progress,
+                      const char *done_text, KeyWorker::Job job);
+    void on_key_job_finished();
+
+    // Hand a notification to the library, on the protocol task if enabled
+    void deliver_rx(std::vector<uint8_t> &data);
+    // Run fn under vehicle_mutex_ if it is free, else hold it for loop().
+    // The main loop never blocks on the mutex.
+    void with_vehicle_lock(std::function<void()> fn);
+    void hold_work(std::function<void()> fn);
+    void run_held_work();
+    // Run fn on the main loop; library callbacks may fire on the protocol task.
+    // Only droppable calls may be lost when the main loop falls behind.
+    void run_on_loop(std::function<void()> fn, bool droppable = false);
+    // Record and publish one decoded state message
+    template<typename T>
+    void apply_state(ConnectionPhase phase, const T &state,
+                     void (VehicleStateManager::*update)(const T &));
+
+    // GATT handle cache (per peer address) to skip service discovery
+    std::string gatt_cache_key(const esp_bd_addr_t bda) const;
+    bool load_gatt_handles(const esp_bd_addr_t bda);
+    void save_gatt_handles();
+    void invalidate_gatt_handles();
+    void register_for_notify();
+
+    // Connection-establishment timeline
+    void record_connection_phase(ConnectionPhase phase);
+
     // Adapters & Managers
     std::shared_ptr<BleAdapterImpl> ble_adapter_;
     std::shared_ptr<StorageAdapterImpl> storage_adapter_;
     std::shared_ptr<::TeslaBLE::Vehicle> vehicle_;
     std::unique_ptr<VehicleStateManager> state_manager_;
+    std::unique_ptr<BleLinkManager> link_manager_;
+    std::unique_ptr<ReconnectManager> reconnect_manager_;
+    BleCoordinator* coordinator_{nullptr};
+#ifdef USE_TESLA_BLE_BENCHMARK
+    std::unique_ptr<StateBenchmark> benchmark_;
+#endif
+#ifdef USE_TESLA_BLE_CAPTURE
+    std::unique_ptr<TrafficCapture> traffic_capture_;
+    size_t capture_buffer_size_{8192};
+#endif
+
+    // Held by the key worker for a whole job, by the protocol task while it
+    // decodes a frame, and by everything on the main loop that touches
+    // vehicle_ or the adapters
+    std::recursive_mutex vehicle_mutex_;
+    KeyWorker key_worker_{vehicle_mutex_};
+    // Main-loop work that found vehicle_mutex_ taken, run in order
+    std::deque<std::function<void()>> held_work_;
+    // update() found the mutex taken; loop_vehicle() retries it
+    bool update_pending_{false};
+    const char *key_job_done_text_{""};
+#ifdef USE_TESLA_BLE_PROTOCOL_TASK
+    std::unique_ptr<ProtocolTask> protocol_task_;
+    bool protocol_task_enabled_{false};
+#endif
 
     // Configuration
     std::string vin_;
@@ -188,18 +297,42 @@ private:
     uint32_t infotainment_poll_interval_awake_{30000};
     uint32_t infotainment_poll_interval_active_{10000};
     uint32_t infotainment_sleep_timeout_{660000};
+    uint32_t session_flush_interval_{60000};
+    uint32_t link_idle_timeout_{30000};
+    bool pause_scan_while_connected_{false};
+    uint32_t publish_budget_us_{2000};
+#ifdef USE_TESLA_BLE_LISTENER
+    tesla_ble_listener::TeslaBLEListener *listener_{nullptr};
+#endif
     
     // Polling state
     uint32_t last_vcsec_poll_{0};
     uint32_t last_infotainment_poll_{0};
     uint32_t last_awake_idle_start_{0};
 
+    // Bring-up state
+    BringUpStage bring_up_stage_{BringUpStage::IDLE};
+    uint32_t bring_up_started_at_{0};
+    bool bring_up_was_awake_{false};
+    bool bring_up_infotainment_sent_{false};
+
     // BLE state
     espbt::ESPBTUUID service_uuid_;
     espbt::ESPBTUUID read_uuid_;
     espbt::ESPBTUUID write_uuid_;
     uint16_t read_handle_{0};
     uint16_t write_handle_{0};
+    uint16_t cccd_handle_{0};
+    bool using_cached_handles_{false};
+    // Service discovery runs on every link; TX waits for it even when cached
+    // handles let notifications be registered earlier
+    bool discovery_pending_{false};
+    // handle_connection_established() has run for the current link
+    bool connection_established_{false};
+    uint32_t link_opened_at_{0};
+    espbt::ClientState last_client_state_{espbt::ClientState::INIT};
+    ConnectionTimelineRecorder connection_timeline_;
+    LoopProfiler loop_profiler_;
 
     // ==========================================================================
     // Pending sensors (stored before state manager is initialized)
@@ -437,6 +570,28 @@ protected:
     TeslaBLEVehicle *parent_;
 };
 
+#ifdef USE_TESLA_BLE_CAPTURE
+template<typename... Ts> class DumpCaptureAction : public Action<Ts...> {
+public:
+    DumpCaptureAction(TeslaBLEVehicle *parent) : parent_(parent) {}
+    void play(Ts... x) override { parent_->dump_capture(); }
+protected:
+    TeslaBLEVehicle *parent_;
+};
+#endif
+
+#ifdef USE_TESLA_BLE_BENCHMARK
+template<typename... Ts> class BenchmarkAction : public Action<Ts...> {
+public:
+    BenchmarkAction(TeslaBLEVehicle *parent) : parent_(parent) {}
+    void set_iterations(esphome::TemplatableValue<uint32_t, Ts...> iterations) { iterations_ = iterations; }
+    void play(Ts... x) override { parent_->run_benchmark(iterations_.value(x...)); }
+protected:
+    TeslaBLEVehicle *parent_;
+    esphome::TemplatableValue<uint32_t, Ts...> iterations_;
+};
+#endif
+
 template<typename... Ts> class SetChargingAction : public Action<Ts...> {
 public:
     SetChargingAction(TeslaBLEVehicle *parent) : parent_(parent) {}
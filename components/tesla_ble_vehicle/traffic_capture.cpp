@@ -0,0 +1,95 @@
+#include "traffic_capture.h"
+
+#ifdef USE_TESLA_BLE_CAPTURE
+
+#include <esphome/core/hal.h>
+#include <esphome/core/helpers.h>
+#include <esphome/core/log.h>
+#include <algorithm>
+#include <cstring>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+static const char *const CAPTURE_TAG = "tesla_ble_capture";
+
+// Bytes of record data per dump line; keeps log lines well below the
+// logger's buffer size
+static constexpr size_t DUMP_LINE_BYTES = 48;
+
+TrafficCapture::TrafficCapture(size_t capacity) : ring_(capacity) {}
+
+// =============================================================================
+// Recording
+// =============================================================================
+
+void TrafficCapture::record(Direction direction, uint16_t conn_id, const uint8_t* data, size_t len) {
+    const size_t record_size = HEADER_SIZE + len;
+    if (len > UINT16_MAX || record_size > ring_.size()) return;
+
+    while (ring_.size() - used_ < record_size) {
+        drop_oldest();
+    }
+
+    const uint32_t ts = millis();
+    const uint8_t header[HEADER_SIZE] = {
+        static_cast<uint8_t>(ts), static_cast<uint8_t>(ts >> 8),
+        static_cast<uint8_t>(ts >> 16), static_cast<uint8_t>(ts >> 24),
+        static_cast<uint8_t>(direction),
+        static_cast<uint8_t>(conn_id), static_cast<uint8_t>(conn_id >> 8),
+        static_cast<uint8_t>(len), static_cast<uint8_t>(len >> 8),
+    };
+    push(header, HEADER_SIZE);
+    push(data, len);
+    records_++;
+}
+
+void TrafficCapture::push(const uint8_t* data, size_t len) {
+    const size_t first = std::min(len, ring_.size() - head_);
+    memcpy(ring_.data() + head_, data, first);
+    memcpy(ring_.data(), data + first, len - first);
+    head_ = (head_ + len) % ring_.size();
+    used_ += len;
+}
+
+void TrafficCapture::copy_out(size_t pos, uint8_t* out, size_t len) const {
+    const size_t first = std::min(len, ring_.size() - pos);
+    memcpy(out, ring_.data() + pos, first);
+    memcpy(out + first, ring_.data(), len - first);
+}
+
+void TrafficCapture::drop_oldest() {
+    uint8_t header[HEADER_SIZE];
+    copy_out(tail_, header, HEADER_SIZE);
+    const size_t record_size = HEADER_SIZE + (header[7] | (header[8] << 8));
+    tail_ = (tail_ + record_size) % ring_.size();
+    used_ -= record_size;
+    records_--;
+    dropped_++;
+}
+
+std::vector<uint8_t> TrafficCapture::linearize() const {
+    std::vector<uint8_t> out(used_);
+    if (used_ > 0) copy_out(tail_, out.data(), used_);
+    return out;
+}
+
+// =============================================================================
+// Dump
+// =============================================================================
+
+void TrafficCapture::dump() const {
+    const std::vector<uint8_t> data = linearize();
+    ESP_LOGI(CAPTURE_TAG, "CAPTURE v1 records=%u bytes=%u dropped=%u",
+             static_cast<unsigned>(records_), static_cast<unsigned>(data.size()), dropped_);
+    for (size_t i = 0; i < data.size(); i += DUMP_LINE_BYTES) {
+        const size_t len = std::min(DUMP_LINE_BYTES, data.size() - i);
+        ESP_LOGI(CAPTURE_TAG, "CAPTURE %s", format_hex(data.data() + i, len).c_str());
+    }
+    ESP_LOGI(CAPTURE_TAG, "CAPTURE end");
+}
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
+
+#endif // USE_TESLA_BLE_CAPTURE
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <esphome/core/defines.h>
+
+#ifdef USE_TESLA_BLE_CAPTURE
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace esphome {
+namespace tesla_ble_vehicle {
+
+/**
+ * @brief RAM ring of raw BLE traffic for reproducing link problems
+ *
+ * Every notification and every write chunk is stored as one record:
+ *
+ *   u32 timestamp (ms, little endian)
+ *   u8  direction (0 = RX, 1 = TX)
+ *   u16 connection ID (little endian)
+ *   u16 payload length (little endian)
+ *   payload
+ *
+ * When the ring is full the oldest records are dropped. dump() logs the
+ * records as hex, so a capture can be copied out of the device log and
+ * replayed against the component on the host (tests/host, tesla_ble_sim).
+ */
+class TrafficCapture {
+public:
+    enum class Direction : uint8_t { RX = 0, TX = 1 };
+    static constexpr size_t HEADER_SIZE = 9;
+
+    explicit TrafficCapture(size_t capacity);
+
+    void record(Direction direction, uint16_t conn_id, const uint8_t* data, size_t len);
+    void dump() const;
+
+    size_t get_record_count() const { return records_; }
+
+private:
+    std::vector<uint8_t> ring_;
+    size_t head_{0};  // next write position
+    size_t tail_{0};  // oldest record
+    size_t used_{0};
+    size_t records_{0};
+    uint32_t dropped_{0};
+
+    void push(const uint8_t* data, size_t len);
+    void copy_out(size_t pos, uint8_t* out, size_t len) const;
+    void drop_oldest();
+    std::vector<uint8_t> linearize() const;
+};
+
+} // namespace tesla_ble_vehicle
+} // namespace esphome
+
+#endif // USE_TESLA_BLE_CAPTURE
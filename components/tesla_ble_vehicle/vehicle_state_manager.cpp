@@ -1,5 +1,6 @@
 #include "vehicle_state_manager.h"
 #include "tesla_ble_vehicle.h"
+#include <esphome/core/hal.h>
 #include <esphome/core/helpers.h>
 #include <cmath>
 #include <algorithm>
@@ -7,6 +8,25 @@
 namespace esphome {
 namespace tesla_ble_vehicle {
 
+static bool same_state(bool a, bool b) { return a == b; }
+static bool same_state(float a, float b) { return std::abs(a - b) <= 0.001f; }
+static bool same_state(const std::string& a, const std::string& b) { return a == b; }
+
+// Stage value for entity; returns true if it differs from what will be published
+template<typename E, typename V>
+static bool stage_value(std::vector<std::pair<E*, V>>& pending, E* entity, const V& value) {
+    for (auto& entry : pending) {
+        if (entry.first == entity) {
+            if (same_state(entry.second, value)) return false;
+            entry.second = value;
+            return true;
+        }
+    }
+    if (entity->has_state() && same_state(entity->state, value)) return false;
+    pending.emplace_back(entity, value);
+    return true;
+}
+
 VehicleStateManager::VehicleStateManager(TeslaBLEVehicle* parent)
     : parent_(parent) {}
 
@@ -307,6 +327,7 @@ void VehicleStateManager::update_charge_state(const CarServer_ChargeState& charg
         if (charge_port_door_cover_ != nullptr) {
             charge_port_door_cover_->position = door_open ? cover::COVER_OPEN : cover::COVER_CLOSED;
             charge_port_door_cover_->publish_state();
+            publish_count_++;
         }
     }
     
@@ -327,6 +348,7 @@ void VehicleStateManager::update_charge_state(const CarServer_ChargeState& charg
             auto new_state = latch_engaged ? lock::LOCK_STATE_LOCKED : lock::LOCK_STATE_UNLOCKED;
             if (charge_port_latch_lock_->state != new_state) {
                 charge_port_latch_lock_->publish_state(new_state);
+                publish_count_++;
                 ESP_LOGD(STATE_MANAGER_TAG, "Charge port latch: %s", latch_engaged ? "ENGAGED (locked)" : "DISENGAGED (unlocked)");
             }
         }
@@ -334,6 +356,7 @@ void VehicleStateManager::update_charge_state(const CarServer_ChargeState& charg
 }
 
 void VehicleStateManager::update_climate_state(const CarServer_ClimateState& climate_state) {
+#ifdef USE_TESLA_BLE_CLIMATE_STATE
     ESP_LOGD(STATE_MANAGER_TAG, "Updating climate state");
     
     // Inside temperature (used internally for climate entity)
@@ -365,6 +388,7 @@ void VehicleStateManager::update_climate_state(const CarServer_ClimateState& cli
         climate_on_ = climate_state.optional_is_climate_on.is_climate_on;
     }
     
+#ifdef USE_TESLA_BLE_DRIVER_CONTROLS
     // Steering wheel heater - sync switch state from vehicle
     if (climate_state.which_optional_steering_wheel_heater && steering_wheel_heat_switch_ != nullptr) {
         const bool heater_on = climate_state.optional_steering_wheel_heater.steering_wheel_heater;
@@ -378,9 +402,14 @@ void VehicleStateManager::update_climate_state(const CarServer_ClimateState& cli
     if (auto* tesla_climate = static_cast<TeslaClimate*>(climate_)) {
         tesla_climate->update_state(climate_on_, current_inside_temp_, target_temp_);
     }
+#endif
+#else
+    (void) climate_state;  // No climate entities configured
+#endif
 }
 
 void VehicleStateManager::update_drive_state(const CarServer_DriveState& drive_state) {
+#ifdef USE_TESLA_BLE_DRIVE_STATE
     ESP_LOGD(STATE_MANAGER_TAG, "Updating drive state");
     
     // Shift state
@@ -399,9 +428,13 @@ void VehicleStateManager::update_drive_state(const CarServer_DriveState& drive_s
             publish_sensor("odometer", odometer);
         }
     }
+#else
+    (void) drive_state;  // No drive entities configured
+#endif
 }
 
 void VehicleStateManager::update_tire_pressure_state(const CarServer_TirePressureState& tire_pressure_state) {
+#ifdef USE_TESLA_BLE_TIRE_PRESSURE_STATE
     ESP_LOGD(STATE_MANAGER_TAG, "Updating tire pressure state");
     
     // Tire pressures in bar
@@ -432,9 +465,13 @@ void VehicleStateManager::update_tire_pressure_state(const CarServer_TirePressur
             publish_sensor("tpms_rear_right", pressure);
         }
     }
+#else
+    (void) tire_pressure_state;  // No TPMS entities configured
+#endif
 }
 
 void VehicleStateManager::update_closures_state(const CarServer_ClosuresState& closures_state) {
+#ifdef USE_TESLA_BLE_CLOSURES_STATE
     ESP_LOGD(STATE_MANAGER_TAG, "Updating closures state");
     
     // Doors - update individual binary sensors
@@ -451,12 +488,14 @@ void VehicleStateManager::update_closures_state(const CarServer_ClosuresState& c
         publish_binary_sensor("door_passenger_rear", closures_state.optional_door_open_passenger_rear.door_open_passenger_rear);
     }
     
+#ifdef USE_TESLA_BLE_DRIVER_CONTROLS
     // Trunks - update cover entities
     if (closures_state.which_optional_door_open_trunk_front) {
         const bool frunk_open = closures_state.optional_door_open_trunk_front.door_open_trunk_front;
         if (frunk_cover_ != nullptr) {
             frunk_cover_->position = frunk_open ? cover::COVER_OPEN : cover::COVER_CLOSED;
             frunk_cover_->publish_state();
+            publish_count_++;
         }
     }
     if (closures_state.which_optional_door_open_trunk_rear) {
@@ -464,8 +503,10 @@ void VehicleStateManager::update_closures_state(const CarServer_ClosuresState& c
         if (trunk_cover_ != nullptr) {
             trunk_cover_->position = trunk_open ? cover::COVER_OPEN : cover::COVER_CLOSED;
             trunk_cover_->publish_state();
+            publish_count_++;
         }
     }
+#endif
     
     // Windows - update individual binary sensors and aggregate cover
     bool window_df = false, window_dr = false, window_pf = false, window_pr = false;
@@ -487,10 +528,15 @@ void VehicleStateManager::update_closures_state(const CarServer_ClosuresState& c
     }
     const bool any_window_open = window_df || window_dr || window_pf || window_pr;
     
+#ifdef USE_TESLA_BLE_DRIVER_CONTROLS
     if (windows_cover_ != nullptr) {
         windows_cover_->position = any_window_open ? cover::COVER_OPEN : cover::COVER_CLOSED;
         windows_cover_->publish_state();
+        publish_count_++;
     }
+#else
+    (void) any_window_open;
+#endif
     
     // Sunroof (any percent open > 0 means open)
     if (closures_state.which_optional_sun_roof_percent_open) {
@@ -498,6 +544,7 @@ void VehicleStateManager::update_closures_state(const CarServer_ClosuresState& c
         publish_binary_sensor("sunroof", sunroof_open);
     }
     
+#ifdef USE_TESLA_BLE_DRIVER_CONTROLS
     // Sentry mode - sync switch state from vehicle
     if (closures_state.has_sentry_mode_state && sentry_mode_switch_ != nullptr) {
         const bool sentry_active = (closures_state.sentry_mode_state.which_type == CarServer_ClosuresState_SentryModeState_Armed_tag ||
@@ -508,11 +555,15 @@ void VehicleStateManager::update_closures_state(const CarServer_ClosuresState& c
             publish_sensor_state(sentry_mode_switch_, sentry_active);
         }
     }
+#endif
     
     // Locked state (update the doors lock entity from closures if available)
     if (closures_state.which_optional_locked) {
         update_unlocked(!closures_state.optional_locked.locked);
     }
+#else
+    (void) closures_state;  // No closure entities configured
+#endif
 }
 
 // =============================================================================
@@ -531,6 +582,7 @@ void VehicleStateManager::update_unlocked(bool unlocked) {
         auto new_state = unlocked ? lock::LOCK_STATE_UNLOCKED : lock::LOCK_STATE_LOCKED;
         if (doors_lock_->state != new_state) {
             doors_lock_->publish_state(new_state);
+            publish_count_++;
             ESP_LOGI(STATE_MANAGER_TAG, "Vehicle lock state: %s", unlocked ? "UNLOCKED" : "LOCKED");
         }
     }
@@ -548,6 +600,7 @@ void VehicleStateManager::update_charge_flap_open(bool open) {
     if (charge_port_door_cover_ != nullptr) {
         charge_port_door_cover_->position = open ? cover::COVER_OPEN : cover::COVER_CLOSED;
         charge_port_door_cover_->publish_state();
+        publish_count_++;
         ESP_LOGD(STATE_MANAGER_TAG, "Charge port door: %s (from VCSEC)", open ? "OPEN" : "CLOSED");
     }
 }
@@ -561,6 +614,14 @@ void VehicleStateManager::update_charger_connected(bool connected) {
     publish_binary_sensor("charger", connected);
 }
 
+void VehicleStateManager::update_diagnostic_sensor(const std::string& id, float value) {
+    publish_sensor(id, value);
+}
+
+void VehicleStateManager::update_diagnostic_text_sensor(const std::string& id, const std::string& value) {
+    publish_text_sensor(id, value);
+}
+
 // =============================================================================
 // Connection state management
 // =============================================================================
@@ -585,9 +646,16 @@ void VehicleStateManager::reset_all_states() {
 
 bool VehicleStateManager::is_asleep() const {
     auto* sensor = get_binary_sensor("asleep");
+    if (const bool* staged = pending_binary_state(sensor)) return *staged;
     return sensor ? sensor->state : true;
 }
 
+bool VehicleStateManager::is_known_awake() const {
+    auto* sensor = get_binary_sensor("asleep");
+    if (const bool* staged = pending_binary_state(sensor)) return !*staged;
+    return sensor != nullptr && sensor->has_state() && !sensor->state;
+}
+
 bool VehicleStateManager::is_unlocked() const {
     // Use doors lock entity state if available, otherwise check binary sensor
     if (doors_lock_) {
@@ -598,6 +666,7 @@ bool VehicleStateManager::is_unlocked() const {
 
 bool VehicleStateManager::is_user_present() const {
     auto* sensor = get_binary_sensor("user_present");
+    if (const bool* staged = pending_binary_state(sensor)) return *staged;
     return sensor ? sensor->state : false;
 }
 
@@ -634,29 +703,74 @@ void VehicleStateManager::update_charging_amps_max(int32_t new_max) {
     }
 }
 
+// =============================================================================
+// Deferred publishing
+// =============================================================================
+
+// Publish pending entries from the front until the deadline passes; at least
+// one entry is published per call so a tiny budget still makes progress
+template<typename E, typename V, typename Publish>
+static size_t flush_entries(std::vector<std::pair<E*, V>>& pending, uint32_t start_us,
+                            uint32_t budget_us, bool& out_of_time, Publish publish) {
+    size_t flushed = 0;
+    while (flushed < pending.size() && !out_of_time) {
+        publish(pending[flushed].first, pending[flushed].second);
+        flushed++;
+        out_of_time = budget_us != 0 && micros() - start_us >= budget_us;
+    }
+    pending.erase(pending.begin(), pending.begin() + flushed);
+    return flushed;
+}
+
+void VehicleStateManager::flush_pending() {
+    if (get_pending_count() == 0) return;
+
+    const uint32_t start = micros();
+    bool out_of_time = false;
+    flush_entries(pending_binary_sensors_, start, publish_budget_us_, out_of_time,
+                  [this](binary_sensor::BinarySensor* sensor, bool state) { publish_now(sensor, state); });
+    flush_entries(pending_text_sensors_, start, publish_budget_us_, out_of_time,
+                  [this](text_sensor::TextSensor* sensor, const std::string& state) { publish_now(sensor, state); });
+    flush_entries(pending_sensors_, start, publish_budget_us_, out_of_time,
+                  [this](sensor::Sensor* sensor, float state) { publish_now(sensor, state); });
+
+    if (out_of_time && get_pending_count() > 0) {
+        ESP_LOGV(STATE_MANAGER_TAG, "Publish budget spent - %u entities left for the next loop",
+                 static_cast<unsigned>(get_pending_count()));
+    }
+}
+
+void VehicleStateManager::flush_all() {
+    const uint32_t budget = publish_budget_us_;
+    publish_budget_us_ = 0;
+    flush_pending();
+    publish_budget_us_ = budget;
+}
+
+size_t VehicleStateManager::get_pending_count() const {
+    return pending_binary_sensors_.size() + pending_text_sensors_.size() + pending_sensors_.size();
+}
+
 // =============================================================================
 // Private helper methods
 // =============================================================================
 
 bool VehicleStateManager::publish_sensor_state(binary_sensor::BinarySensor* sensor, bool state) {
-    if (sensor != nullptr && (!sensor->has_state() || sensor->state != state)) {
-        sensor->publish_state(state);
-        return true;
-    }
-    return false;
+    if (sensor == nullptr) return false;
+    if (publish_budget_us_ == 0) return publish_now(sensor, state);
+    return stage_value(pending_binary_sensors_, sensor, state);
 }
 
 bool VehicleStateManager::publish_sensor_state(sensor::Sensor* sensor, float state) {
-    if (sensor != nullptr && (!sensor->has_state() || std::abs(sensor->state - state) > 0.001f)) {
-        sensor->publish_state(state);
-        return true;
-    }
-    return false;
+    if (sensor == nullptr) return false;
+    if (publish_budget_us_ == 0) return publish_now(sensor, state);
+    return stage_value(pending_sensors_, sensor, state);
 }
 
 bool VehicleStateManager::publish_sensor_state(switch_::Switch* switch_comp, bool state) {
     if (switch_comp != nullptr && (!switch_comp->has_state() || switch_comp->state != state)) {
         switch_comp->publish_state(state);
+        publish_count_++;
         return true;
     }
     return false;
@@ -665,27 +779,78 @@ bool VehicleStateManager::publish_sensor_state(switch_::Switch* switch_comp, boo
 bool VehicleStateManager::publish_sensor_state(number::Number* number_comp, float state) {
     if (number_comp != nullptr && (!number_comp->has_state() || std::abs(number_comp->state - state) > 0.001f)) {
         number_comp->publish_state(state);
+        publish_count_++;
         return true;
     }
     return false;
 }
 
 bool VehicleStateManager::publish_sensor_state(text_sensor::TextSensor* sensor, const std::string& state) {
+    if (sensor == nullptr) return false;
+    if (publish_budget_us_ == 0) return publish_now(sensor, state);
+    return stage_value(pending_text_sensors_, sensor, state);
+}
+
+bool VehicleStateManager::publish_now(binary_sensor::BinarySensor* sensor, bool state) {
+    if (sensor != nullptr && (!sensor->has_state() || sensor->state != state)) {
+        sensor->publish_state(state);
+        publish_count_++;
+        return true;
+    }
+    return false;
+}
+
+bool VehicleStateManager::publish_now(sensor::Sensor* sensor, float state) {
+    if (sensor != nullptr && (!sensor->has_state() || std::abs(sensor->state - state) > 0.001f)) {
+        sensor->publish_state(state);
+        publish_count_++;
+        return true;
+    }
+    return false;
+}
+
+bool VehicleStateManager::publish_now(text_sensor::TextSensor* sensor, const std::string& state) {
     if (sensor != nullptr && (!sensor->has_state() || sensor->state != state)) {
         sensor->publish_state(state);
+        publish_count_++;
         return true;
     }
     return false;
 }
 
+void VehicleStateManager::drop_pending(const binary_sensor::BinarySensor* sensor) {
+    pending_binary_sensors_.erase(
+        std::remove_if(pending_binary_sensors_.begin(), pending_binary_sensors_.end(),
+                       [sensor](const auto& entry) { return entry.first == sensor; }),
+        pending_binary_sensors_.end());
+}
+
+void VehicleStateManager::drop_pending(const sensor::Sensor* sensor) {
+    pending_sensors_.erase(
+        std::remove_if(pending_sensors_.begin(), pending_sensors_.end(),
+                       [sensor](const auto& entry) { return entry.first == sensor; }),
+        pending_sensors_.end());
+}
+
+const bool* VehicleStateManager::pending_binary_state(const binary_sensor::BinarySensor* sensor) const {
+    if (sensor == nullptr) return nullptr;
+    for (const auto& entry : pending_binary_sensors_) {
+        if (entry.first == sensor) return &entry.second;
+    }
+    return nullptr;
+}
+
 void VehicleStateManager::set_sensor_available(binary_sensor::BinarySensor* sensor, bool available) {
     if (sensor != nullptr) {
+        // A staged value would make the sensor available again on flush
+        if (!available) drop_pending(sensor);
         sensor->set_has_state(available);
     }
 }
 
 void VehicleStateManager::set_sensor_available(sensor::Sensor* sensor, bool available) {
     if (sensor != nullptr) {
+        if (!available) drop_pending(sensor);
         sensor->set_has_state(available);
     }
 }
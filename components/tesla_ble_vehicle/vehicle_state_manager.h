@@ -12,6 +12,8 @@
 #include <optional>
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 #include <car_server.pb.h>
 #include <vcsec.pb.h>
 
@@ -31,6 +33,12 @@ class TeslaBLEVehicle;
  * without modifying C++ code - just add to the Python sensor definitions.
  * 
  * Sensors are stored by string ID and can be accessed via get_*() methods in update functions.
+ *
+ * Changed sensor, binary sensor and text sensor values are staged rather than
+ * published inline, and flush_pending() publishes them from the main loop
+ * within a per-iteration time budget. Locks, covers, climate, switches and
+ * numbers are few, user-facing and read back by the update paths, so they
+ * always publish immediately.
  */
 class VehicleStateManager {
 public:
@@ -109,6 +117,10 @@ public:
     void update_charging_amps(float amps);
     void update_charger_connected(bool connected);
     
+    // Component diagnostics (published by TeslaBLEVehicle, not vehicle state)
+    void update_diagnostic_sensor(const std::string& id, float value);
+    void update_diagnostic_text_sensor(const std::string& id, const std::string& value);
+    
     // ==========================================================================
     // Connection state management
     // ==========================================================================
@@ -119,10 +131,13 @@ public:
     // State queries
     // ==========================================================================
     bool is_asleep() const;
+    bool is_known_awake() const;
     bool is_unlocked() const;
     bool is_user_present() const;
     bool is_charge_flap_open() const;
     bool is_charging() const { return is_charging_; }
+    // Entity publishes since boot, for measuring update fan-out
+    uint32_t get_publish_count() const { return publish_count_; }
     float get_charging_amps() const;
     
     // ==========================================================================
@@ -132,6 +147,17 @@ public:
     int get_charging_amps_max() const { return charging_amps_max_; }
     void set_charging_amps_max(int max) { charging_amps_max_ = max; }
     
+    // ==========================================================================
+    // Deferred publishing
+    // ==========================================================================
+    // 0 publishes every change inline
+    void set_publish_budget(uint32_t budget_us) { publish_budget_us_ = budget_us; }
+    // Publish staged values until the budget is spent; called once per loop()
+    void flush_pending();
+    // Publish everything staged regardless of the budget
+    void flush_all();
+    size_t get_pending_count() const;
+    
     
 private:
     TeslaBLEVehicle* parent_;
@@ -169,6 +195,15 @@ private:
     bool is_charging_{false};
     bool is_user_present_{false};
     int charging_amps_max_{32};
+    uint32_t publish_count_{0};
+    
+    // Staged values, flushed in this order: binary sensors (doors, windows,
+    // charger), then text sensors, then numeric sensors. A newer value for an
+    // entity that is still pending replaces the staged one.
+    std::vector<std::pair<binary_sensor::BinarySensor*, bool>> pending_binary_sensors_;
+    std::vector<std::pair<text_sensor::TextSensor*, std::string>> pending_text_sensors_;
+    std::vector<std::pair<sensor::Sensor*, float>> pending_sensors_;
+    uint32_t publish_budget_us_{2000};
     
     // Climate state tracking
     float current_inside_temp_{NAN};
@@ -191,6 +226,14 @@ private:
     bool publish_sensor_state(number::Number* number_comp, float state);
     bool publish_sensor_state(text_sensor::TextSensor* sensor, const std::string& state);
     
+    // Publish to the entity now if the value changed
+    bool publish_now(binary_sensor::BinarySensor* sensor, bool state);
+    bool publish_now(sensor::Sensor* sensor, float state);
+    bool publish_now(text_sensor::TextSensor* sensor, const std::string& state);
+    void drop_pending(const binary_sensor::BinarySensor* sensor);
+    void drop_pending(const sensor::Sensor* sensor);
+    const bool* pending_binary_state(const binary_sensor::BinarySensor* sensor) const;
+    
     void set_sensor_available(binary_sensor::BinarySensor* sensor, bool available);
     void set_sensor_available(sensor::Sensor* sensor, bool available);
     
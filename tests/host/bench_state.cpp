@@ -0,0 +1,133 @@
+#include "host_env.h"
+#include "state_benchmark.h"
+#include "vehicle_state_manager.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+/**
+ * tesla_ble_state_bench: runs StateBenchmark over the fixture payloads
+ * against a state manager with every entity it can publish to, and prints
+ * the BENCHMARK JSON lines to stdout. Other log lines stay at the host
+ * default (WARN) so printing them does not end up in the timings.
+ *
+ *   tesla_ble_state_bench [iterations]
+ *
+ * Allocations are counted through the same hook the device build uses, so
+ * allocs_per_update is comparable between the two.
+ */
+
+using namespace esphome;
+using esphome::tesla_ble_vehicle::StateBenchmark;
+using esphome::tesla_ble_vehicle::VehicleStateManager;
+
+extern "C" void esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps);
+
+void* operator new(size_t size) {
+    void* ptr = std::malloc(size != 0 ? size : 1);
+    if (ptr == nullptr) throw std::bad_alloc();
+    esp_heap_trace_alloc_hook(ptr, size, 0);
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+class BenchLock : public lock::Lock {
+protected:
+    void control(const lock::LockCall&) override {}
+};
+
+class BenchCover : public cover::Cover {
+public:
+    cover::CoverTraits get_traits() override { return {}; }
+
+protected:
+    void control(const cover::CoverCall&) override {}
+};
+
+class BenchSwitch : public switch_::Switch {
+protected:
+    void write_state(bool) override {}
+};
+
+class BenchNumber : public number::Number {
+protected:
+    void control(float) override {}
+};
+
+static const char* const SENSOR_IDS[] = {
+    "battery_level", "charge_current_request", "charger_current", "charger_phases", "charger_power",
+    "charger_voltage", "charging_rate", "energy_added", "evse_max_current", "odometer", "outside_temp",
+    "range", "time_to_full", "tpms_front_left", "tpms_front_right", "tpms_rear_left", "tpms_rear_right",
+    "vehicle_max_charge_current",
+};
+
+static const char* const BINARY_SENSOR_IDS[] = {
+    "asleep", "charger", "door_driver_front", "door_driver_rear", "door_passenger_front",
+    "door_passenger_rear", "parking_brake", "sunroof", "user_present", "window_driver_front",
+    "window_driver_rear", "window_passenger_front", "window_passenger_rear",
+};
+
+static const char* const TEXT_SENSOR_IDS[] = {
+    "charge_limit_reason", "charging_state", "iec61851_state", "shift_state",
+};
+
+int main(int argc, char** argv) {
+    const long iterations = argc > 1 ? atol(argv[1]) : 1000;
+    if (iterations <= 0) {
+        fprintf(stderr, "usage: tesla_ble_state_bench [iterations]\n");
+        return 2;
+    }
+    VehicleStateManager manager(nullptr);
+
+    std::vector<std::unique_ptr<sensor::Sensor>> sensors;
+    for (const char* id : SENSOR_IDS) {
+        sensors.push_back(std::make_unique<sensor::Sensor>());
+        manager.set_sensor(id, sensors.back().get());
+    }
+    std::vector<std::unique_ptr<binary_sensor::BinarySensor>> binary_sensors;
+    for (const char* id : BINARY_SENSOR_IDS) {
+        binary_sensors.push_back(std::make_unique<binary_sensor::BinarySensor>());
+        manager.set_binary_sensor(id, binary_sensors.back().get());
+    }
+    std::vector<std::unique_ptr<text_sensor::TextSensor>> text_sensors;
+    for (const char* id : TEXT_SENSOR_IDS) {
+        text_sensors.push_back(std::make_unique<text_sensor::TextSensor>());
+        manager.set_text_sensor(id, text_sensors.back().get());
+    }
+
+    BenchLock doors, charge_port_latch;
+    BenchCover trunk, frunk, windows, charge_port_door;
+    BenchSwitch charging, sentry_mode, steering_wheel_heat;
+    BenchNumber charging_amps, charging_limit;
+    manager.set_doors_lock(&doors);
+    manager.set_charge_port_latch_lock(&charge_port_latch);
+    manager.set_trunk_cover(&trunk);
+    manager.set_frunk_cover(&frunk);
+    manager.set_windows_cover(&windows);
+    manager.set_charge_port_door_cover(&charge_port_door);
+    manager.set_charging_switch(&charging);
+    manager.set_sentry_mode_switch(&sentry_mode);
+    manager.set_steering_wheel_heat_switch(&steering_wheel_heat);
+    manager.set_charging_amps_number(&charging_amps);
+    manager.set_charging_limit_number(&charging_limit);
+
+    // Only the result lines; the rest of the log stays in the history
+    std::vector<std::string> results;
+    host::set_log_hook([&results](const std::string& line) {
+        const size_t pos = line.find("BENCHMARK {");
+        if (pos != std::string::npos) results.push_back(line.substr(pos + strlen("BENCHMARK ")));
+    });
+
+    StateBenchmark benchmark(&manager);
+    benchmark.run(static_cast<uint32_t>(iterations));
+    host::set_log_hook(nullptr);
+
+    for (const auto& result : results) printf("%s\n", result.c_str());
+    return results.empty() ? 1 : 0;
+}
@@ -0,0 +1,675 @@
+#include "fake_vehicle.h"
+#include "host_env.h"
+#include "wire_format.h"
+#include <esphome/components/esp32_ble/ble.h>
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+namespace host {
+
+// =============================================================================
+// Messages
+// =============================================================================
+
+// RoutableMessage / Destination field numbers (universal_message.proto)
+static const uint32_t FIELD_TO_DESTINATION = 6;
+static const uint32_t FIELD_FROM_DESTINATION = 7;
+static const uint32_t FIELD_PAYLOAD = 10;
+static const uint32_t FIELD_SIGNED_MESSAGE_STATUS = 12;
+static const uint32_t FIELD_SIGNATURE_DATA = 13;
+static const uint32_t FIELD_SESSION_INFO_REQUEST = 14;
+static const uint32_t FIELD_SESSION_INFO = 15;
+static const uint32_t FIELD_REQUEST_UUID = 50;
+static const uint32_t FIELD_UUID = 51;
+static const uint32_t FIELD_FLAGS = 52;
+static const uint32_t DESTINATION_DOMAIN = 1;
+static const uint32_t DESTINATION_ROUTING_ADDRESS = 2;
+
+// SessionInfoRequest, SessionInfo, SignatureData and its parts
+// (universal_message.proto, signatures.proto)
+static const uint32_t SESSION_INFO_REQUEST_PUBLIC_KEY = 1;
+static const uint32_t SESSION_INFO_COUNTER = 1;
+static const uint32_t SESSION_INFO_PUBLIC_KEY = 2;
+static const uint32_t SESSION_INFO_EPOCH = 3;
+static const uint32_t SESSION_INFO_CLOCK_TIME = 4;
+static const uint32_t SIGNATURE_SIGNER_IDENTITY = 1;
+static const uint32_t SIGNATURE_AES_GCM_PERSONALIZED = 5;
+static const uint32_t SIGNATURE_SESSION_INFO_TAG = 6;
+static const uint32_t SIGNATURE_AES_GCM_RESPONSE = 9;
+static const uint32_t KEY_IDENTITY_PUBLIC_KEY = 1;
+static const uint32_t HMAC_SIGNATURE_TAG = 1;
+static const uint32_t GCM_EPOCH = 1;
+static const uint32_t GCM_NONCE = 2;
+static const uint32_t GCM_COUNTER = 3;
+static const uint32_t GCM_EXPIRES_AT = 4;
+static const uint32_t GCM_TAG = 5;
+static const uint32_t GCM_RESPONSE_NONCE = 1;
+static const uint32_t GCM_RESPONSE_COUNTER = 2;
+static const uint32_t GCM_RESPONSE_TAG = 3;
+
+// MessageStatus: operation_status = 1, signed_message_fault = 2
+static const uint32_t OPERATION_STATUS_ERROR = 2;
+static const uint32_t FAULT_UNKNOWN_KEY_ID = 3;
+static const uint32_t FAULT_INVALID_SIGNATURE = 5;
+static const uint32_t FAULT_INVALID_TOKEN_OR_COUNTER = 6;
+static const uint32_t FAULT_BAD_PARAMETER = 13;
+static const uint32_t FAULT_INCORRECT_EPOCH = 15;
+static const uint32_t FAULT_TIME_EXPIRED = 17;
+
+// UnsignedMessage.RKEAction = 2 (vcsec.proto)
+static const uint32_t VCSEC_RKE_ACTION = 2;
+static const uint32_t RKE_ACTION_UNLOCK = 0;
+static const uint32_t RKE_ACTION_LOCK = 1;
+static const uint32_t RKE_ACTION_WAKE_VEHICLE = 30;
+
+static const size_t EPOCH_SIZE = 16;
+// A message left incomplete by a lost chunk is dropped once the next one
+// starts this much later
+static const uint32_t REASSEMBLY_TIMEOUT_MS = 1000;
+
+static uint32_t destination_domain(const std::vector<uint8_t>& message, uint32_t destination) {
+    WireField field;
+    if (!find_field(bytes_field(message, destination), DESTINATION_DOMAIN, field)) return 0;
+    return static_cast<uint32_t>(field.value);
+}
+
+static std::vector<uint8_t> routing_destination(const std::vector<uint8_t>& routing_address) {
+    std::vector<uint8_t> destination;
+    put_bytes_field(destination, DESTINATION_ROUTING_ADDRESS, routing_address);
+    return destination;
+}
+
+// A captured response carries the routing address and request UUID of the
+// request it answered; point it at the live request instead
+static std::vector<uint8_t> readdress(const std::vector<uint8_t>& response, const std::vector<uint8_t>& routing_address,
+                                      const std::vector<uint8_t>& request_uuid) {
+    const bool to_routing_address =
+        !routing_address.empty() &&
+        !bytes_field(bytes_field(response, FIELD_TO_DESTINATION), DESTINATION_ROUTING_ADDRESS).empty();
+    WireField uuid;
+    const bool has_request_uuid = !request_uuid.empty() && find_field(response, FIELD_REQUEST_UUID, uuid);
+
+    std::vector<uint8_t> out;
+    WireReader reader(response);
+    WireField field;
+    while (reader.next(field)) {
+        if (to_routing_address && field.number == FIELD_TO_DESTINATION) continue;
+        if (has_request_uuid && field.number == FIELD_REQUEST_UUID) continue;
+        out.insert(out.end(), field.start, field.end);
+    }
+    if (to_routing_address) put_bytes_field(out, FIELD_TO_DESTINATION, routing_destination(routing_address));
+    if (has_request_uuid) put_bytes_field(out, FIELD_REQUEST_UUID, request_uuid);
+    return out;
+}
+
+// =============================================================================
+// Captures
+// =============================================================================
+
+bool parse_hex(const std::string& text, std::vector<uint8_t>& out) {
+    if (text.empty() || text.size() % 2 != 0) return false;
+    for (size_t i = 0; i < text.size(); i += 2) {
+        if (!std::isxdigit(static_cast<unsigned char>(text[i])) ||
+            !std::isxdigit(static_cast<unsigned char>(text[i + 1]))) {
+            return false;
+        }
+        out.push_back(static_cast<uint8_t>(std::stoul(text.substr(i, 2), nullptr, 16)));
+    }
+    return true;
+}
+
+// The data lines of the last dump in a device log
+static std::vector<uint8_t> capture_from_log(const std::string& log) {
+    std::vector<uint8_t> data;
+    std::istringstream lines(log);
+    std::string line;
+    while (std::getline(lines, line)) {
+        const size_t marker = line.find("CAPTURE ");
+        if (marker == std::string::npos) continue;
+        std::istringstream rest(line.substr(marker + 8));
+        std::string token;
+        rest >> token;
+        if (token == "v1") {
+            data.clear();
+            continue;
+        }
+        // Strip a trailing colour reset or similar
+        const size_t hex_end = token.find_first_not_of("0123456789abcdefABCDEF");
+        parse_hex(token.substr(0, hex_end), data);
+    }
+    return data;
+}
+
+bool parse_capture(const std::string& contents, std::vector<CaptureRecord>& records) {
+    const bool is_log = contents.find("CAPTURE v1") != std::string::npos;
+    const std::vector<uint8_t> data =
+        is_log ? capture_from_log(contents) : std::vector<uint8_t>(contents.begin(), contents.end());
+
+    static const size_t HEADER_SIZE = 9;
+    size_t pos = 0;
+    while (pos + HEADER_SIZE <= data.size()) {
+        CaptureRecord record;
+        record.timestamp = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16) |
+                           (static_cast<uint32_t>(data[pos + 3]) << 24);
+        if (data[pos + 4] > 1) return false;
+        record.tx = data[pos + 4] == 1;
+        record.conn_id = static_cast<uint16_t>(data[pos + 5] | (data[pos + 6] << 8));
+        const size_t len = data[pos + 7] | (data[pos + 8] << 8);
+        pos += HEADER_SIZE;
+        if (pos + len > data.size()) return false;
+        record.data.assign(data.begin() + pos, data.begin() + pos + len);
+        pos += len;
+        records.push_back(std::move(record));
+    }
+    return pos == data.size() && !records.empty();
+}
+
+bool load_capture_file(const std::string& path, std::vector<CaptureRecord>& records) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return parse_capture(contents.str(), records);
+}
+
+void MessageAssembler::push(const uint8_t* data, size_t len, std::vector<std::vector<uint8_t>>& messages) {
+    buffer_.insert(buffer_.end(), data, data + len);
+    while (buffer_.size() >= 2) {
+        const size_t message_len = (buffer_[0] << 8) | buffer_[1];
+        if (buffer_.size() < message_len + 2) return;
+        messages.emplace_back(buffer_.begin() + 2, buffer_.begin() + 2 + message_len);
+        buffer_.erase(buffer_.begin(), buffer_.begin() + 2 + message_len);
+    }
+}
+
+// =============================================================================
+// FakeVehicle
+// =============================================================================
+
+namespace espbt = esphome::esp32_ble_tracker;
+
+FakeVehicle::FakeVehicle(esphome::ble_client::BLEClient* client) : client_(client), last_activity_(time_ms()) {
+    publish_gatt_table();
+
+    set_gattc_write_hook([this](const GattcWrite& write) { return on_write(write.handle, write.data); });
+    set_register_for_notify_hook([this](uint16_t handle) {
+        if (!link_up_) return ESP_FAIL;
+        schedule(link_.latency_ms, [this, handle]() {
+            esp_ble_gattc_cb_param_t param{};
+            param.reg_for_notify.status = ESP_GATT_OK;
+            param.reg_for_notify.handle = handle;
+            deliver(ESP_GATTC_REG_FOR_NOTIFY_EVT, param);
+        });
+        return ESP_OK;
+    });
+    // The car takes whatever connection parameters it is asked for
+    set_conn_params_hook([this](const esp_ble_conn_update_params_t& request) {
+        if (!link_up_) return ESP_FAIL;
+        schedule(link_.latency_ms, [this, request]() {
+            if (!link_up_) return;
+            conn_interval_ = request.max_int;
+            esp_ble_gap_cb_param_t param{};
+            param.update_conn_params.status = ESP_BT_STATUS_SUCCESS;
+            std::copy(request.bda, request.bda + 6, param.update_conn_params.bda);
+            param.update_conn_params.min_int = request.min_int;
+            param.update_conn_params.max_int = request.max_int;
+            param.update_conn_params.latency = request.latency;
+            param.update_conn_params.conn_int = request.max_int;
+            param.update_conn_params.timeout = request.timeout;
+            esphome::esp32_ble::global_ble->dispatch_gap_event(ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT, &param);
+        });
+        return ESP_OK;
+    });
+    set_read_rssi_hook([this]() {
+        if (!link_up_) return ESP_FAIL;
+        schedule(0, [this]() {
+            if (!link_up_) return;
+            esp_ble_gap_cb_param_t param{};
+            param.read_rssi_cmpl.status = ESP_BT_STATUS_SUCCESS;
+            param.read_rssi_cmpl.rssi = link_.rssi;
+            std::copy(client_->get_remote_bda(), client_->get_remote_bda() + 6, param.read_rssi_cmpl.remote_addr);
+            esphome::esp32_ble::global_ble->dispatch_gap_event(ESP_GAP_BLE_READ_RSSI_COMPLETE_EVT, &param);
+        });
+        return ESP_OK;
+    });
+    client_->set_on_disconnect([this]() { close_link(); });
+}
+
+FakeVehicle::~FakeVehicle() {
+    set_gattc_write_hook(nullptr);
+    set_register_for_notify_hook(nullptr);
+    set_conn_params_hook(nullptr);
+    set_read_rssi_hook(nullptr);
+    client_->set_on_disconnect(nullptr);
+}
+
+void FakeVehicle::add_capture(const std::vector<CaptureRecord>& records) {
+    MessageAssembler tx;
+    MessageAssembler rx;
+    Exchange* current = nullptr;
+    for (const auto& record : records) {
+        std::vector<std::vector<uint8_t>> messages;
+        (record.tx ? tx : rx).push(record.data.data(), record.data.size(), messages);
+        for (auto& message : messages) {
+            if (record.tx) {
+                auto& exchanges = captured_[destination_domain(message, FIELD_TO_DESTINATION)];
+                exchanges.emplace_back();
+                current = &exchanges.back();
+            } else if (current != nullptr) {
+                // Anything before the first request has nothing to answer
+                current->responses.push_back(std::move(message));
+            }
+        }
+    }
+}
+
+void FakeVehicle::connect() {
+    if (link_up_ || client_->state() == espbt::ClientState::CONNECTING) return;
+    client_->set_state(espbt::ClientState::CONNECTING);
+    schedule(link_.connect_ms, [this]() {
+        link_up_ = true;
+        discovering_ = true;
+        requests_in_.clear();
+        client_->set_state(espbt::ClientState::CONNECTED);
+        esp_ble_gattc_cb_param_t param{};
+        param.open.status = ESP_GATT_OK;
+        param.open.conn_id = client_->get_conn_id();
+        std::copy(client_->get_remote_bda(), client_->get_remote_bda() + 6, param.open.remote_bda);
+        param.open.mtu = link_.mtu;
+        deliver(ESP_GATTC_OPEN_EVT, param);
+    });
+    // The client base asks for the MTU on open and discovers once it is agreed
+    schedule(link_.connect_ms + link_.connect_ms / 2, [this]() {
+        if (!link_up_) return;
+        esp_ble_gattc_cb_param_t param{};
+        param.cfg_mtu.status = ESP_GATT_OK;
+        param.cfg_mtu.conn_id = client_->get_conn_id();
+        param.cfg_mtu.mtu = link_.mtu;
+        deliver(ESP_GATTC_CFG_MTU_EVT, param);
+    });
+    schedule(2 * link_.connect_ms, [this]() {
+        if (!link_up_) return;
+        discovering_ = false;
+        publish_gatt_table();
+        esp_ble_gattc_cb_param_t param{};
+        param.search_cmpl.status = ESP_GATT_OK;
+        param.search_cmpl.conn_id = client_->get_conn_id();
+        deliver(ESP_GATTC_SEARCH_CMPL_EVT, param);
+        client_->set_state(espbt::ClientState::ESTABLISHED);
+    });
+}
+
+void FakeVehicle::drop_link() { close_link(); }
+
+void FakeVehicle::set_gatt_handles(uint16_t read_handle, uint16_t cccd_handle, uint16_t write_handle) {
+    read_handle_ = read_handle;
+    cccd_handle_ = cccd_handle;
+    write_handle_ = write_handle;
+}
+
+// What the client base finds on discovery
+void FakeVehicle::publish_gatt_table() {
+    const auto service = espbt::ESPBTUUID::from_raw(esphome::tesla_ble_vehicle::SERVICE_UUID);
+    client_->clear_characteristics();
+    client_->add_characteristic(service, espbt::ESPBTUUID::from_raw(esphome::tesla_ble_vehicle::READ_UUID),
+                                read_handle_, cccd_handle_);
+    client_->add_characteristic(service, espbt::ESPBTUUID::from_raw(esphome::tesla_ble_vehicle::WRITE_UUID),
+                                write_handle_);
+}
+
+void FakeVehicle::close_link() {
+    if (!link_up_) return;
+    link_up_ = false;
+    discovering_ = false;
+    // Whatever was still in the air is lost with the link
+    events_.clear();
+    schedule(0, [this]() {
+        esp_ble_gattc_cb_param_t param{};
+        param.disconnect.conn_id = client_->get_conn_id();
+        deliver(ESP_GATTC_DISCONNECT_EVT, param);
+        client_->set_state(espbt::ClientState::IDLE);
+        param = {};
+        param.close.status = ESP_GATT_OK;
+        param.close.conn_id = client_->get_conn_id();
+        deliver(ESP_GATTC_CLOSE_EVT, param);
+    });
+}
+
+void FakeVehicle::push_status() {
+    if (link_up_ && !routing_address_.empty()) send(vehicle_status_message({}));
+}
+
+void FakeVehicle::wake() {
+    if (!asleep() || waking_) return;
+    waking_ = true;
+    wake_at_ = time_ms() + WAKE_MS;
+}
+
+void FakeVehicle::loop() {
+    update_sleep();
+    const uint32_t now = time_ms();
+    while (!events_.empty() && static_cast<int32_t>(now - events_.begin()->first) >= 0) {
+        auto event = std::move(events_.begin()->second);
+        events_.erase(events_.begin());
+        event();
+    }
+}
+
+uint32_t FakeVehicle::get_requests(uint32_t domain) const {
+    auto it = requests_.find(domain);
+    return it != requests_.end() ? it->second : 0;
+}
+
+void FakeVehicle::schedule(uint32_t delay_ms, std::function<void()> event) {
+    events_.emplace(time_ms() + delay_ms, std::move(event));
+}
+
+void FakeVehicle::deliver(esp_gattc_cb_event_t event, esp_ble_gattc_cb_param_t& param) {
+    client_->gattc_event_handler(event, &param);
+}
+
+// Sleep and wake are the car's own, so they outlive the link
+void FakeVehicle::update_sleep() {
+    const uint32_t now = time_ms();
+    if (waking_) {
+        if (static_cast<int32_t>(now - wake_at_) < 0) return;
+        waking_ = false;
+        status_.sleep_status = SLEEP_STATUS_AWAKE;
+        last_activity_ = now;
+        push_status();
+    } else if (sleep_timeout_ms_ != 0 && !asleep() && now - last_activity_ >= sleep_timeout_ms_) {
+        status_.sleep_status = SLEEP_STATUS_ASLEEP;
+        push_status();
+    }
+}
+
+esp_err_t FakeVehicle::on_write(uint16_t handle, const std::vector<uint8_t>& data) {
+    if (!link_up_) return ESP_FAIL;
+    if (handle == cccd_handle_) return ESP_OK;
+    if (handle != write_handle_) {
+        stray_writes_++;
+        return ESP_OK;
+    }
+    if (discovering_) writes_during_discovery_++;
+
+    writes_++;
+    // The write completes on the component's side either way
+    if (link_.loss_percent != 0 && random_() % 100 < link_.loss_percent) {
+        writes_lost_++;
+        return ESP_OK;
+    }
+    schedule(link_.latency_ms, [this, data]() { receive(data); });
+    return ESP_OK;
+}
+
+void FakeVehicle::receive(const std::vector<uint8_t>& data) {
+    const uint32_t now = time_ms();
+    if (now - last_write_ >= REASSEMBLY_TIMEOUT_MS) requests_in_.clear();
+    last_write_ = now;
+
+    std::vector<std::vector<uint8_t>> messages;
+    requests_in_.push(data.data(), data.size(), messages);
+    for (const auto& message : messages) on_request(message);
+}
+
+void FakeVehicle::on_request(const std::vector<uint8_t>& message) {
+    const uint32_t domain = destination_domain(message, FIELD_TO_DESTINATION);
+    requests_[domain]++;
+    const auto routing_address =
+        bytes_field(bytes_field(message, FIELD_FROM_DESTINATION), DESTINATION_ROUTING_ADDRESS);
+    if (!routing_address.empty()) routing_address_ = routing_address;
+    const auto uuid = bytes_field(message, FIELD_UUID);
+
+    // Infotainment is powered down while the car sleeps, and its traffic is
+    // what keeps the car awake
+    if (domain == DOMAIN_INFOTAINMENT) {
+        if (asleep()) return;
+        last_activity_ = time_ms();
+    }
+
+    auto& exchanges = captured_[domain];
+    size_t& next = next_exchange_[domain];
+    if (next < exchanges.size()) {
+        for (const auto& response : exchanges[next].responses) {
+            send(readdress(response, routing_address_, uuid));
+            replayed_responses_++;
+        }
+        next++;
+        return;
+    }
+
+    WireField field;
+    if (find_field(message, FIELD_SESSION_INFO_REQUEST, field)) {
+        on_session_info_request(domain, message, uuid);
+    } else if (!bytes_field(bytes_field(message, FIELD_SIGNATURE_DATA), SIGNATURE_AES_GCM_PERSONALIZED).empty()) {
+        on_signed_request(domain, message, uuid);
+    } else if (domain == DOMAIN_VCSEC) {
+        send(vehicle_status_message(uuid));
+        generated_responses_++;
+    }
+}
+
+// SessionInfo (signatures.proto), tagged with the session key agreed with
+// the public key in the request
+void FakeVehicle::on_session_info_request(uint32_t domain, const std::vector<uint8_t>& message,
+                                          const std::vector<uint8_t>& uuid) {
+    const auto client_public_key =
+        bytes_field(bytes_field(message, FIELD_SESSION_INFO_REQUEST), SESSION_INFO_REQUEST_PUBLIC_KEY);
+    auto key = key_.session_key(client_public_key);
+    if (key.empty()) {
+        send_fault(domain, FAULT_BAD_PARAMETER, uuid);
+        return;
+    }
+    Session& session = sessions_[domain];
+    if (session.epoch.empty()) {
+        for (size_t i = 0; i < EPOCH_SIZE; i++) session.epoch.push_back(static_cast<uint8_t>(random_()));
+        session.clock_start = time_ms() / 1000;
+    }
+    session.client_public_key = client_public_key;
+    session.key = std::move(key);
+
+    std::vector<uint8_t> info;
+    put_varint_field(info, SESSION_INFO_COUNTER, session.counter);
+    put_bytes_field(info, SESSION_INFO_PUBLIC_KEY, key_.public_key());
+    put_bytes_field(info, SESSION_INFO_EPOCH, session.epoch);
+    put_fixed32_field(info, SESSION_INFO_CLOCK_TIME, time_ms() / 1000 - session.clock_start);
+
+    std::vector<uint8_t> hmac;
+    put_bytes_field(hmac, HMAC_SIGNATURE_TAG, session_info_tag(session.key, vin_, uuid, info));
+    std::vector<uint8_t> signature;
+    put_bytes_field(signature, SIGNATURE_SESSION_INFO_TAG, hmac);
+
+    std::vector<uint8_t> response = response_header(domain);
+    put_bytes_field(response, FIELD_SESSION_INFO, info);
+    put_bytes_field(response, FIELD_SIGNATURE_DATA, signature);
+    if (!uuid.empty()) put_bytes_field(response, FIELD_REQUEST_UUID, uuid);
+    send(response);
+}
+
+// AES_GCM_Personalized request in, AES_GCM_Response out, both under the
+// session key
+void FakeVehicle::on_signed_request(uint32_t domain, const std::vector<uint8_t>& message,
+                                    const std::vector<uint8_t>& uuid) {
+    const auto signature = bytes_field(message, FIELD_SIGNATURE_DATA);
+    const auto gcm = bytes_field(signature, SIGNATURE_AES_GCM_PERSONALIZED);
+    const auto signer = bytes_field(bytes_field(signature, SIGNATURE_SIGNER_IDENTITY), KEY_IDENTITY_PUBLIC_KEY);
+    auto it = sessions_.find(domain);
+    if (it == sessions_.end() || it->second.client_public_key != signer) {
+        send_fault(domain, FAULT_UNKNOWN_KEY_ID, uuid);
+        return;
+    }
+    Session& session = it->second;
+    const auto epoch = bytes_field(gcm, GCM_EPOCH);
+    const auto counter = static_cast<uint32_t>(varint_field(gcm, GCM_COUNTER));
+    const auto expires_at = static_cast<uint32_t>(varint_field(gcm, GCM_EXPIRES_AT));
+    if (epoch != session.epoch) {
+        send_fault(domain, FAULT_INCORRECT_EPOCH, uuid);
+        return;
+    }
+    if (counter <= session.counter) {
+        send_fault(domain, FAULT_INVALID_TOKEN_OR_COUNTER, uuid);
+        return;
+    }
+    if (expires_at < time_ms() / 1000 - session.clock_start) {
+        send_fault(domain, FAULT_TIME_EXPIRED, uuid);
+        return;
+    }
+    const auto flags = static_cast<uint32_t>(varint_field(message, FIELD_FLAGS));
+    const auto request_tag = bytes_field(gcm, GCM_TAG);
+    std::vector<uint8_t> plaintext;
+    if (!aes_gcm_decrypt(session.key, bytes_field(gcm, GCM_NONCE),
+                         request_aad(domain, vin_, epoch, expires_at, counter, flags),
+                         bytes_field(message, FIELD_PAYLOAD), request_tag, plaintext)) {
+        send_fault(domain, FAULT_INVALID_SIGNATURE, uuid);
+        return;
+    }
+    session.counter = counter;
+
+    std::vector<uint8_t> nonce;
+    for (size_t i = 0; i < GCM_NONCE_SIZE; i++) nonce.push_back(static_cast<uint8_t>(random_()));
+    std::vector<uint8_t> ciphertext, tag;
+    if (!aes_gcm_encrypt(session.key, nonce,
+                         response_aad(domain, vin_, counter, flags, request_hash(domain, request_tag), 0),
+                         execute(domain, plaintext), ciphertext, tag)) {
+        return;
+    }
+    std::vector<uint8_t> response_data;
+    put_bytes_field(response_data, GCM_RESPONSE_NONCE, nonce);
+    put_varint_field(response_data, GCM_RESPONSE_COUNTER, counter);
+    put_bytes_field(response_data, GCM_RESPONSE_TAG, tag);
+    std::vector<uint8_t> response_signature;
+    put_bytes_field(response_signature, SIGNATURE_AES_GCM_RESPONSE, response_data);
+
+    std::vector<uint8_t> response = response_header(domain);
+    put_bytes_field(response, FIELD_PAYLOAD, ciphertext);
+    put_bytes_field(response, FIELD_SIGNATURE_DATA, response_signature);
+    if (!uuid.empty()) put_bytes_field(response, FIELD_REQUEST_UUID, uuid);
+    if (flags != 0) put_varint_field(response, FIELD_FLAGS, flags);
+    send(response);
+    signed_responses_++;
+}
+
+// VCSEC carries out lock, unlock and wake and acknowledges with an OK
+// commandStatus (FromVCSECMessage = 4); infotainment acknowledges with an OK
+// actionStatus (Response = 1) and carries out nothing
+std::vector<uint8_t> FakeVehicle::execute(uint32_t domain, const std::vector<uint8_t>& plaintext) {
+    std::vector<uint8_t> response;
+    if (domain != DOMAIN_VCSEC) {
+        put_bytes_field(response, 1, {});
+        return response;
+    }
+    WireField action;
+    if (find_field(plaintext, VCSEC_RKE_ACTION, action) && action.wire_type == 0) {
+        if (action.value == RKE_ACTION_UNLOCK || action.value == RKE_ACTION_LOCK) {
+            status_.lock_state = action.value == RKE_ACTION_LOCK ? 1 : 0;
+            push_status();
+        } else if (action.value == RKE_ACTION_WAKE_VEHICLE) {
+            wake();
+        }
+    }
+    put_bytes_field(response, 4, {});
+    return response;
+}
+
+void FakeVehicle::send_fault(uint32_t domain, uint32_t fault, const std::vector<uint8_t>& request_uuid) {
+    std::vector<uint8_t> status;
+    put_varint_field(status, 1, OPERATION_STATUS_ERROR);
+    put_varint_field(status, 2, fault);
+    std::vector<uint8_t> message = response_header(domain);
+    put_bytes_field(message, FIELD_SIGNED_MESSAGE_STATUS, status);
+    if (!request_uuid.empty()) put_bytes_field(message, FIELD_REQUEST_UUID, request_uuid);
+    send(message);
+    faults_++;
+}
+
+void FakeVehicle::send(const std::vector<uint8_t>& message) {
+    sent_messages_.push_back(message);
+    std::vector<uint8_t> frame = {static_cast<uint8_t>(message.size() >> 8), static_cast<uint8_t>(message.size())};
+    frame.insert(frame.end(), message.begin(), message.end());
+    largest_response_ = std::max(largest_response_, frame.size());
+
+    const size_t chunk_size = std::max<size_t>(link_.mtu, 4) - 3;
+    for (size_t i = 0; i < frame.size(); i += chunk_size) {
+        if (link_.loss_percent != 0 && random_() % 100 < link_.loss_percent) {
+            notifications_lost_++;
+            continue;
+        }
+        std::vector<uint8_t> chunk(frame.begin() + i, frame.begin() + std::min(frame.size(), i + chunk_size));
+        schedule(link_.latency_ms, [this, chunk]() mutable {
+            esp_ble_gattc_cb_param_t param{};
+            param.notify.conn_id = client_->get_conn_id();
+            param.notify.handle = read_handle_;
+            param.notify.value_len = static_cast<uint16_t>(chunk.size());
+            param.notify.value = chunk.data();
+            param.notify.is_notify = true;
+            notifications_sent_++;
+            deliver(ESP_GATTC_NOTIFY_EVT, param);
+        });
+    }
+}
+
+// Addressed to the client's routing address, from the domain
+std::vector<uint8_t> FakeVehicle::response_header(uint32_t domain) const {
+    std::vector<uint8_t> from_destination;
+    put_varint_field(from_destination, DESTINATION_DOMAIN, domain);
+    std::vector<uint8_t> message;
+    put_bytes_field(message, FIELD_TO_DESTINATION, routing_destination(routing_address_));
+    put_bytes_field(message, FIELD_FROM_DESTINATION, from_destination);
+    return message;
+}
+
+// VehicleStatus (vcsec.proto): closureStatuses = 1 (chargePort = 7),
+// vehicleLockState = 2, vehicleSleepStatus = 3, userPresence = 4;
+// FromVCSECMessage.vehicleStatus = 1
+std::vector<uint8_t> FakeVehicle::vehicle_status_message(const std::vector<uint8_t>& request_uuid) const {
+    std::vector<uint8_t> closures;
+    if (status_.charge_port_open) put_varint_field(closures, 7, 1);
+    std::vector<uint8_t> vehicle_status;
+    put_bytes_field(vehicle_status, 1, closures);
+    put_varint_field(vehicle_status, 2, status_.lock_state);
+    put_varint_field(vehicle_status, 3, status_.sleep_status);
+    put_varint_field(vehicle_status, 4, status_.user_presence);
+    std::vector<uint8_t> from_vcsec;
+    put_bytes_field(from_vcsec, 1, vehicle_status);
+
+    std::vector<uint8_t> message = response_header(DOMAIN_VCSEC);
+    put_bytes_field(message, FIELD_PAYLOAD, from_vcsec);
+    if (!request_uuid.empty()) put_bytes_field(message, FIELD_REQUEST_UUID, request_uuid);
+    return message;
+}
+
+// =============================================================================
+// LoopDriver
+// =============================================================================
+
+void LoopDriver::step() {
+    car_->loop();
+    // On a device the protocol task runs on the other core while the loop
+    // goes on; here it finishes first so runs are repeatable
+    wait_for_tasks_idle();
+    vehicle_->loop();
+    const uint32_t now = time_ms();
+    if (now - last_update_ >= vehicle_->get_update_interval()) {
+        vehicle_->update();
+        last_update_ = now;
+    }
+    advance_time_ms(step_ms_);
+}
+
+void LoopDriver::run_for(uint32_t duration_ms) {
+    const uint32_t end = time_ms() + duration_ms;
+    while (static_cast<int32_t>(end - time_ms()) > 0) step();
+}
+
+bool LoopDriver::run_until(const std::function<bool()>& done, uint32_t timeout_ms) {
+    const uint32_t end = time_ms() + timeout_ms;
+    while (!done()) {
+        if (static_cast<int32_t>(end - time_ms()) <= 0) return false;
+        step();
+    }
+    return true;
+}
+
+} // namespace host
@@ -0,0 +1,259 @@
+#pragma once
+
+#include "session_crypto.h"
+#include "tesla_ble_vehicle.h"
+#include <esphome/components/ble_client/ble_client.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Host-side stand-in for the car's end of the BLE link
+ *
+ * FakeVehicle plays the GATT server: it connects the BLEClient shim through
+ * open, discovery and notification registration, reassembles the
+ * component's writes into length-prefixed messages, and answers them with
+ * notifications cut to the configured MTU. Latency and loss apply both
+ * ways: writes reach the car late or not at all, and so do its answers.
+ *
+ * Answers come from captures (tesla_ble_vehicle.dump_capture output): each
+ * request is answered with the responses recorded after the next captured
+ * request to the same domain, readdressed to the live request. Without
+ * captured responses left, the car answers as it would itself:
+ *  - session info requests with its session info, tagged with a key agreed
+ *    with the requester's public key (see session_crypto.h);
+ *  - signed requests with a signed response, or with a fault when the
+ *    session, counter or signature does not check out;
+ *  - unsigned VCSEC requests with an unsigned vehicleStatus.
+ * Unsigned infotainment requests go unanswered.
+ *
+ * The car falls asleep after the sleep timeout without infotainment traffic
+ * and wakes on a wake RKE action. Asleep, infotainment answers nothing.
+ *
+ * Replayed infotainment responses are signed for the captured session, so
+ * they only authenticate when NVS holds the key and session they were
+ * captured with.
+ */
+namespace host {
+
+// ==========================================================================
+// Captures
+// ==========================================================================
+struct CaptureRecord {
+    uint32_t timestamp;
+    bool tx;
+    uint16_t conn_id;
+    std::vector<uint8_t> data;
+};
+
+// Accepts the raw v1 records or device log text with the "CAPTURE <hex>"
+// lines dump_capture() writes
+bool parse_capture(const std::string& contents, std::vector<CaptureRecord>& records);
+bool load_capture_file(const std::string& path, std::vector<CaptureRecord>& records);
+// Appends the bytes of an even-length hex string, as dump_capture writes them
+bool parse_hex(const std::string& text, std::vector<uint8_t>& out);
+
+// Splits a chunked byte stream into messages (2-byte big-endian length
+// prefix, as the Tesla BLE transport frames them)
+class MessageAssembler {
+public:
+    void push(const uint8_t* data, size_t len, std::vector<std::vector<uint8_t>>& messages);
+    void clear() { buffer_.clear(); }
+
+private:
+    std::vector<uint8_t> buffer_;
+};
+
+// ==========================================================================
+// Fake vehicle
+// ==========================================================================
+struct LinkConfig {
+    uint16_t mtu{23};          // ATT MTU; notifications carry mtu - 3 bytes
+    uint32_t latency_ms{0};    // added to every event, each way
+    uint8_t loss_percent{0};   // write and notification chunks dropped at random
+    uint32_t connect_ms{40};   // open and discovery each take this long
+    int8_t rssi{-60};          // answer to every RSSI read
+};
+
+// VCSEC state reported by generated vehicleStatus messages; values are the
+// VCSEC enum numbers
+struct FakeVehicleStatus {
+    uint32_t sleep_status{1};   // AWAKE; 2 is ASLEEP
+    uint32_t lock_state{1};     // LOCKED
+    uint32_t user_presence{1};  // NOT_PRESENT
+    bool charge_port_open{false};
+};
+
+class FakeVehicle {
+public:
+    static constexpr uint16_t READ_HANDLE = 0x0010;
+    static constexpr uint16_t CCCD_HANDLE = 0x0011;
+    static constexpr uint16_t WRITE_HANDLE = 0x0013;
+
+    static constexpr uint32_t DOMAIN_VCSEC = 2;
+    static constexpr uint32_t DOMAIN_INFOTAINMENT = 3;
+
+    // From a wake RKE action to VCSEC reporting AWAKE
+    static constexpr uint32_t WAKE_MS = 3000;
+
+    explicit FakeVehicle(esphome::ble_client::BLEClient* client);
+    ~FakeVehicle();
+
+    void set_link(const LinkConfig& link) { link_ = link; }
+    void set_seed(uint32_t seed) { random_.seed(seed); }
+    // Signed into session info and every signature, as the car's own VIN
+    void set_vin(const std::string& vin) { vin_ = vin; }
+    // Time without infotainment traffic before the car sleeps; 0 keeps it
+    // awake
+    void set_sleep_timeout(uint32_t timeout_ms) { sleep_timeout_ms_ = timeout_ms; }
+    FakeVehicleStatus& status() { return status_; }
+
+    void add_capture(const std::vector<CaptureRecord>& records);
+
+    // Start a connection as the BLE client would on seeing the car
+    void connect();
+    // Car-side link loss
+    void drop_link();
+    // Move the Tesla characteristics, as a firmware update could; takes
+    // effect on the next discovery
+    void set_gatt_handles(uint16_t read_handle, uint16_t cccd_handle, uint16_t write_handle);
+    // Unsolicited vehicleStatus, as the car sends on state changes
+    void push_status();
+    // As a wake RKE action does: AWAKE after WAKE_MS
+    void wake();
+
+    // Deliver the events that are due; call once per main loop iteration
+    void loop();
+
+    bool link_up() const { return link_up_; }
+    bool asleep() const { return status_.sleep_status == SLEEP_STATUS_ASLEEP; }
+    std::vector<uint8_t> get_public_key() const { return key_.public_key(); }
+    bool has_session(uint32_t domain) const { return sessions_.count(domain) != 0; }
+    // Every message the car sent, before link loss
+    const std::vector<std::vector<uint8_t>>& get_sent_messages() const { return sent_messages_; }
+    uint32_t get_requests(uint32_t domain) const;
+    uint32_t get_replayed_responses() const { return replayed_responses_; }
+    uint32_t get_generated_responses() const { return generated_responses_; }
+    uint32_t get_signed_responses() const { return signed_responses_; }
+    uint32_t get_faults() const { return faults_; }
+    // Chunks written to the Tesla characteristic, and those of them lost
+    uint32_t get_writes() const { return writes_; }
+    uint32_t get_writes_lost() const { return writes_lost_; }
+    uint32_t get_notifications_sent() const { return notifications_sent_; }
+    uint32_t get_notifications_lost() const { return notifications_lost_; }
+    // Writes to the Tesla service that arrived while discovery was running
+    uint32_t get_writes_during_discovery() const { return writes_during_discovery_; }
+    // Writes to handles the car does not have
+    uint32_t get_stray_writes() const { return stray_writes_; }
+    // Connection interval granted to the last parameter request, 1.25 ms units
+    uint16_t get_conn_interval() const { return conn_interval_; }
+    size_t get_largest_response() const { return largest_response_; }
+
+private:
+    static constexpr uint32_t SLEEP_STATUS_AWAKE = 1;
+    static constexpr uint32_t SLEEP_STATUS_ASLEEP = 2;
+
+    struct Exchange {
+        std::vector<std::vector<uint8_t>> responses;
+    };
+
+    // One per domain; a handshake with another key replaces the client
+    struct Session {
+        std::vector<uint8_t> epoch;
+        uint32_t clock_start{0};   // seconds, time_ms() based
+        uint32_t counter{0};       // highest request counter accepted
+        std::vector<uint8_t> client_public_key;
+        std::vector<uint8_t> key;
+    };
+
+    esphome::ble_client::BLEClient* client_;
+    LinkConfig link_;
+    FakeVehicleStatus status_;
+    std::mt19937 random_{1};
+    P256Key key_;
+    std::string vin_{"5YJ3E1EA7JF000001"};
+    std::map<uint32_t, Session> sessions_;
+    uint32_t sleep_timeout_ms_{0};
+    uint32_t last_activity_{0};
+    bool waking_{false};
+    uint32_t wake_at_{0};
+
+    // Events by due time; equal times keep their order
+    std::multimap<uint32_t, std::function<void()>> events_;
+    bool link_up_{false};
+    bool discovering_{false};
+    uint16_t read_handle_{READ_HANDLE};
+    uint16_t cccd_handle_{CCCD_HANDLE};
+    uint16_t write_handle_{WRITE_HANDLE};
+    MessageAssembler requests_in_;
+    uint32_t last_write_{0};
+    std::vector<uint8_t> routing_address_;
+    std::map<uint32_t, std::vector<Exchange>> captured_;
+    std::map<uint32_t, size_t> next_exchange_;
+    std::map<uint32_t, uint32_t> requests_;
+
+    uint32_t replayed_responses_{0};
+    uint32_t generated_responses_{0};
+    uint32_t signed_responses_{0};
+    uint32_t faults_{0};
+    uint32_t writes_{0};
+    uint32_t writes_lost_{0};
+    uint32_t notifications_sent_{0};
+    uint32_t notifications_lost_{0};
+    uint32_t writes_during_discovery_{0};
+    uint32_t stray_writes_{0};
+    uint16_t conn_interval_{0};
+    size_t largest_response_{0};
+    std::vector<std::vector<uint8_t>> sent_messages_;
+
+    void schedule(uint32_t delay_ms, std::function<void()> event);
+    void deliver(esp_gattc_cb_event_t event, esp_ble_gattc_cb_param_t& param);
+    void close_link();
+    void publish_gatt_table();
+    esp_err_t on_write(uint16_t handle, const std::vector<uint8_t>& data);
+    void receive(const std::vector<uint8_t>& data);
+    void on_request(const std::vector<uint8_t>& message);
+    void on_session_info_request(uint32_t domain, const std::vector<uint8_t>& message, const std::vector<uint8_t>& uuid);
+    void on_signed_request(uint32_t domain, const std::vector<uint8_t>& message, const std::vector<uint8_t>& uuid);
+    // What a signed request asks of the car, and the plaintext it answers with
+    std::vector<uint8_t> execute(uint32_t domain, const std::vector<uint8_t>& plaintext);
+    void update_sleep();
+    void send(const std::vector<uint8_t>& message);
+    void send_fault(uint32_t domain, uint32_t fault, const std::vector<uint8_t>& request_uuid);
+    std::vector<uint8_t> response_header(uint32_t domain) const;
+    std::vector<uint8_t> vehicle_status_message(const std::vector<uint8_t>& request_uuid) const;
+};
+
+// ==========================================================================
+// Main loop
+// ==========================================================================
+/**
+ * @brief Runs the component as ESPHome's main loop would
+ *
+ * Every step delivers the car's due events, lets the protocol task finish
+ * what it was handed, calls loop() and, once per update interval, update(),
+ * then advances the clock.
+ */
+class LoopDriver {
+public:
+    LoopDriver(esphome::tesla_ble_vehicle::TeslaBLEVehicle* vehicle, FakeVehicle* car, uint32_t step_ms = 10)
+        : vehicle_(vehicle), car_(car), step_ms_(step_ms) {}
+
+    void run_for(uint32_t duration_ms);
+    // Runs until done() or the timeout; returns done()
+    bool run_until(const std::function<bool()>& done, uint32_t timeout_ms);
+
+private:
+    esphome::tesla_ble_vehicle::TeslaBLEVehicle* vehicle_;
+    FakeVehicle* car_;
+    uint32_t step_ms_;
+    uint32_t last_update_{0};
+
+    void step();
+};
+
+} // namespace host
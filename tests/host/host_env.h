@@ -0,0 +1,92 @@
+#pragma once
+
+#include <esp_gap_ble_api.h>
+#include <esp_gatt_defs.h>
+#include <esp_err.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Test-side control of the ESPHome / ESP-IDF shims
+ *
+ * Time only moves when a test advances it, NVS lives in memory, and GATT
+ * writes go to a hook (the fake vehicle) or are recorded. Every test runs
+ * in its own process, so nothing here needs resetting between tests.
+ */
+namespace host {
+
+// ==========================================================================
+// Clock (millis() / micros())
+// ==========================================================================
+uint32_t time_ms();
+void advance_time_ms(uint32_t ms);
+void advance_time_us(uint32_t us);
+
+// ==========================================================================
+// Logging
+// ==========================================================================
+// Lines at or below this level go to stderr; default WARN, or the
+// HOST_LOG_LEVEL environment variable (0-7)
+void set_log_level(int level);
+// Every line is kept regardless of the level
+bool log_contains(const std::string& text);
+// Called with every line regardless of the level
+void set_log_hook(std::function<void(const std::string&)> hook);
+void clear_log();
+
+// Seeds random_uint32(), so reconnect jitter repeats
+void set_random_seed(uint32_t seed);
+
+// ==========================================================================
+// NVS
+// ==========================================================================
+// Result of the next nvs_flash_init() (e.g. ESP_ERR_NVS_NO_FREE_PAGES)
+void nvs_set_init_result(esp_err_t result);
+// Result of the next nvs_commit(); a failed commit drops the writes staged
+// on that handle, as a lost flash write would
+void nvs_set_commit_result(esp_err_t result);
+bool nvs_has_key(const std::string& ns, const std::string& key);
+std::vector<uint8_t> nvs_get(const std::string& ns, const std::string& key);
+void nvs_put(const std::string& ns, const std::string& key, const std::vector<uint8_t>& blob);
+uint32_t nvs_commit_count();
+
+// ==========================================================================
+// GATT client
+// ==========================================================================
+struct GattcWrite {
+    uint16_t conn_id;
+    uint16_t handle;
+    std::vector<uint8_t> data;
+    esp_gatt_write_type_t write_type;
+};
+
+// Decides the result of esp_ble_gattc_write_char(); without one every
+// write succeeds and is kept in gattc_writes()
+void set_gattc_write_hook(std::function<esp_err_t(const GattcWrite&)> hook);
+const std::vector<GattcWrite>& gattc_writes();
+void clear_gattc_writes();
+// Called by esp_ble_gattc_register_for_notify(); the answer arrives as an
+// ESP_GATTC_REG_FOR_NOTIFY_EVT, which the hook is expected to schedule
+void set_register_for_notify_hook(std::function<esp_err_t(uint16_t handle)> hook);
+uint32_t register_for_notify_count();
+const std::vector<GattcWrite>& gattc_descriptor_writes();
+
+// GAP requests (connection parameters, RSSI, data length) made so far
+uint32_t gap_request_count();
+// Called by esp_ble_gap_update_conn_params(); the outcome arrives as an
+// ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT, which the hook is expected to schedule
+void set_conn_params_hook(std::function<esp_err_t(const esp_ble_conn_update_params_t&)> hook);
+// Called by esp_ble_gap_read_rssi(); the hook schedules the
+// ESP_GAP_BLE_READ_RSSI_COMPLETE_EVT
+void set_read_rssi_hook(std::function<esp_err_t()> hook);
+
+// ==========================================================================
+// FreeRTOS
+// ==========================================================================
+// Blocks until every item sent to a queue has been received and its task
+// has come back for the next one, i.e. the protocol task is idle
+void wait_for_tasks_idle();
+
+} // namespace host
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Minimal test registry for the host tests
+ *
+ * TEST(name) registers a test; EXPECT_* record a failure and carry on,
+ * ASSERT_* end the test. test_main.cpp runs every test in its own process.
+ */
+namespace host_test {
+
+using TestFn = void (*)();
+
+struct Registrar {
+    Registrar(const char* name, TestFn fn);
+};
+
+struct AssertionFailed {};
+
+void report_failure(const char* file, int line, const std::string& message);
+
+template<typename T> std::string to_text(const T& value) {
+    std::ostringstream out;
+    if constexpr (std::is_enum_v<T> || (std::is_integral_v<T> && sizeof(T) == 1 && !std::is_same_v<T, bool>)) {
+        out << static_cast<long long>(value);
+    } else {
+        out << value;
+    }
+    return out.str();
+}
+
+inline std::string to_text(const std::vector<uint8_t>& value) {
+    std::ostringstream out;
+    out << std::hex;
+    for (uint8_t byte : value) out << (byte < 0x10 ? "0" : "") << static_cast<int>(byte);
+    return out.str();
+}
+
+template<typename A, typename B> std::string describe(const char* a_expr, const char* b_expr, const A& a, const B& b) {
+    return std::string(a_expr) + " == " + b_expr + " (" + to_text(a) + " vs " + to_text(b) + ")";
+}
+
+} // namespace host_test
+
+#define TEST(name)                                                    \
+    static void name();                                               \
+    static host_test::Registrar name##_registrar(#name, name);        \
+    static void name()
+
+#define EXPECT_TRUE(cond)                                                             \
+    do {                                                                              \
+        if (!(cond)) host_test::report_failure(__FILE__, __LINE__, "expected " #cond); \
+    } while (0)
+#define EXPECT_FALSE(cond) EXPECT_TRUE(!(cond))
+#define EXPECT_EQ(a, b)                                                                            \
+    do {                                                                                           \
+        const auto& a_ = (a);                                                                      \
+        const auto& b_ = (b);                                                                      \
+        if (!(a_ == b_)) host_test::report_failure(__FILE__, __LINE__, host_test::describe(#a, #b, a_, b_)); \
+    } while (0)
+#define EXPECT_NEAR(a, b, tolerance) EXPECT_TRUE(std::fabs((a) - (b)) <= (tolerance))
+
+#define ASSERT_TRUE(cond)                                                              \
+    do {                                                                               \
+        if (!(cond)) {                                                                 \
+            host_test::report_failure(__FILE__, __LINE__, "expected " #cond);          \
+            throw host_test::AssertionFailed();                                        \
+        }                                                                              \
+    } while (0)
@@ -0,0 +1,182 @@
+#include "session_crypto.h"
+#include <openssl/core_names.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/params.h>
+#include <openssl/sha.h>
+#include <cstdio>
+#include <cstdlib>
+
+namespace host {
+
+static const uint32_t DOMAIN_VCSEC = 2;
+static const size_t VCSEC_REQUEST_HASH_SIZE = 17;
+
+P256Key::P256Key() : key_(EVP_PKEY_Q_keygen(nullptr, nullptr, "EC", "P-256")) {
+    // Nothing in the fake car works without it
+    if (key_ == nullptr) {
+        fprintf(stderr, "P256Key: key generation failed\n");
+        abort();
+    }
+}
+
+P256Key::~P256Key() { EVP_PKEY_free(key_); }
+
+std::vector<uint8_t> P256Key::public_key() const {
+    std::vector<uint8_t> point(65);
+    size_t len = 0;
+    if (EVP_PKEY_get_octet_string_param(key_, OSSL_PKEY_PARAM_ENCODED_PUBLIC_KEY, point.data(), point.size(),
+                                        &len) != 1) {
+        return {};
+    }
+    point.resize(len);
+    return point;
+}
+
+std::vector<uint8_t> P256Key::session_key(const std::vector<uint8_t>& peer_public_key) const {
+    if (peer_public_key.empty()) return {};
+    char group[] = "P-256";
+    std::vector<uint8_t> point = peer_public_key;
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_utf8_string(OSSL_PKEY_PARAM_GROUP_NAME, group, 0),
+        OSSL_PARAM_construct_octet_string(OSSL_PKEY_PARAM_PUB_KEY, point.data(), point.size()),
+        OSSL_PARAM_construct_end(),
+    };
+    EVP_PKEY* peer = nullptr;
+    EVP_PKEY_CTX* from_data = EVP_PKEY_CTX_new_from_name(nullptr, "EC", nullptr);
+    const bool have_peer = from_data != nullptr && EVP_PKEY_fromdata_init(from_data) == 1 &&
+                           EVP_PKEY_fromdata(from_data, &peer, EVP_PKEY_PUBLIC_KEY, params) == 1;
+    EVP_PKEY_CTX_free(from_data);
+    if (!have_peer) return {};
+
+    std::vector<uint8_t> shared(32);
+    size_t shared_len = shared.size();
+    EVP_PKEY_CTX* derive = EVP_PKEY_CTX_new(key_, nullptr);
+    const bool derived = derive != nullptr && EVP_PKEY_derive_init(derive) == 1 &&
+                         EVP_PKEY_derive_set_peer(derive, peer) == 1 &&
+                         EVP_PKEY_derive(derive, shared.data(), &shared_len) == 1;
+    EVP_PKEY_CTX_free(derive);
+    EVP_PKEY_free(peer);
+    if (!derived) return {};
+
+    uint8_t digest[SHA_DIGEST_LENGTH];
+    SHA1(shared.data(), shared_len, digest);
+    return std::vector<uint8_t>(digest, digest + SESSION_KEY_SIZE);
+}
+
+std::vector<uint8_t> sha256(const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> digest(SHA256_DIGEST_LENGTH);
+    SHA256(data.data(), data.size(), digest.data());
+    return digest;
+}
+
+std::vector<uint8_t> hmac_sha256(const std::vector<uint8_t>& key, const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> mac(SHA256_DIGEST_LENGTH);
+    unsigned int len = 0;
+    HMAC(EVP_sha256(), key.data(), static_cast<int>(key.size()), data.data(), data.size(), mac.data(), &len);
+    mac.resize(len);
+    return mac;
+}
+
+static bool aes_gcm(bool encrypt, const std::vector<uint8_t>& key, const std::vector<uint8_t>& nonce,
+                    const std::vector<uint8_t>& aad, const std::vector<uint8_t>& in, std::vector<uint8_t>& out,
+                    std::vector<uint8_t>& tag) {
+    if (key.size() != SESSION_KEY_SIZE || nonce.size() != GCM_NONCE_SIZE) return false;
+    if (!encrypt && tag.size() != GCM_TAG_SIZE) return false;
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    if (ctx == nullptr) return false;
+    out.resize(in.size());
+    int len = 0;
+    bool ok = EVP_CipherInit_ex(ctx, EVP_aes_128_gcm(), nullptr, key.data(), nonce.data(), encrypt ? 1 : 0) == 1 &&
+              EVP_CipherUpdate(ctx, nullptr, &len, aad.data(), static_cast<int>(aad.size())) == 1 &&
+              EVP_CipherUpdate(ctx, out.data(), &len, in.data(), static_cast<int>(in.size())) == 1;
+    if (ok && !encrypt) {
+        ok = EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, static_cast<int>(tag.size()), tag.data()) == 1;
+    }
+    // Decryption fails here when the tag does not match
+    ok = ok && EVP_CipherFinal_ex(ctx, out.data() + len, &len) == 1;
+    if (ok && encrypt) {
+        tag.resize(GCM_TAG_SIZE);
+        ok = EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, static_cast<int>(tag.size()), tag.data()) == 1;
+    }
+    EVP_CIPHER_CTX_free(ctx);
+    return ok;
+}
+
+bool aes_gcm_encrypt(const std::vector<uint8_t>& key, const std::vector<uint8_t>& nonce,
+                     const std::vector<uint8_t>& aad, const std::vector<uint8_t>& plaintext,
+                     std::vector<uint8_t>& ciphertext, std::vector<uint8_t>& tag) {
+    return aes_gcm(true, key, nonce, aad, plaintext, ciphertext, tag);
+}
+
+bool aes_gcm_decrypt(const std::vector<uint8_t>& key, const std::vector<uint8_t>& nonce,
+                     const std::vector<uint8_t>& aad, const std::vector<uint8_t>& ciphertext,
+                     const std::vector<uint8_t>& tag, std::vector<uint8_t>& plaintext) {
+    std::vector<uint8_t> expected_tag = tag;
+    return aes_gcm(false, key, nonce, aad, ciphertext, plaintext, expected_tag);
+}
+
+void SignatureMetadata::add(uint8_t tag, const std::vector<uint8_t>& value) {
+    buffer_.push_back(tag);
+    buffer_.push_back(static_cast<uint8_t>(value.size()));
+    buffer_.insert(buffer_.end(), value.begin(), value.end());
+}
+
+void SignatureMetadata::add_u32(uint8_t tag, uint32_t value) {
+    add(tag, std::vector<uint8_t>{static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16),
+                                  static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)});
+}
+
+std::vector<uint8_t> SignatureMetadata::serialize(const std::vector<uint8_t>& message) const {
+    std::vector<uint8_t> out = buffer_;
+    out.push_back(TAG_END);
+    out.insert(out.end(), message.begin(), message.end());
+    return out;
+}
+
+std::vector<uint8_t> session_info_tag(const std::vector<uint8_t>& session_key, const std::string& vin,
+                                      const std::vector<uint8_t>& challenge, const std::vector<uint8_t>& session_info) {
+    static const std::string LABEL = "session info";
+    const auto key = hmac_sha256(session_key, std::vector<uint8_t>(LABEL.begin(), LABEL.end()));
+    SignatureMetadata metadata;
+    metadata.add_u8(TAG_SIGNATURE_TYPE, SIGNATURE_TYPE_HMAC);
+    metadata.add(TAG_PERSONALIZATION, vin);
+    metadata.add(TAG_CHALLENGE, challenge);
+    return hmac_sha256(key, metadata.serialize(session_info));
+}
+
+std::vector<uint8_t> request_aad(uint32_t domain, const std::string& vin, const std::vector<uint8_t>& epoch,
+                                 uint32_t expires_at, uint32_t counter, uint32_t flags) {
+    SignatureMetadata metadata;
+    metadata.add_u8(TAG_SIGNATURE_TYPE, SIGNATURE_TYPE_AES_GCM_PERSONALIZED);
+    metadata.add_u8(TAG_DOMAIN, static_cast<uint8_t>(domain));
+    metadata.add(TAG_PERSONALIZATION, vin);
+    metadata.add(TAG_EPOCH, epoch);
+    metadata.add_u32(TAG_EXPIRES_AT, expires_at);
+    metadata.add_u32(TAG_COUNTER, counter);
+    // Only signed when set, so older vehicles verify flag-less requests
+    if (flags != 0) metadata.add_u32(TAG_FLAGS, flags);
+    return sha256(metadata.serialize());
+}
+
+std::vector<uint8_t> request_hash(uint32_t domain, const std::vector<uint8_t>& request_tag) {
+    std::vector<uint8_t> hash = {SIGNATURE_TYPE_AES_GCM_PERSONALIZED};
+    hash.insert(hash.end(), request_tag.begin(), request_tag.end());
+    if (domain == DOMAIN_VCSEC && hash.size() > VCSEC_REQUEST_HASH_SIZE) hash.resize(VCSEC_REQUEST_HASH_SIZE);
+    return hash;
+}
+
+std::vector<uint8_t> response_aad(uint32_t domain, const std::string& vin, uint32_t counter, uint32_t flags,
+                                  const std::vector<uint8_t>& request_hash, uint32_t fault) {
+    SignatureMetadata metadata;
+    metadata.add_u8(TAG_SIGNATURE_TYPE, SIGNATURE_TYPE_AES_GCM_RESPONSE);
+    metadata.add_u8(TAG_DOMAIN, static_cast<uint8_t>(domain));
+    metadata.add(TAG_PERSONALIZATION, vin);
+    metadata.add_u32(TAG_COUNTER, counter);
+    metadata.add_u32(TAG_FLAGS, flags);
+    metadata.add(TAG_REQUEST_HASH, request_hash);
+    metadata.add_u32(TAG_FAULT, fault);
+    return sha256(metadata.serialize());
+}
+
+} // namespace host
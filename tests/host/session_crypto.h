@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct evp_pkey_st;
+
+/**
+ * @brief The vehicle end of the Tesla session protocol, on OpenSSL
+ *
+ * Key agreement and the byte strings each signature covers, as
+ * signatures.proto and universal_message.proto describe them: the session
+ * key is the first 16 bytes of SHA-1 over the ECDH shared secret, session
+ * info is HMAC-SHA256 tagged, and requests and responses are AES-128-GCM
+ * with the SHA-256 of their metadata as associated data. The fake car signs
+ * with these; tests use the same helpers for the client end, so they check
+ * that the car is consistent, not that it matches a real one.
+ */
+namespace host {
+
+// SignatureType (signatures.proto)
+static constexpr uint8_t SIGNATURE_TYPE_AES_GCM_PERSONALIZED = 5;
+static constexpr uint8_t SIGNATURE_TYPE_HMAC = 6;
+static constexpr uint8_t SIGNATURE_TYPE_AES_GCM_RESPONSE = 9;
+
+// Tag (signatures.proto)
+static constexpr uint8_t TAG_SIGNATURE_TYPE = 0;
+static constexpr uint8_t TAG_DOMAIN = 1;
+static constexpr uint8_t TAG_PERSONALIZATION = 2;
+static constexpr uint8_t TAG_EPOCH = 3;
+static constexpr uint8_t TAG_EXPIRES_AT = 4;
+static constexpr uint8_t TAG_COUNTER = 5;
+static constexpr uint8_t TAG_CHALLENGE = 6;
+static constexpr uint8_t TAG_FLAGS = 7;
+static constexpr uint8_t TAG_REQUEST_HASH = 8;
+static constexpr uint8_t TAG_FAULT = 9;
+static constexpr uint8_t TAG_END = 255;
+
+static constexpr size_t SESSION_KEY_SIZE = 16;
+static constexpr size_t GCM_NONCE_SIZE = 12;
+static constexpr size_t GCM_TAG_SIZE = 16;
+
+// An EC P-256 key pair, generated on construction
+class P256Key {
+public:
+    P256Key();
+    ~P256Key();
+    P256Key(const P256Key&) = delete;
+    P256Key& operator=(const P256Key&) = delete;
+
+    // Uncompressed point, 65 bytes
+    std::vector<uint8_t> public_key() const;
+    // Empty when peer_public_key is not a P-256 point
+    std::vector<uint8_t> session_key(const std::vector<uint8_t>& peer_public_key) const;
+
+private:
+    evp_pkey_st* key_;
+};
+
+std::vector<uint8_t> sha256(const std::vector<uint8_t>& data);
+std::vector<uint8_t> hmac_sha256(const std::vector<uint8_t>& key, const std::vector<uint8_t>& data);
+bool aes_gcm_encrypt(const std::vector<uint8_t>& key, const std::vector<uint8_t>& nonce,
+                     const std::vector<uint8_t>& aad, const std::vector<uint8_t>& plaintext,
+                     std::vector<uint8_t>& ciphertext, std::vector<uint8_t>& tag);
+bool aes_gcm_decrypt(const std::vector<uint8_t>& key, const std::vector<uint8_t>& nonce,
+                     const std::vector<uint8_t>& aad, const std::vector<uint8_t>& ciphertext,
+                     const std::vector<uint8_t>& tag, std::vector<uint8_t>& plaintext);
+
+// Tag, length, value entries in ascending tag order; a signature covers
+// them, TAG_END and then the message
+class SignatureMetadata {
+public:
+    void add(uint8_t tag, const std::vector<uint8_t>& value);
+    void add(uint8_t tag, const std::string& value) { add(tag, std::vector<uint8_t>(value.begin(), value.end())); }
+    void add_u8(uint8_t tag, uint8_t value) { add(tag, std::vector<uint8_t>{value}); }
+    // Big-endian
+    void add_u32(uint8_t tag, uint32_t value);
+
+    std::vector<uint8_t> serialize(const std::vector<uint8_t>& message = {}) const;
+
+private:
+    std::vector<uint8_t> buffer_;
+};
+
+std::vector<uint8_t> session_info_tag(const std::vector<uint8_t>& session_key, const std::string& vin,
+                                      const std::vector<uint8_t>& challenge, const std::vector<uint8_t>& session_info);
+// Associated data of a client's AES_GCM_Personalized request
+std::vector<uint8_t> request_aad(uint32_t domain, const std::string& vin, const std::vector<uint8_t>& epoch,
+                                 uint32_t expires_at, uint32_t counter, uint32_t flags);
+// What a response names its request by: the signature type and the
+// request's GCM tag, cut to 17 bytes for VCSEC
+std::vector<uint8_t> request_hash(uint32_t domain, const std::vector<uint8_t>& request_tag);
+// Associated data of the vehicle's AES_GCM_Response
+std::vector<uint8_t> response_aad(uint32_t domain, const std::string& vin, uint32_t counter, uint32_t flags,
+                                  const std::vector<uint8_t>& request_hash, uint32_t fault);
+
+} // namespace host
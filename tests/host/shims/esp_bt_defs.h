@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+
+#define ESP_BD_ADDR_LEN 6
+typedef uint8_t esp_bd_addr_t[ESP_BD_ADDR_LEN];
+
+typedef enum {
+    ESP_BT_STATUS_SUCCESS = 0,
+    ESP_BT_STATUS_FAIL = 1,
+} esp_bt_status_t;
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstdint>
+
+// Real time (steady clock) so loop-time measurements mean something on the
+// host, at the rate esp_rom_get_cpu_ticks_per_us() reports
+uint32_t esp_cpu_get_cycle_count();
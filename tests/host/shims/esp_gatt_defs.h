@@ -0,0 +1,21 @@
+#pragma once
+
+#include "esp_bt_defs.h"
+#include <cstdint>
+
+typedef uint8_t esp_gatt_if_t;
+
+typedef enum {
+    ESP_GATT_OK = 0x0,
+    ESP_GATT_INVALID_HANDLE = 0x01,
+    ESP_GATT_ERROR = 0x85,
+} esp_gatt_status_t;
+
+typedef enum {
+    ESP_GATT_WRITE_TYPE_NO_RSP = 1,
+    ESP_GATT_WRITE_TYPE_RSP = 2,
+} esp_gatt_write_type_t;
+
+typedef enum {
+    ESP_GATT_AUTH_REQ_NONE = 0,
+} esp_gatt_auth_req_t;
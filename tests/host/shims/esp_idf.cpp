@@ -0,0 +1,403 @@
+#include "host_env.h"
+#include <esp_cpu.h>
+#include <esp_err.h>
+#include <esp_gap_ble_api.h>
+#include <esp_gattc_api.h>
+#include <esp_rom_sys.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <nvs.h>
+#include <nvs_flash.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_NVS_NOT_FOUND: return "ESP_ERR_NVS_NOT_FOUND";
+        case ESP_ERR_NVS_KEY_TOO_LONG: return "ESP_ERR_NVS_KEY_TOO_LONG";
+        case ESP_ERR_NVS_NO_FREE_PAGES: return "ESP_ERR_NVS_NO_FREE_PAGES";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+void host_esp_error_check_failed(esp_err_t rc, const char* file, int line, const char* expression) {
+    fprintf(stderr, "ESP_ERROR_CHECK failed: %s (%s) at %s:%d\n", esp_err_to_name(rc), expression, file, line);
+    abort();
+}
+
+// =============================================================================
+// CPU cycle counter and timer
+// =============================================================================
+
+static const uint32_t HOST_TICKS_PER_US = 240;
+
+uint32_t esp_cpu_get_cycle_count() {
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return static_cast<uint32_t>(static_cast<uint64_t>(ns) * HOST_TICKS_PER_US / 1000);
+}
+
+uint32_t esp_rom_get_cpu_ticks_per_us() { return HOST_TICKS_PER_US; }
+
+int64_t esp_timer_get_time() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// =============================================================================
+// NVS
+// =============================================================================
+
+static const size_t NVS_KEY_NAME_MAX_SIZE = 16;
+
+namespace {
+
+struct NvsEntry {
+    std::vector<uint8_t> data;
+    bool is_u8;
+};
+
+} // namespace
+
+// Committed entries by namespace; writes are staged per handle until
+// nvs_commit()
+static std::map<std::string, std::map<std::string, NvsEntry>> nvs_store;
+static std::map<nvs_handle_t, std::map<std::string, NvsEntry>> nvs_staged;
+static std::map<nvs_handle_t, std::string> nvs_handles;
+static nvs_handle_t next_nvs_handle = 1;
+static esp_err_t nvs_init_result = ESP_OK;
+static esp_err_t nvs_commit_result = ESP_OK;
+static uint32_t nvs_commits = 0;
+
+static NvsEntry* nvs_find(nvs_handle_t handle, const char* key) {
+    auto ns = nvs_handles.find(handle);
+    if (ns == nvs_handles.end()) return nullptr;
+    auto staged = nvs_staged[handle].find(key);
+    if (staged != nvs_staged[handle].end()) return &staged->second;
+    auto& entries = nvs_store[ns->second];
+    auto it = entries.find(key);
+    return it != entries.end() ? &it->second : nullptr;
+}
+
+static esp_err_t nvs_store_entry(nvs_handle_t handle, const char* key, NvsEntry entry) {
+    auto ns = nvs_handles.find(handle);
+    if (ns == nvs_handles.end()) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (strlen(key) >= NVS_KEY_NAME_MAX_SIZE) return ESP_ERR_NVS_KEY_TOO_LONG;
+    nvs_staged[handle][key] = std::move(entry);
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_init() {
+    const esp_err_t result = nvs_init_result;
+    nvs_init_result = ESP_OK;
+    return result;
+}
+
+esp_err_t nvs_flash_erase() {
+    nvs_store.clear();
+    nvs_staged.clear();
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char* namespace_name, nvs_open_mode_t open_mode, nvs_handle_t* out_handle) {
+    (void) open_mode;
+    if (strlen(namespace_name) >= NVS_KEY_NAME_MAX_SIZE) return ESP_ERR_NVS_KEY_TOO_LONG;
+    *out_handle = next_nvs_handle++;
+    nvs_handles[*out_handle] = namespace_name;
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle) {
+    nvs_handles.erase(handle);
+    nvs_staged.erase(handle);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* out_value, size_t* length) {
+    if (nvs_handles.count(handle) == 0) return ESP_ERR_NVS_INVALID_HANDLE;
+    NvsEntry* entry = nvs_find(handle, key);
+    if (entry == nullptr || entry->is_u8) return ESP_ERR_NVS_NOT_FOUND;
+    if (out_value == nullptr) {
+        *length = entry->data.size();
+        return ESP_OK;
+    }
+    if (*length < entry->data.size()) return ESP_ERR_NVS_INVALID_LENGTH;
+    memcpy(out_value, entry->data.data(), entry->data.size());
+    *length = entry->data.size();
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* key, const void* value, size_t length) {
+    const auto* bytes = static_cast<const uint8_t*>(value);
+    return nvs_store_entry(handle, key, {std::vector<uint8_t>(bytes, bytes + length), false});
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char* key, uint8_t* out_value) {
+    if (nvs_handles.count(handle) == 0) return ESP_ERR_NVS_INVALID_HANDLE;
+    NvsEntry* entry = nvs_find(handle, key);
+    if (entry == nullptr || !entry->is_u8) return ESP_ERR_NVS_NOT_FOUND;
+    *out_value = entry->data[0];
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char* key, uint8_t value) {
+    return nvs_store_entry(handle, key, {{value}, true});
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char* key) {
+    auto ns = nvs_handles.find(handle);
+    if (ns == nvs_handles.end()) return ESP_ERR_NVS_INVALID_HANDLE;
+    const bool staged = nvs_staged[handle].erase(key) != 0;
+    const bool stored = nvs_store[ns->second].erase(key) != 0;
+    return staged || stored ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    auto ns = nvs_handles.find(handle);
+    if (ns == nvs_handles.end()) return ESP_ERR_NVS_INVALID_HANDLE;
+    auto& staged = nvs_staged[handle];
+    const esp_err_t result = nvs_commit_result;
+    nvs_commit_result = ESP_OK;
+    if (result != ESP_OK) {
+        // What was staged on this handle never reaches flash
+        staged.clear();
+        return result;
+    }
+    for (auto& entry : staged) nvs_store[ns->second][entry.first] = std::move(entry.second);
+    staged.clear();
+    nvs_commits++;
+    return ESP_OK;
+}
+
+namespace host {
+
+void nvs_set_init_result(esp_err_t result) { nvs_init_result = result; }
+void nvs_set_commit_result(esp_err_t result) { nvs_commit_result = result; }
+
+bool nvs_has_key(const std::string& ns, const std::string& key) {
+    auto it = nvs_store.find(ns);
+    return it != nvs_store.end() && it->second.count(key) != 0;
+}
+
+std::vector<uint8_t> nvs_get(const std::string& ns, const std::string& key) {
+    return nvs_has_key(ns, key) ? nvs_store[ns][key].data : std::vector<uint8_t>{};
+}
+
+void nvs_put(const std::string& ns, const std::string& key, const std::vector<uint8_t>& blob) {
+    nvs_store[ns][key] = {blob, false};
+}
+
+uint32_t nvs_commit_count() { return nvs_commits; }
+
+} // namespace host
+
+// =============================================================================
+// GATT client / GAP
+// =============================================================================
+
+static std::function<esp_err_t(const host::GattcWrite&)> gattc_write_hook;
+static std::vector<host::GattcWrite> gattc_write_log;
+static std::vector<host::GattcWrite> gattc_descriptor_log;
+static std::function<esp_err_t(uint16_t)> register_for_notify_hook;
+static uint32_t register_for_notify_calls = 0;
+static uint32_t gap_requests = 0;
+static std::function<esp_err_t(const esp_ble_conn_update_params_t&)> conn_params_hook;
+static std::function<esp_err_t()> read_rssi_hook;
+
+esp_err_t esp_ble_gattc_write_char(esp_gatt_if_t gattc_if, uint16_t conn_id, uint16_t handle, uint16_t value_len,
+                                   uint8_t* value, esp_gatt_write_type_t write_type, esp_gatt_auth_req_t auth_req) {
+    (void) gattc_if;
+    (void) auth_req;
+    host::GattcWrite write{conn_id, handle, std::vector<uint8_t>(value, value + value_len), write_type};
+    if (gattc_write_hook) return gattc_write_hook(write);
+    gattc_write_log.push_back(std::move(write));
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gattc_write_char_descr(esp_gatt_if_t gattc_if, uint16_t conn_id, uint16_t handle,
+                                         uint16_t value_len, uint8_t* value, esp_gatt_write_type_t write_type,
+                                         esp_gatt_auth_req_t auth_req) {
+    (void) gattc_if;
+    (void) auth_req;
+    gattc_descriptor_log.push_back({conn_id, handle, std::vector<uint8_t>(value, value + value_len), write_type});
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gattc_register_for_notify(esp_gatt_if_t gattc_if, esp_bd_addr_t server_bda, uint16_t handle) {
+    (void) gattc_if;
+    (void) server_bda;
+    register_for_notify_calls++;
+    return register_for_notify_hook ? register_for_notify_hook(handle) : ESP_OK;
+}
+
+esp_err_t esp_ble_gap_update_conn_params(esp_ble_conn_update_params_t* params) {
+    gap_requests++;
+    return conn_params_hook ? conn_params_hook(*params) : ESP_OK;
+}
+
+esp_err_t esp_ble_gap_set_pkt_data_len(esp_bd_addr_t remote_device, uint16_t tx_data_length) {
+    (void) remote_device;
+    (void) tx_data_length;
+    gap_requests++;
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_read_rssi(esp_bd_addr_t remote_addr) {
+    (void) remote_addr;
+    gap_requests++;
+    return read_rssi_hook ? read_rssi_hook() : ESP_OK;
+}
+
+namespace host {
+
+void set_gattc_write_hook(std::function<esp_err_t(const GattcWrite&)> hook) { gattc_write_hook = std::move(hook); }
+const std::vector<GattcWrite>& gattc_writes() { return gattc_write_log; }
+void clear_gattc_writes() { gattc_write_log.clear(); }
+void set_register_for_notify_hook(std::function<esp_err_t(uint16_t handle)> hook) {
+    register_for_notify_hook = std::move(hook);
+}
+uint32_t register_for_notify_count() { return register_for_notify_calls; }
+const std::vector<GattcWrite>& gattc_descriptor_writes() { return gattc_descriptor_log; }
+uint32_t gap_request_count() { return gap_requests; }
+void set_conn_params_hook(std::function<esp_err_t(const esp_ble_conn_update_params_t&)> hook) {
+    conn_params_hook = std::move(hook);
+}
+void set_read_rssi_hook(std::function<esp_err_t()> hook) { read_rssi_hook = std::move(hook); }
+
+} // namespace host
+
+// =============================================================================
+// FreeRTOS: tasks are detached threads, queues copy items by value
+// =============================================================================
+
+struct HostTask {
+    TaskFunction_t task_code;
+    void* parameters;
+};
+
+static thread_local HostTask* current_task = nullptr;
+
+// Items sent to any queue whose receiver has not come back for the next
+// one yet; host::wait_for_tasks_idle() waits for this to reach zero
+static std::mutex idle_mutex;
+static std::condition_variable idle_changed;
+static long items_in_flight = 0;
+static thread_local bool holding_item = false;
+
+static void add_in_flight(long delta) {
+    std::lock_guard<std::mutex> lock(idle_mutex);
+    items_in_flight += delta;
+    if (items_in_flight == 0) idle_changed.notify_all();
+}
+
+static void release_held_item() {
+    if (!holding_item) return;
+    holding_item = false;
+    add_in_flight(-1);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task_code, const char* name, uint32_t stack_depth,
+                                   void* parameters, UBaseType_t priority, TaskHandle_t* created_task,
+                                   BaseType_t core_id) {
+    (void) name;
+    (void) stack_depth;
+    (void) priority;
+    (void) core_id;
+    // Never freed: a task handle may be compared against after the task ended
+    auto* task = new HostTask{task_code, parameters};
+    if (created_task != nullptr) *created_task = task;
+    std::thread([task]() {
+        current_task = task;
+        task->task_code(task->parameters);
+        release_held_item();
+    }).detach();
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) { (void) task; }
+
+void vTaskDelay(TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
+
+TaskHandle_t xTaskGetCurrentTaskHandle() { return current_task; }
+
+BaseType_t xPortGetCoreID() { return current_task == nullptr ? 1 : 0; }
+
+struct HostQueue {
+    size_t length;
+    size_t item_size;
+    std::deque<std::vector<uint8_t>> items;
+    std::mutex mutex;
+    std::condition_variable not_empty;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    auto* queue = new HostQueue();
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    add_in_flight(-static_cast<long>(queue->items.size()));
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait) {
+    (void) ticks_to_wait;  // Only used with 0 by the component
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (queue->items.size() >= queue->length) return pdFALSE;
+    const auto* bytes = static_cast<const uint8_t*>(item);
+    queue->items.emplace_back(bytes, bytes + queue->item_size);
+    add_in_flight(1);
+    queue->not_empty.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* buffer, TickType_t ticks_to_wait) {
+    // Coming back for more means the previous item has been handled
+    release_held_item();
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    auto ready = [queue]() { return !queue->items.empty(); };
+    if (ticks_to_wait == portMAX_DELAY) {
+        queue->not_empty.wait(lock, ready);
+    } else if (!queue->not_empty.wait_for(lock, std::chrono::milliseconds(ticks_to_wait), ready)) {
+        return pdFALSE;
+    }
+    memcpy(buffer, queue->items.front().data(), queue->item_size);
+    queue->items.pop_front();
+    if (current_task != nullptr) {
+        holding_item = true;
+    } else {
+        add_in_flight(-1);  // Main loop draining a queue it owns
+    }
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return static_cast<UBaseType_t>(queue->items.size());
+}
+
+namespace host {
+
+void wait_for_tasks_idle() {
+    std::unique_lock<std::mutex> lock(idle_mutex);
+    idle_changed.wait(lock, []() { return items_in_flight == 0; });
+}
+
+} // namespace host
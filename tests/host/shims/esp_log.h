@@ -0,0 +1,4 @@
+#pragma once
+
+// The component logs through esphome/core/log.h only
+#include <esphome/core/log.h>
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstdint>
+
+// Real time (steady clock) like esp_cpu_get_cycle_count(), so the benchmark
+// times host code rather than the simulated clock
+int64_t esp_timer_get_time();
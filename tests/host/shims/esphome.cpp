@@ -0,0 +1,248 @@
+#include "host_env.h"
+#include <esphome/components/ble_client/ble_client.h>
+#include <esphome/components/cover/cover.h>
+#include <esphome/components/esp32_ble/ble.h>
+#include <esphome/components/esp32_ble_tracker/esp32_ble_tracker.h>
+#include <esphome/core/application.h>
+#include <esphome/core/component.h>
+#include <esphome/core/hal.h>
+#include <esphome/core/helpers.h>
+#include <esphome/core/log.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <random>
+
+// =============================================================================
+// Clock
+// =============================================================================
+
+// Starts past zero: the component treats 0 as "never happened"
+static std::atomic<uint64_t> now_us{1000000};
+
+namespace esphome {
+
+uint32_t millis() { return static_cast<uint32_t>(now_us.load() / 1000); }
+uint32_t micros() { return static_cast<uint32_t>(now_us.load()); }
+void delay(uint32_t ms) { host::advance_time_ms(ms); }
+
+} // namespace esphome
+
+namespace host {
+
+uint32_t time_ms() { return esphome::millis(); }
+void advance_time_ms(uint32_t ms) { now_us += static_cast<uint64_t>(ms) * 1000; }
+void advance_time_us(uint32_t us) { now_us += us; }
+
+} // namespace host
+
+// =============================================================================
+// Logging
+// =============================================================================
+
+static const size_t LOG_HISTORY = 4096;
+
+static std::mutex log_mutex;
+static std::deque<std::string> log_lines;
+
+static int initial_log_level() {
+    const char* env = std::getenv("HOST_LOG_LEVEL");
+    return env != nullptr ? std::atoi(env) : ESPHOME_LOG_LEVEL_WARN;
+}
+static int log_level = initial_log_level();
+static std::function<void(const std::string&)> log_hook;
+
+namespace esphome {
+
+void esp_log_printf_(int level, const char* tag, int line, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    esp_log_vprintf_(level, tag, line, format, args);
+    va_end(args);
+}
+
+void esp_log_vprintf_(int level, const char* tag, int line, const char* format, va_list args) {
+    static const char LEVEL_LETTERS[] = "NEWICDVV";
+    char message[512];
+    vsnprintf(message, sizeof(message), format, args);
+
+    char prefix[96];
+    snprintf(prefix, sizeof(prefix), "[%c][%s:%d]: ", LEVEL_LETTERS[std::min(level, 7)], tag, line);
+    std::string text = std::string(prefix) + message;
+
+    std::lock_guard<std::mutex> lock(log_mutex);
+    if (level <= log_level) fprintf(stderr, "%10u %s\n", millis(), text.c_str());
+    if (log_hook) log_hook(text);
+    log_lines.push_back(std::move(text));
+    if (log_lines.size() > LOG_HISTORY) log_lines.pop_front();
+}
+
+} // namespace esphome
+
+namespace host {
+
+void set_log_level(int level) { log_level = level; }
+
+bool log_contains(const std::string& text) {
+    std::lock_guard<std::mutex> lock(log_mutex);
+    for (const auto& line : log_lines) {
+        if (line.find(text) != std::string::npos) return true;
+    }
+    return false;
+}
+
+void set_log_hook(std::function<void(const std::string&)> hook) {
+    std::lock_guard<std::mutex> lock(log_mutex);
+    log_hook = std::move(hook);
+}
+
+void clear_log() {
+    std::lock_guard<std::mutex> lock(log_mutex);
+    log_lines.clear();
+}
+
+} // namespace host
+
+// =============================================================================
+// Helpers
+// =============================================================================
+
+static std::mt19937 random_engine(1);
+
+namespace host {
+
+void set_random_seed(uint32_t seed) { random_engine.seed(seed); }
+
+} // namespace host
+
+namespace esphome {
+
+Application App;
+
+std::string format_hex(const uint8_t* data, size_t length) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(length * 2);
+    for (size_t i = 0; i < length; i++) {
+        out += HEX_DIGITS[data[i] >> 4];
+        out += HEX_DIGITS[data[i] & 0x0F];
+    }
+    return out;
+}
+
+std::string format_hex(const std::vector<uint8_t>& data) { return format_hex(data.data(), data.size()); }
+
+uint32_t fnv1_hash(const std::string& str) {
+    uint32_t hash = 2166136261UL;
+    for (char c : str) {
+        hash *= 16777619UL;
+        hash ^= static_cast<uint8_t>(c);
+    }
+    return hash;
+}
+
+uint32_t random_uint32() { return random_engine(); }
+
+// =============================================================================
+// Component
+// =============================================================================
+
+void Component::status_set_warning(const char* message) {
+    warning_ = true;
+    warning_message_ = message != nullptr ? message : "";
+}
+
+void Component::status_clear_warning() {
+    warning_ = false;
+    warning_message_.clear();
+}
+
+namespace cover {
+
+const float COVER_OPEN = 1.0f;
+const float COVER_CLOSED = 0.0f;
+
+} // namespace cover
+
+// =============================================================================
+// BLE
+// =============================================================================
+
+namespace esp32_ble_tracker {
+
+static ESP32BLETracker tracker;
+ESP32BLETracker* global_esp32_ble_tracker = &tracker;
+
+ESPBTUUID ESPBTUUID::from_raw(const std::string& data) {
+    ESPBTUUID uuid;
+    uuid.uuid_ = data;
+    std::transform(uuid.uuid_.begin(), uuid.uuid_.end(), uuid.uuid_.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return uuid;
+}
+
+void ESP32BLETracker::report_device(const ESPBTDevice& device) {
+    for (auto* listener : listeners_) listener->parse_device(device);
+}
+
+void ESP32BLETracker::reset() { listeners_.clear(); }
+
+} // namespace esp32_ble_tracker
+
+namespace esp32_ble {
+
+static ESP32BLE ble;
+ESP32BLE* global_ble = &ble;
+
+void ESP32BLE::dispatch_gap_event(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param) {
+    for (auto* handler : gap_event_handlers_) handler->gap_event_handler(event, param);
+}
+
+} // namespace esp32_ble
+
+namespace ble_client {
+
+void BLEClient::set_address(uint64_t address) {
+    address_ = address;
+    // Most significant byte first, as esp_bd_addr_t is stored
+    for (int i = 0; i < 6; i++) {
+        remote_bda_[i] = static_cast<uint8_t>(address >> (8 * (5 - i)));
+    }
+}
+
+void BLEClient::disconnect() {
+    disconnect_requests_++;
+    if (on_disconnect_) on_disconnect_();
+}
+
+void BLEClient::add_characteristic(const espbt::ESPBTUUID& service, const espbt::ESPBTUUID& characteristic,
+                                   uint16_t handle, uint16_t cccd_handle) {
+    characteristics_.push_back(
+        {service, characteristic, handle, {espbt::ESPBTUUID::from_raw("00002902-0000-1000-8000-00805f9b34fb"), cccd_handle}});
+}
+
+BLECharacteristic* BLEClient::get_characteristic(espbt::ESPBTUUID service, espbt::ESPBTUUID characteristic) {
+    for (auto& entry : characteristics_) {
+        if (entry.service_uuid == service && entry.uuid == characteristic) return &entry;
+    }
+    return nullptr;
+}
+
+BLEDescriptor* BLEClient::get_config_descriptor(uint16_t handle) {
+    for (auto& entry : characteristics_) {
+        if (entry.handle == handle && entry.cccd.handle != 0) return &entry.cccd;
+    }
+    return nullptr;
+}
+
+void BLEClient::gattc_event_handler(esp_gattc_cb_event_t event, esp_ble_gattc_cb_param_t* param) {
+    for (auto* node : nodes_) node->gattc_event_handler(event, gattc_if_, param);
+}
+
+} // namespace ble_client
+
+} // namespace esphome
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <esphome/core/entity_base.h>
+
+namespace esphome {
+namespace binary_sensor {
+
+class BinarySensor : public EntityBase {
+public:
+    void publish_state(bool new_state) {
+        state = new_state;
+        count_publish();
+    }
+
+    bool state{false};
+};
+
+} // namespace binary_sensor
+} // namespace esphome
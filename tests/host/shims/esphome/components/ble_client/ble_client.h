@@ -0,0 +1,100 @@
+#pragma once
+
+#include <esphome/components/esp32_ble_tracker/esp32_ble_tracker.h>
+#include <esphome/core/component.h>
+#include <esp_gattc_api.h>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace esphome {
+namespace ble_client {
+
+namespace espbt = esphome::esp32_ble_tracker;
+
+class BLEClient;
+
+struct BLEDescriptor {
+    espbt::ESPBTUUID uuid;
+    uint16_t handle;
+};
+
+struct BLECharacteristic {
+    espbt::ESPBTUUID service_uuid;
+    espbt::ESPBTUUID uuid;
+    uint16_t handle;
+    // Client Characteristic Configuration descriptor; handle 0 if none
+    BLEDescriptor cccd;
+};
+
+class BLEClientNode {
+public:
+    virtual ~BLEClientNode() = default;
+    virtual void gattc_event_handler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_if,
+                                     esp_ble_gattc_cb_param_t *param) = 0;
+
+    BLEClient *parent() { return parent_; }
+    void set_ble_client_parent(BLEClient *parent) { parent_ = parent; }
+
+    espbt::ClientState node_state{espbt::ClientState::INIT};
+
+protected:
+    BLEClient *parent_{nullptr};
+};
+
+/**
+ * Stands in for ESPHome's BLE client: the GATT table and connection state
+ * are set by the test or the fake vehicle, and events are passed to the
+ * registered nodes as the Bluedroid callback would.
+ */
+class BLEClient {
+public:
+    void register_ble_node(BLEClientNode *node) {
+        node->set_ble_client_parent(this);
+        nodes_.push_back(node);
+    }
+
+    esp_gatt_if_t get_gattc_if() const { return gattc_if_; }
+    uint16_t get_conn_id() const { return conn_id_; }
+    void set_conn_id(uint16_t conn_id) { conn_id_ = conn_id; }
+    uint8_t *get_remote_bda() { return remote_bda_; }
+    uint64_t get_address() const { return address_; }
+    void set_address(uint64_t address);
+
+    espbt::ClientState state() const { return state_; }
+    void set_state(espbt::ClientState state) { state_ = state; }
+
+    void set_auto_connect(bool auto_connect) { auto_connect_ = auto_connect; }
+    bool get_auto_connect() const { return auto_connect_; }
+    bool enabled{true};
+
+    // Host: the fake peer decides what a disconnect request leads to
+    void disconnect();
+    void set_on_disconnect(std::function<void()> on_disconnect) { on_disconnect_ = std::move(on_disconnect); }
+    uint32_t get_disconnect_requests() const { return disconnect_requests_; }
+
+    // Host: GATT table reported by service discovery
+    void add_characteristic(const espbt::ESPBTUUID &service, const espbt::ESPBTUUID &characteristic,
+                            uint16_t handle, uint16_t cccd_handle = 0);
+    void clear_characteristics() { characteristics_.clear(); }
+    BLECharacteristic *get_characteristic(espbt::ESPBTUUID service, espbt::ESPBTUUID characteristic);
+    BLEDescriptor *get_config_descriptor(uint16_t handle);
+
+    // Host: deliver a GATTC event to every node
+    void gattc_event_handler(esp_gattc_cb_event_t event, esp_ble_gattc_cb_param_t *param);
+
+protected:
+    std::vector<BLEClientNode *> nodes_;
+    std::vector<BLECharacteristic> characteristics_;
+    std::function<void()> on_disconnect_;
+    espbt::ClientState state_{espbt::ClientState::IDLE};
+    esp_gatt_if_t gattc_if_{3};
+    uint16_t conn_id_{0};
+    uint64_t address_{0};
+    uint8_t remote_bda_[6]{};
+    bool auto_connect_{true};
+    uint32_t disconnect_requests_{0};
+};
+
+} // namespace ble_client
+} // namespace esphome
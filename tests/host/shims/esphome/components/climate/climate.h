@@ -0,0 +1,106 @@
+#pragma once
+
+#include <esphome/core/entity_base.h>
+#include <esphome/core/helpers.h>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace climate {
+
+enum ClimateMode : uint8_t {
+    CLIMATE_MODE_OFF = 0,
+    CLIMATE_MODE_HEAT_COOL = 1,
+    CLIMATE_MODE_COOL = 2,
+    CLIMATE_MODE_HEAT = 3,
+    CLIMATE_MODE_FAN_ONLY = 4,
+    CLIMATE_MODE_DRY = 5,
+    CLIMATE_MODE_AUTO = 6,
+};
+
+enum ClimateFeature : uint32_t {
+    CLIMATE_SUPPORTS_CURRENT_TEMPERATURE = 1 << 0,
+};
+
+class ClimateTraits {
+public:
+    void set_supported_modes(std::initializer_list<ClimateMode> modes) { modes_ = modes; }
+    const std::vector<ClimateMode> &get_supported_modes() const { return modes_; }
+    void add_feature_flags(uint32_t feature_flags) { feature_flags_ |= feature_flags; }
+    bool has_feature_flags(uint32_t feature_flags) const { return (feature_flags_ & feature_flags) == feature_flags; }
+    void set_visual_min_temperature(float min_temperature) { visual_min_temperature_ = min_temperature; }
+    float get_visual_min_temperature() const { return visual_min_temperature_; }
+    void set_visual_max_temperature(float max_temperature) { visual_max_temperature_ = max_temperature; }
+    float get_visual_max_temperature() const { return visual_max_temperature_; }
+    void set_visual_temperature_step(float temperature_step) { visual_temperature_step_ = temperature_step; }
+    float get_visual_temperature_step() const { return visual_temperature_step_; }
+
+protected:
+    std::vector<ClimateMode> modes_;
+    uint32_t feature_flags_{0};
+    float visual_min_temperature_{10.0f};
+    float visual_max_temperature_{30.0f};
+    float visual_temperature_step_{0.1f};
+};
+
+class ClimateCall {
+public:
+    ClimateCall &set_mode(ClimateMode mode) {
+        mode_ = mode;
+        return *this;
+    }
+    ClimateCall &set_custom_preset(const std::string &preset) {
+        custom_preset_ = preset;
+        return *this;
+    }
+    ClimateCall &set_custom_fan_mode(const std::string &fan_mode) {
+        custom_fan_mode_ = fan_mode;
+        return *this;
+    }
+    ClimateCall &set_target_temperature(float target_temperature) {
+        target_temperature_ = target_temperature;
+        return *this;
+    }
+
+    const optional<ClimateMode> &get_mode() const { return mode_; }
+    // Empty when the call does not change it
+    const std::string &get_custom_preset() const { return custom_preset_; }
+    const std::string &get_custom_fan_mode() const { return custom_fan_mode_; }
+    const optional<float> &get_target_temperature() const { return target_temperature_; }
+
+protected:
+    optional<ClimateMode> mode_;
+    std::string custom_preset_;
+    std::string custom_fan_mode_;
+    optional<float> target_temperature_;
+};
+
+class Climate : public EntityBase {
+public:
+    void make_call(const ClimateCall &call) { control(call); }
+    void publish_state() { count_publish(); }
+
+    ClimateMode mode{CLIMATE_MODE_OFF};
+    float current_temperature{NAN};
+    float target_temperature{NAN};
+
+protected:
+    virtual ClimateTraits traits() = 0;
+    virtual void control(const ClimateCall &call) = 0;
+
+    void set_supported_custom_presets(std::initializer_list<const char *> presets) {
+        custom_presets_.assign(presets.begin(), presets.end());
+    }
+    void set_supported_custom_fan_modes(std::initializer_list<const char *> fan_modes) {
+        custom_fan_modes_.assign(fan_modes.begin(), fan_modes.end());
+    }
+
+    std::vector<std::string> custom_presets_;
+    std::vector<std::string> custom_fan_modes_;
+};
+
+} // namespace climate
+} // namespace esphome
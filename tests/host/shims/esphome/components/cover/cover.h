@@ -0,0 +1,58 @@
+#pragma once
+
+#include <esphome/core/entity_base.h>
+#include <esphome/core/helpers.h>
+
+namespace esphome {
+namespace cover {
+
+const extern float COVER_OPEN;
+const extern float COVER_CLOSED;
+
+class CoverTraits {
+public:
+    void set_supports_position(bool supports_position) { supports_position_ = supports_position; }
+    bool get_supports_position() const { return supports_position_; }
+    void set_supports_tilt(bool supports_tilt) { supports_tilt_ = supports_tilt; }
+    bool get_supports_tilt() const { return supports_tilt_; }
+    void set_supports_stop(bool supports_stop) { supports_stop_ = supports_stop; }
+    bool get_supports_stop() const { return supports_stop_; }
+    void set_is_assumed_state(bool is_assumed_state) { is_assumed_state_ = is_assumed_state; }
+    bool get_is_assumed_state() const { return is_assumed_state_; }
+
+protected:
+    bool supports_position_{false};
+    bool supports_tilt_{false};
+    bool supports_stop_{false};
+    bool is_assumed_state_{false};
+};
+
+class CoverCall {
+public:
+    CoverCall &set_position(float position) {
+        position_ = position;
+        return *this;
+    }
+    const optional<float> &get_position() const { return position_; }
+
+protected:
+    optional<float> position_;
+};
+
+class Cover : public EntityBase {
+public:
+    void make_call(const CoverCall &call) { control(call); }
+    void publish_state(bool save = true) {
+        (void) save;
+        count_publish();
+    }
+    virtual CoverTraits get_traits() = 0;
+
+    float position{0.0f};
+
+protected:
+    virtual void control(const CoverCall &call) = 0;
+};
+
+} // namespace cover
+} // namespace esphome
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <esp_gap_ble_api.h>
+#include <vector>
+
+namespace esphome {
+namespace esp32_ble {
+
+class GAPEventHandler {
+public:
+    virtual ~GAPEventHandler() = default;
+    virtual void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param) = 0;
+};
+
+class ESP32BLE {
+public:
+    void register_gap_event_handler(GAPEventHandler *handler) { gap_event_handlers_.push_back(handler); }
+
+    // Host: hand a GAP event to every registered handler
+    void dispatch_gap_event(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param);
+    // Host: forget handlers registered by previous tests
+    void reset() { gap_event_handlers_.clear(); }
+
+protected:
+    std::vector<GAPEventHandler *> gap_event_handlers_;
+};
+
+extern ESP32BLE *global_ble;
+
+} // namespace esp32_ble
+} // namespace esphome
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace esp32_ble_tracker {
+
+enum class ClientState : uint8_t {
+    INIT = 0,
+    DISCONNECTING,
+    IDLE,
+    DISCOVERED,
+    READY_TO_CONNECT,
+    CONNECTING,
+    CONNECTED,
+    ESTABLISHED,
+};
+
+class ESPBTUUID {
+public:
+    // 128-bit UUIDs in their canonical string form only
+    static ESPBTUUID from_raw(const std::string &data);
+    bool operator==(const ESPBTUUID &other) const { return uuid_ == other.uuid_; }
+    std::string to_string() const { return uuid_; }
+
+protected:
+    std::string uuid_;
+};
+
+class ESPBTDevice {
+public:
+    explicit ESPBTDevice(uint64_t address = 0) : address_(address) {}
+    uint64_t address_uint64() const { return address_; }
+
+protected:
+    uint64_t address_;
+};
+
+class ESPBTDeviceListener {
+public:
+    virtual ~ESPBTDeviceListener() = default;
+    virtual bool parse_device(const ESPBTDevice &device) = 0;
+};
+
+class ESP32BLETracker {
+public:
+    void register_listener(ESPBTDeviceListener *listener) { listeners_.push_back(listener); }
+
+    bool get_scan_continuous() const { return scan_continuous_; }
+    void set_scan_continuous(bool scan_continuous) { scan_continuous_ = scan_continuous; }
+    void start_scan() { scanning_ = true; }
+    void stop_scan() { scanning_ = false; }
+    bool is_scanning() const { return scanning_; }
+
+    // Host: hand an advertisement to every listener
+    void report_device(const ESPBTDevice &device);
+    // Host: forget listeners registered by previous tests
+    void reset();
+
+protected:
+    std::vector<ESPBTDeviceListener *> listeners_;
+    bool scan_continuous_{true};
+    bool scanning_{true};
+};
+
+extern ESP32BLETracker *global_esp32_ble_tracker;
+
+} // namespace esp32_ble_tracker
+} // namespace esphome
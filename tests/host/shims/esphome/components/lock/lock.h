@@ -0,0 +1,46 @@
+#pragma once
+
+#include <esphome/core/entity_base.h>
+#include <esphome/core/helpers.h>
+#include <cstdint>
+
+namespace esphome {
+namespace lock {
+
+enum LockState : uint8_t {
+    LOCK_STATE_NONE = 0,
+    LOCK_STATE_LOCKED = 1,
+    LOCK_STATE_UNLOCKED = 2,
+    LOCK_STATE_JAMMED = 3,
+    LOCK_STATE_LOCKING = 4,
+    LOCK_STATE_UNLOCKING = 5,
+};
+
+class LockCall {
+public:
+    LockCall &set_state(LockState state) {
+        state_ = state;
+        return *this;
+    }
+    const optional<LockState> &get_state() const { return state_; }
+
+protected:
+    optional<LockState> state_;
+};
+
+class Lock : public EntityBase {
+public:
+    void make_call(const LockCall &call) { control(call); }
+    void publish_state(LockState new_state) {
+        state = new_state;
+        count_publish();
+    }
+
+    LockState state{LOCK_STATE_NONE};
+
+protected:
+    virtual void control(const LockCall &call) = 0;
+};
+
+} // namespace lock
+} // namespace esphome
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <esphome/core/entity_base.h>
+#include <cmath>
+
+namespace esphome {
+namespace number {
+
+class NumberTraits {
+public:
+    void set_min_value(float min_value) { min_value_ = min_value; }
+    float get_min_value() const { return min_value_; }
+    void set_max_value(float max_value) { max_value_ = max_value; }
+    float get_max_value() const { return max_value_; }
+    void set_step(float step) { step_ = step; }
+    float get_step() const { return step_; }
+
+protected:
+    float min_value_{0.0f};
+    float max_value_{100.0f};
+    float step_{1.0f};
+};
+
+class Number : public EntityBase {
+public:
+    void make_call(float value) { control(value); }
+    void publish_state(float new_state) {
+        state = new_state;
+        count_publish();
+    }
+
+    float state{NAN};
+    NumberTraits traits;
+
+protected:
+    virtual void control(float value) = 0;
+};
+
+} // namespace number
+} // namespace esphome
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <esphome/core/entity_base.h>
+#include <cmath>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace esphome {
+namespace sensor {
+
+class Sensor : public EntityBase {
+public:
+    void publish_state(float new_state) {
+        state = new_state;
+        count_publish();
+        for (auto& callback : callbacks_) callback(new_state);
+    }
+    void add_on_state_callback(std::function<void(float)> callback) { callbacks_.push_back(std::move(callback)); }
+
+    float state{NAN};
+
+protected:
+    std::vector<std::function<void(float)>> callbacks_;
+};
+
+} // namespace sensor
+} // namespace esphome
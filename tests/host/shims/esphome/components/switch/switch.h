@@ -0,0 +1,24 @@
+#pragma once
+
+#include <esphome/core/entity_base.h>
+
+namespace esphome {
+namespace switch_ {
+
+class Switch : public EntityBase {
+public:
+    void turn_on() { write_state(true); }
+    void turn_off() { write_state(false); }
+    void publish_state(bool new_state) {
+        state = new_state;
+        count_publish();
+    }
+
+    bool state{false};
+
+protected:
+    virtual void write_state(bool state) = 0;
+};
+
+} // namespace switch_
+} // namespace esphome
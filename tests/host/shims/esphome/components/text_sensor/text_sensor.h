@@ -0,0 +1,20 @@
+#pragma once
+
+#include <esphome/core/entity_base.h>
+#include <string>
+
+namespace esphome {
+namespace text_sensor {
+
+class TextSensor : public EntityBase {
+public:
+    void publish_state(const std::string &new_state) {
+        state = new_state;
+        count_publish();
+    }
+
+    std::string state;
+};
+
+} // namespace text_sensor
+} // namespace esphome
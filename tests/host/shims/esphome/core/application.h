@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+namespace esphome {
+
+class Application {
+public:
+    std::string get_compilation_time() const { return __DATE__ ", " __TIME__; }
+};
+
+extern Application App;
+
+} // namespace esphome
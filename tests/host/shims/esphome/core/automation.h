@@ -0,0 +1,28 @@
+#pragma once
+
+#include <functional>
+
+namespace esphome {
+
+template<typename... Ts> class Action {
+public:
+    virtual ~Action() = default;
+    virtual void play(Ts... x) = 0;
+};
+
+template<typename T, typename... X> class TemplatableValue {
+public:
+    TemplatableValue() = default;
+    TemplatableValue(T value) : value_(value), has_value_(true) {}
+    TemplatableValue(std::function<T(X...)> f) : f_(std::move(f)), has_value_(true) {}
+
+    bool has_value() const { return has_value_; }
+    T value(X... x) const { return f_ ? f_(x...) : value_; }
+
+private:
+    T value_{};
+    std::function<T(X...)> f_;
+    bool has_value_{false};
+};
+
+} // namespace esphome
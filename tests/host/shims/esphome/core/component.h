@@ -0,0 +1,42 @@
+#pragma once
+
+#include "esphome/core/hal.h"
+#include <cstdint>
+#include <string>
+
+namespace esphome {
+
+class Component {
+public:
+    virtual ~Component() = default;
+
+    virtual void setup() {}
+    virtual void loop() {}
+    virtual void dump_config() {}
+    virtual void on_shutdown() {}
+
+    void status_set_warning(const char *message = nullptr);
+    void status_clear_warning();
+    bool status_has_warning() const { return warning_; }
+    const std::string &get_warning_message() const { return warning_message_; }
+
+protected:
+    bool warning_{false};
+    std::string warning_message_;
+};
+
+class PollingComponent : public Component {
+public:
+    PollingComponent() = default;
+    explicit PollingComponent(uint32_t update_interval) : update_interval_(update_interval) {}
+
+    virtual void update() = 0;
+
+    void set_update_interval(uint32_t update_interval) { update_interval_ = update_interval; }
+    uint32_t get_update_interval() const { return update_interval_; }
+
+protected:
+    uint32_t update_interval_{10000};
+};
+
+} // namespace esphome
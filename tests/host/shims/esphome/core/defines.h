@@ -0,0 +1,3 @@
+#pragma once
+
+// Feature defines (USE_TESLA_BLE_*) come from the host CMake target
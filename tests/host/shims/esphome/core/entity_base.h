@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+
+class EntityBase {
+public:
+    virtual ~EntityBase() = default;
+
+    bool has_state() const { return has_state_; }
+    void set_has_state(bool state) { has_state_ = state; }
+
+    // Number of publish_state() calls, for tests
+    uint32_t get_publish_count() const { return publish_count_; }
+
+protected:
+    void count_publish() {
+        has_state_ = true;
+        publish_count_++;
+    }
+
+    bool has_state_{false};
+    uint32_t publish_count_{0};
+};
+
+} // namespace esphome
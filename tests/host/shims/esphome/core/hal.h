@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+
+// Driven by the host clock (see host_env.h), not wall time
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+
+} // namespace esphome
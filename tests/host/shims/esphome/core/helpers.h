@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace esphome {
+
+template<typename T> using optional = std::optional<T>;
+
+std::string format_hex(const uint8_t *data, size_t length);
+std::string format_hex(const std::vector<uint8_t> &data);
+uint32_t fnv1_hash(const std::string &str);
+// Seeded by host::set_random_seed() so reconnect jitter repeats
+uint32_t random_uint32();
+
+} // namespace esphome
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdarg>
+#include <cstddef>
+
+#define ESPHOME_LOG_LEVEL_NONE 0
+#define ESPHOME_LOG_LEVEL_ERROR 1
+#define ESPHOME_LOG_LEVEL_WARN 2
+#define ESPHOME_LOG_LEVEL_INFO 3
+#define ESPHOME_LOG_LEVEL_CONFIG 4
+#define ESPHOME_LOG_LEVEL_DEBUG 5
+#define ESPHOME_LOG_LEVEL_VERBOSE 6
+#define ESPHOME_LOG_LEVEL_VERY_VERBOSE 7
+
+// Like ESPHome, messages above ESPHOME_LOG_LEVEL are compiled out; the tests
+// keep every level so they can inspect the log
+#ifndef ESPHOME_LOG_LEVEL
+#define ESPHOME_LOG_LEVEL ESPHOME_LOG_LEVEL_VERY_VERBOSE
+#endif
+
+#define esp_log_at_level_(level, tag, ...) \
+    do { \
+        if ((level) <= ESPHOME_LOG_LEVEL) ::esphome::esp_log_printf_(level, tag, __LINE__, __VA_ARGS__); \
+    } while (0)
+
+#define ESP_LOGE(tag, ...) esp_log_at_level_(ESPHOME_LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) esp_log_at_level_(ESPHOME_LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) esp_log_at_level_(ESPHOME_LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) esp_log_at_level_(ESPHOME_LOG_LEVEL_CONFIG, tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) esp_log_at_level_(ESPHOME_LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) esp_log_at_level_(ESPHOME_LOG_LEVEL_VERBOSE, tag, __VA_ARGS__)
+#define ESP_LOGVV(tag, ...) esp_log_at_level_(ESPHOME_LOG_LEVEL_VERY_VERBOSE, tag, __VA_ARGS__)
+
+#define YESNO(b) ((b) ? "YES" : "NO")
+#define ONOFF(b) ((b) ? "ON" : "OFF")
+#define TRUEFALSE(b) ((b) ? "TRUE" : "FALSE")
+
+namespace esphome {
+
+void esp_log_printf_(int level, const char *tag, int line, const char *format, ...);
+void esp_log_vprintf_(int level, const char *tag, int line, const char *format, va_list args);
+
+} // namespace esphome
@@ -0,0 +1,3 @@
+#pragma once
+
+#define ESPHOME_VERSION "host"
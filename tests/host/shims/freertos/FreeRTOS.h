@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+// Tasks are std::threads and ticks are milliseconds (see host_env.cpp)
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+#define portMAX_DELAY 0xffffffffUL
+#define tskNO_AFFINITY 0x7fffffff
+#define pdMS_TO_TICKS(ms) (static_cast<TickType_t>(ms))
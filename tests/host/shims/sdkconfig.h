@@ -0,0 +1,5 @@
+#pragma once
+
+// Dual-core target without heap hooks or BLE 5.0: CONFIG_FREERTOS_UNICORE,
+// CONFIG_HEAP_USE_HOOKS and CONFIG_BT_BLE_50_FEATURES_SUPPORTED stay undefined
+// (the benchmark build defines CONFIG_HEAP_USE_HOOKS itself)
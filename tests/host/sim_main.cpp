@@ -0,0 +1,158 @@
+#include "fake_vehicle.h"
+#include "host_env.h"
+#include "tesla_ble_vehicle.h"
+#include <esphome/core/helpers.h>
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+/**
+ * tesla_ble_sim: runs the component against a FakeVehicle and reports what
+ * crossed the link and how long the main loop took.
+ *
+ *   tesla_ble_sim [capture] [--mtu N] [--latency MS] [--loss PCT] [--seed N]
+ *                 [--duration S] [--sleep-after S] [--protocol-task] [--vin VIN]
+ *                 [--nvs KEY=HEX]...
+ *
+ * capture is a dump_capture log or raw v1 records. --latency and --loss
+ * apply each way. --sleep-after lets the car fall asleep after that long
+ * without infotainment traffic. --nvs seeds the VIN's NVS namespace (e.g.
+ * private_key, tk_infotainment) so replayed signed responses can
+ * authenticate.
+ */
+
+using namespace esphome;
+using esphome::tesla_ble_vehicle::TeslaBLEVehicle;
+
+static void usage() {
+    fprintf(stderr,
+            "usage: tesla_ble_sim [capture] [--mtu N] [--latency MS] [--loss PCT] [--seed N]\n"
+            "                     [--duration S] [--sleep-after S] [--protocol-task] [--vin VIN]\n"
+            "                     [--nvs KEY=HEX]...\n");
+}
+
+int main(int argc, char** argv) {
+    host::LinkConfig link;
+    link.mtu = 185;
+    uint32_t seed = 1;
+    uint32_t duration_s = 120;
+    uint32_t sleep_after_s = 0;
+    bool protocol_task = false;
+    std::string vin = "5YJ3E1EA7JF000001";
+    std::string capture_path;
+    std::vector<std::pair<std::string, std::vector<uint8_t>>> nvs;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--mtu" && has_value) {
+            link.mtu = static_cast<uint16_t>(atoi(argv[++i]));
+        } else if (arg == "--latency" && has_value) {
+            link.latency_ms = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (arg == "--loss" && has_value) {
+            link.loss_percent = static_cast<uint8_t>(std::min(atoi(argv[++i]), 100));
+        } else if (arg == "--seed" && has_value) {
+            seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 0));
+        } else if (arg == "--duration" && has_value) {
+            duration_s = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (arg == "--sleep-after" && has_value) {
+            sleep_after_s = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (arg == "--protocol-task") {
+            protocol_task = true;
+        } else if (arg == "--vin" && has_value) {
+            vin = argv[++i];
+        } else if (arg == "--nvs" && has_value) {
+            const std::string entry = argv[++i];
+            const size_t eq = entry.find('=');
+            std::vector<uint8_t> blob;
+            if (eq == std::string::npos || !host::parse_hex(entry.substr(eq + 1), blob)) {
+                usage();
+                return 2;
+            }
+            nvs.emplace_back(entry.substr(0, eq), blob);
+        } else if (arg[0] != '-' && capture_path.empty()) {
+            capture_path = arg;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (link.mtu < 4) {
+        usage();
+        return 2;
+    }
+
+    char ns[16];
+    snprintf(ns, sizeof(ns), "tb_%08" PRIx32, fnv1_hash(vin));
+    for (const auto& entry : nvs) host::nvs_put(ns, entry.first, entry.second);
+
+    ble_client::BLEClient client;
+    TeslaBLEVehicle vehicle;
+    host::FakeVehicle car(&client);
+    car.set_link(link);
+    car.set_seed(seed);
+    car.set_vin(vin);
+    car.set_sleep_timeout(sleep_after_s * 1000);
+    host::set_random_seed(seed);
+
+    if (!capture_path.empty()) {
+        std::vector<host::CaptureRecord> records;
+        if (!host::load_capture_file(capture_path, records)) {
+            fprintf(stderr, "tesla_ble_sim: cannot read capture %s\n", capture_path.c_str());
+            return 1;
+        }
+        car.add_capture(records);
+    }
+
+    // The component reads the car's sleep state back from this
+    binary_sensor::BinarySensor asleep;
+    sensor::Sensor loop_time_max, loop_time_mean;
+    text_sensor::TextSensor loop_time_breakdown;
+    // Publishes are per window; the run's worst window is what matters
+    float worst_loop_time_max = NAN;
+    loop_time_max.add_on_state_callback([&worst_loop_time_max](float value) {
+        if (std::isnan(worst_loop_time_max) || value > worst_loop_time_max) worst_loop_time_max = value;
+    });
+
+    client.register_ble_node(&vehicle);
+    vehicle.set_vin(vin.c_str());
+    vehicle.set_protocol_task(protocol_task);
+    vehicle.set_binary_sensor("asleep", &asleep);
+    vehicle.set_sensor("loop_time_max", &loop_time_max);
+    vehicle.set_sensor("loop_time_mean", &loop_time_mean);
+    vehicle.set_text_sensor("loop_time_breakdown", &loop_time_breakdown);
+    vehicle.setup();
+
+    host::LoopDriver driver(&vehicle, &car);
+    car.connect();
+    driver.run_for(duration_s * 1000);
+
+    printf("link: mtu=%u latency=%" PRIu32 "ms loss=%u%% seed=%" PRIu32 " protocol_task=%s\n",
+           link.mtu, link.latency_ms, link.loss_percent, seed, protocol_task ? "on" : "off");
+    printf("requests: vcsec=%" PRIu32 " infotainment=%" PRIu32 "\n",
+           car.get_requests(host::FakeVehicle::DOMAIN_VCSEC),
+           car.get_requests(host::FakeVehicle::DOMAIN_INFOTAINMENT));
+    printf("responses: replayed=%" PRIu32 " generated=%" PRIu32 " signed=%" PRIu32 " faults=%" PRIu32
+           " largest=%zu bytes\n",
+           car.get_replayed_responses(), car.get_generated_responses(), car.get_signed_responses(),
+           car.get_faults(), car.get_largest_response());
+    printf("writes: sent=%" PRIu32 " lost=%" PRIu32 "\n", car.get_writes(), car.get_writes_lost());
+    printf("notifications: sent=%" PRIu32 " lost=%" PRIu32 "\n", car.get_notifications_sent(),
+           car.get_notifications_lost());
+    printf("car: %s, sessions: vcsec=%s infotainment=%s\n", car.asleep() ? "asleep" : "awake",
+           car.has_session(host::FakeVehicle::DOMAIN_VCSEC) ? "yes" : "no",
+           car.has_session(host::FakeVehicle::DOMAIN_INFOTAINMENT) ? "yes" : "no");
+    printf("connected: %s\n", vehicle.is_connected() ? "yes" : "no");
+    if (std::isnan(worst_loop_time_max)) {
+        printf("loop time: not published (run for at least 60 s)\n");
+    } else {
+        printf("loop time max: %.3f ms (worst window), mean: %.3f ms (last window)\n", worst_loop_time_max,
+               loop_time_mean.state);
+        printf("loop time breakdown: %s\n", loop_time_breakdown.state.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include "ble_adapter_impl.h"
+#include "host_env.h"
+#include "host_test.h"
+#include "tesla_ble_vehicle.h"
+
+using namespace esphome;
+using esphome::tesla_ble_vehicle::BleAdapterImpl;
+using esphome::tesla_ble_vehicle::TeslaBLEVehicle;
+
+static const uint16_t READ_HANDLE = 0x0010;
+static const uint16_t CCCD_HANDLE = 0x0011;
+static const uint16_t WRITE_HANDLE = 0x0013;
+
+// A set-up vehicle taken through discovery, so is_connected() and the
+// write handle are what the adapter sees on a device
+struct ConnectedVehicle {
+    ble_client::BLEClient client;
+    TeslaBLEVehicle vehicle;
+
+    ConnectedVehicle() {
+        client.register_ble_node(&vehicle);
+        vehicle.set_vin("5YJ3E1EA7JF000001");
+        vehicle.setup();
+
+        const auto service = esp32_ble_tracker::ESPBTUUID::from_raw(tesla_ble_vehicle::SERVICE_UUID);
+        client.add_characteristic(service, esp32_ble_tracker::ESPBTUUID::from_raw(tesla_ble_vehicle::READ_UUID),
+                                  READ_HANDLE, CCCD_HANDLE);
+        client.add_characteristic(service, esp32_ble_tracker::ESPBTUUID::from_raw(tesla_ble_vehicle::WRITE_UUID),
+                                  WRITE_HANDLE);
+
+        esp_ble_gattc_cb_param_t param{};
+        client.gattc_event_handler(ESP_GATTC_SEARCH_CMPL_EVT, &param);
+        param = {};
+        param.reg_for_notify.status = ESP_GATT_OK;
+        param.reg_for_notify.handle = READ_HANDLE;
+        client.gattc_event_handler(ESP_GATTC_REG_FOR_NOTIFY_EVT, &param);
+        host::clear_gattc_writes();
+    }
+};
+
+static std::vector<uint8_t> bytes(size_t count) {
+    std::vector<uint8_t> data(count);
+    for (size_t i = 0; i < count; i++) data[i] = static_cast<uint8_t>(i);
+    return data;
+}
+
+TEST(ble_adapter_sends_one_block_per_loop) {
+    ConnectedVehicle fixture;
+    ASSERT_TRUE(fixture.vehicle.is_connected());
+    BleAdapterImpl adapter(&fixture.vehicle);
+
+    const auto data = bytes(40);
+    EXPECT_TRUE(adapter.write(data));
+    EXPECT_TRUE(host::gattc_writes().empty());
+
+    adapter.process_write_queue();
+    ASSERT_TRUE(host::gattc_writes().size() == 1);
+    EXPECT_EQ(host::gattc_writes()[0].handle, WRITE_HANDLE);
+    EXPECT_EQ(host::gattc_writes()[0].write_type, ESP_GATT_WRITE_TYPE_NO_RSP);
+    EXPECT_EQ(host::gattc_writes()[0].data, std::vector<uint8_t>(data.begin(), data.begin() + 18));
+
+    adapter.process_write_queue();
+    adapter.process_write_queue();
+    EXPECT_FALSE(adapter.has_pending_writes());
+
+    std::vector<uint8_t> sent;
+    for (const auto& write : host::gattc_writes()) sent.insert(sent.end(), write.data.begin(), write.data.end());
+    EXPECT_EQ(host::gattc_writes().size(), 3u);
+    EXPECT_EQ(sent, data);
+}
+
+TEST(ble_adapter_refuses_writes_while_disconnected) {
+    ble_client::BLEClient client;
+    TeslaBLEVehicle vehicle;
+    client.register_ble_node(&vehicle);
+    BleAdapterImpl adapter(&vehicle);
+
+    EXPECT_FALSE(adapter.write(bytes(4)));
+    EXPECT_FALSE(adapter.has_pending_writes());
+}
+
+TEST(ble_adapter_retries_failed_write) {
+    ConnectedVehicle fixture;
+    BleAdapterImpl adapter(&fixture.vehicle);
+    int attempts = 0;
+    host::set_gattc_write_hook([&attempts](const host::GattcWrite&) {
+        return ++attempts == 1 ? ESP_FAIL : ESP_OK;
+    });
+
+    EXPECT_TRUE(adapter.write(bytes(4)));
+    adapter.process_write_queue();
+    EXPECT_TRUE(adapter.has_pending_writes());
+    adapter.process_write_queue();
+    EXPECT_FALSE(adapter.has_pending_writes());
+    EXPECT_EQ(attempts, 2);
+}
+
+TEST(ble_adapter_clear_queues_drops_pending_writes) {
+    ConnectedVehicle fixture;
+    BleAdapterImpl adapter(&fixture.vehicle);
+    EXPECT_TRUE(adapter.write(bytes(60)));
+    adapter.clear_queues();
+    EXPECT_FALSE(adapter.has_pending_writes());
+    adapter.process_write_queue();
+    EXPECT_TRUE(host::gattc_writes().empty());
+}
@@ -0,0 +1,578 @@
+#include "fake_vehicle.h"
+#include "host_env.h"
+#include "host_test.h"
+#include "session_crypto.h"
+#include "tesla_ble_vehicle.h"
+#include "wire_format.h"
+#include <esphome/core/helpers.h>
+
+using namespace esphome;
+using esphome::tesla_ble_vehicle::TeslaBLEVehicle;
+using host::FakeVehicle;
+
+class TestLock : public lock::Lock {
+protected:
+    void control(const lock::LockCall&) override {}
+};
+
+// The component wired to a FakeVehicle, with the entities the VCSEC status
+// drives
+struct SimulatedCar {
+    ble_client::BLEClient client;
+    TeslaBLEVehicle vehicle;
+    FakeVehicle car{&client};
+    binary_sensor::BinarySensor asleep;
+    TestLock doors;
+    host::LoopDriver driver{&vehicle, &car};
+
+    explicit SimulatedCar(bool protocol_task = false) {
+        client.register_ble_node(&vehicle);
+        vehicle.set_vin("5YJ3E1EA7JF000001");
+        vehicle.set_protocol_task(protocol_task);
+        vehicle.set_binary_sensor("asleep", &asleep);
+        vehicle.set_doors_lock(&doors);
+    }
+
+    bool connect() {
+        vehicle.setup();
+        car.connect();
+        return driver.run_until([this]() { return vehicle.is_connected(); }, 2000);
+    }
+};
+
+using host::put_bytes_field;
+
+static std::vector<uint8_t> framed(const std::vector<uint8_t>& message) {
+    std::vector<uint8_t> frame = {static_cast<uint8_t>(message.size() >> 8), static_cast<uint8_t>(message.size())};
+    frame.insert(frame.end(), message.begin(), message.end());
+    return frame;
+}
+
+static std::vector<uint8_t> vcsec_request() {
+    std::vector<uint8_t> message;
+    put_bytes_field(message, 6, {0x08, FakeVehicle::DOMAIN_VCSEC});
+    put_bytes_field(message, 7, {0x12, 0x02, 0xCA, 0xFE});
+    return message;
+}
+
+// Unlocked, awake, answering an earlier session's routing address
+static std::vector<uint8_t> captured_unlocked_status() {
+    std::vector<uint8_t> message;
+    put_bytes_field(message, 6, {0x12, 0x02, 0xCA, 0xFE});
+    put_bytes_field(message, 7, {0x08, FakeVehicle::DOMAIN_VCSEC});
+    put_bytes_field(message, 10, {0x0A, 0x04, 0x10, 0x00, 0x18, 0x01});
+    return message;
+}
+
+static std::vector<host::CaptureRecord> capture_of(const std::vector<uint8_t>& request,
+                                                   const std::vector<uint8_t>& response) {
+    const auto response_frame = framed(response);
+    const size_t half = response_frame.size() / 2;
+    return {
+        {100, true, 0, framed(request)},
+        {120, false, 0, std::vector<uint8_t>(response_frame.begin(), response_frame.begin() + half)},
+        {121, false, 0, std::vector<uint8_t>(response_frame.begin() + half, response_frame.end())},
+    };
+}
+
+TEST(fake_vehicle_connects_and_reports_status) {
+    SimulatedCar sim;
+    ASSERT_TRUE(sim.connect());
+    EXPECT_TRUE(sim.car.link_up());
+
+    ASSERT_TRUE(sim.driver.run_until([&sim]() { return sim.doors.state == lock::LOCK_STATE_LOCKED; }, 2000));
+    EXPECT_TRUE(sim.car.get_requests(FakeVehicle::DOMAIN_VCSEC) >= 1);
+    EXPECT_TRUE(sim.car.get_generated_responses() >= 1);
+    EXPECT_TRUE(sim.asleep.has_state());
+    EXPECT_FALSE(sim.asleep.state);
+}
+
+TEST(fake_vehicle_follows_status_changes) {
+    SimulatedCar sim;
+    ASSERT_TRUE(sim.connect());
+    ASSERT_TRUE(sim.driver.run_until([&sim]() { return sim.doors.state == lock::LOCK_STATE_LOCKED; }, 2000));
+
+    sim.car.status().lock_state = 0;  // UNLOCKED
+    sim.car.push_status();
+    EXPECT_TRUE(sim.driver.run_until([&sim]() { return sim.doors.state == lock::LOCK_STATE_UNLOCKED; }, 1000));
+}
+
+TEST(fake_vehicle_cuts_notifications_to_mtu) {
+    SimulatedCar sim;
+    host::LinkConfig link;
+    link.mtu = 23;
+    sim.car.set_link(link);
+    ASSERT_TRUE(sim.connect());
+    ASSERT_TRUE(sim.driver.run_until([&sim]() { return sim.doors.state == lock::LOCK_STATE_LOCKED; }, 2000));
+
+    const uint32_t responses = sim.car.get_generated_responses();
+    const size_t per_response = (sim.car.get_largest_response() + 19) / 20;
+    EXPECT_TRUE(per_response > 1);
+    EXPECT_EQ(sim.car.get_notifications_sent(), responses * per_response);
+}
+
+TEST(fake_vehicle_delays_by_latency) {
+    SimulatedCar sim;
+    host::LinkConfig link;
+    link.latency_ms = 250;
+    sim.car.set_link(link);
+    ASSERT_TRUE(sim.connect());
+    ASSERT_TRUE(sim.driver.run_until([&sim]() { return sim.car.get_writes() > 0; }, 2000));
+
+    // 250 ms to the car, 250 ms back
+    sim.driver.run_for(200);
+    EXPECT_EQ(sim.car.get_requests(FakeVehicle::DOMAIN_VCSEC), 0u);
+    sim.driver.run_for(100);
+    EXPECT_EQ(sim.car.get_requests(FakeVehicle::DOMAIN_VCSEC), 1u);
+    sim.driver.run_for(150);
+    EXPECT_EQ(sim.doors.state, lock::LOCK_STATE_NONE);
+    sim.driver.run_for(100);
+    EXPECT_EQ(sim.doors.state, lock::LOCK_STATE_LOCKED);
+}
+
+TEST(fake_vehicle_full_loss_delivers_nothing) {
+    SimulatedCar sim;
+    host::LinkConfig link;
+    link.loss_percent = 100;
+    sim.car.set_link(link);
+    ASSERT_TRUE(sim.connect());
+
+    sim.driver.run_for(5000);
+    EXPECT_TRUE(sim.car.get_writes() > 0);
+    EXPECT_EQ(sim.car.get_writes_lost(), sim.car.get_writes());
+    EXPECT_EQ(sim.car.get_requests(FakeVehicle::DOMAIN_VCSEC), 0u);
+    EXPECT_EQ(sim.car.get_notifications_sent(), 0u);
+    EXPECT_EQ(sim.doors.state, lock::LOCK_STATE_NONE);
+}
+
+TEST(fake_vehicle_partial_loss_thins_both_ways) {
+    SimulatedCar sim;
+    host::LinkConfig link;
+    link.loss_percent = 30;
+    sim.car.set_link(link);
+    sim.car.set_seed(7);
+    ASSERT_TRUE(sim.connect());
+
+    sim.driver.run_for(120000);
+    EXPECT_TRUE(sim.car.get_writes_lost() > 0);
+    EXPECT_TRUE(sim.car.get_writes_lost() < sim.car.get_writes());
+    EXPECT_TRUE(sim.car.get_notifications_lost() > 0);
+    // Requests whose chunks all made it still get through
+    EXPECT_TRUE(sim.car.get_requests(FakeVehicle::DOMAIN_VCSEC) > 0);
+    EXPECT_TRUE(sim.car.get_notifications_sent() > 0);
+}
+
+TEST(fake_vehicle_replays_captured_response_first) {
+    SimulatedCar sim;
+    sim.car.add_capture(capture_of(vcsec_request(), captured_unlocked_status()));
+    ASSERT_TRUE(sim.connect());
+
+    ASSERT_TRUE(sim.driver.run_until([&sim]() { return sim.doors.state == lock::LOCK_STATE_UNLOCKED; }, 2000));
+    EXPECT_EQ(sim.car.get_replayed_responses(), 1u);
+    EXPECT_EQ(sim.car.get_generated_responses(), 0u);
+
+    // The capture is used up; later polls get the generated status
+    EXPECT_TRUE(sim.driver.run_until([&sim]() { return sim.doors.state == lock::LOCK_STATE_LOCKED; }, 60000));
+}
+
+TEST(fake_vehicle_parses_capture_dump_log) {
+    const auto records = capture_of(vcsec_request(), captured_unlocked_status());
+    std::vector<uint8_t> raw;
+    for (const auto& record : records) {
+        raw.insert(raw.end(), {static_cast<uint8_t>(record.timestamp), 0, 0, 0, static_cast<uint8_t>(record.tx ? 1 : 0),
+                               0, 0, static_cast<uint8_t>(record.data.size()), 0});
+        raw.insert(raw.end(), record.data.begin(), record.data.end());
+    }
+
+    std::string log = "[I][tesla_ble_capture:084]: CAPTURE v1 records=3 bytes=" + std::to_string(raw.size()) +
+                      " dropped=0\n";
+    for (size_t i = 0; i < raw.size(); i += 32) {
+        const size_t len = std::min<size_t>(32, raw.size() - i);
+        log += "[I][tesla_ble_capture:088]: CAPTURE " + format_hex(raw.data() + i, len) + "\x1b[0m\n";
+    }
+    log += "[I][tesla_ble_capture:090]: CAPTURE end\n";
+
+    std::vector<host::CaptureRecord> parsed;
+    ASSERT_TRUE(host::parse_capture(log, parsed));
+    ASSERT_TRUE(parsed.size() == records.size());
+    for (size_t i = 0; i < records.size(); i++) {
+        EXPECT_EQ(parsed[i].tx, records[i].tx);
+        EXPECT_EQ(parsed[i].data, records[i].data);
+    }
+
+    std::vector<host::CaptureRecord> from_raw;
+    EXPECT_TRUE(host::parse_capture(std::string(raw.begin(), raw.end()), from_raw));
+    EXPECT_EQ(from_raw.size(), records.size());
+}
+
+// A dump_capture log checked in under captures/, read the way tesla_ble_sim
+// reads its capture argument
+TEST(fake_vehicle_replays_checked_in_capture) {
+    std::vector<host::CaptureRecord> records;
+    ASSERT_TRUE(host::load_capture_file(HOST_CAPTURE_DIR "/vcsec_unlocked.log", records));
+    EXPECT_EQ(records.size(), 12u);
+
+    SimulatedCar sim;
+    binary_sensor::BinarySensor present;
+    sim.vehicle.set_binary_sensor("user_present", &present);
+    sim.car.add_capture(records);
+    ASSERT_TRUE(sim.connect());
+
+    ASSERT_TRUE(sim.driver.run_until([&sim]() { return sim.doors.state == lock::LOCK_STATE_UNLOCKED; }, 2000));
+    EXPECT_TRUE(present.state);
+    EXPECT_EQ(sim.car.get_generated_responses(), 0u);
+
+    // Both captured polls are answered from the capture, then the generated
+    // status takes over
+    ASSERT_TRUE(sim.driver.run_until([&sim]() { return sim.doors.state == lock::LOCK_STATE_LOCKED; }, 60000));
+    EXPECT_EQ(sim.car.get_replayed_responses(), 2u);
+    EXPECT_FALSE(present.state);
+}
+
+TEST(fake_vehicle_status_through_protocol_task) {
+    SimulatedCar sim(true);
+    host::LinkConfig link;
+    link.mtu = 23;
+    sim.car.set_link(link);
+    ASSERT_TRUE(sim.connect());
+    EXPECT_TRUE(sim.driver.run_until([&sim]() { return sim.doors.state == lock::LOCK_STATE_LOCKED; }, 2000));
+}
+
+TEST(fake_vehicle_link_loss_disconnects) {
+    SimulatedCar sim;
+    ASSERT_TRUE(sim.connect());
+
+    sim.car.drop_link();
+    EXPECT_TRUE(sim.driver.run_until([&sim]() { return !sim.vehicle.is_connected(); }, 1000));
+    EXPECT_FALSE(sim.car.link_up());
+
+    sim.car.connect();
+    EXPECT_TRUE(sim.driver.run_until([&sim]() { return sim.vehicle.is_connected(); }, 2000));
+}
+
+TEST(fake_vehicle_closes_link_on_client_disconnect) {
+    SimulatedCar sim;
+    ASSERT_TRUE(sim.connect());
+
+    sim.client.disconnect();
+    EXPECT_TRUE(sim.driver.run_until([&sim]() { return !sim.vehicle.is_connected(); }, 1000));
+    EXPECT_FALSE(sim.car.link_up());
+    EXPECT_EQ(sim.client.state(), esp32_ble_tracker::ClientState::IDLE);
+}
+
+TEST(fake_vehicle_cached_handles_hold_tx_until_discovery) {
+    SimulatedCar sim;
+    ASSERT_TRUE(sim.connect());
+    ASSERT_TRUE(sim.driver.run_until([&sim]() { return sim.doors.state == lock::LOCK_STATE_LOCKED; }, 2000));
+
+    // The handles are cached now; the next link registers before discovery
+    sim.car.drop_link();
+    ASSERT_TRUE(sim.driver.run_until([&sim]() { return !sim.vehicle.is_connected(); }, 1000));
+    const uint32_t requests = sim.car.get_requests(FakeVehicle::DOMAIN_VCSEC);
+    sim.car.connect();
+    ASSERT_TRUE(sim.driver.run_until(
+        [&sim, requests]() { return sim.car.get_requests(FakeVehicle::DOMAIN_VCSEC) > requests; }, 2000));
+    EXPECT_EQ(sim.car.get_writes_during_discovery(), 0u);
+}
+
+TEST(fake_vehicle_stale_cached_handles_start_link_once) {
+    SimulatedCar sim;
+    ASSERT_TRUE(sim.connect());
+    ASSERT_TRUE(sim.driver.run_until([&sim]() { return sim.doors.state == lock::LOCK_STATE_LOCKED; }, 2000));
+
+    sim.car.drop_link();
+    ASSERT_TRUE(sim.driver.run_until([&sim]() { return !sim.vehicle.is_connected(); }, 1000));
+    sim.car.set_gatt_handles(0x0020, 0x0021, 0x0023);
+    const uint32_t requests = sim.car.get_requests(FakeVehicle::DOMAIN_VCSEC);
+    sim.car.connect();
+
+    // Registration completes on the cached and then the discovered handles;
+    // bring-up runs once, on the discovered write handle
+    sim.driver.run_for(1000);
+    EXPECT_EQ(sim.car.get_requests(FakeVehicle::DOMAIN_VCSEC), requests + 1);
+    EXPECT_EQ(sim.car.get_writes_during_discovery(), 0u);
+    EXPECT_EQ(sim.car.get_stray_writes(), 0u);
+}
+
+TEST(fake_vehicle_publishes_phase_medians) {
+    SimulatedCar sim;
+    sensor::Sensor mtu, discovery, first_rx, vcsec;
+    sim.vehicle.set_sensor("connect_mtu_median", &mtu);
+    sim.vehicle.set_sensor("connect_discovery_median", &discovery);
+    sim.vehicle.set_sensor("connect_first_rx_median", &first_rx);
+    sim.vehicle.set_sensor("connect_vcsec_median", &vcsec);
+    ASSERT_TRUE(sim.connect());
+    ASSERT_TRUE(sim.driver.run_until([&vcsec]() { return vcsec.has_state(); }, 2000));
+
+    EXPECT_TRUE(mtu.has_state());
+    EXPECT_TRUE(discovery.has_state());
+    EXPECT_TRUE(first_rx.has_state());
+    EXPECT_TRUE(mtu.state < discovery.state);
+    EXPECT_TRUE(discovery.state <= first_rx.state);
+}
+
+TEST(fake_vehicle_idle_car_reaches_idle_link_profile) {
+    SimulatedCar sim;
+    sim.car.status().sleep_status = 2;  // ASLEEP: only the VCSEC poll runs
+    ASSERT_TRUE(sim.connect());
+    auto* link = sim.vehicle.get_link_manager();
+    ASSERT_TRUE(link != nullptr);
+    EXPECT_TRUE(sim.driver.run_until(
+        [link]() { return link->get_mode() == tesla_ble_vehicle::BleLinkManager::LinkMode::ACTIVE; }, 2000));
+
+    // Default intervals: VCSEC every 10 s, link_idle_timeout 30 s
+    const uint32_t requests = sim.car.get_requests(FakeVehicle::DOMAIN_VCSEC);
+    EXPECT_TRUE(sim.driver.run_until(
+        [link]() { return link->get_mode() == tesla_ble_vehicle::BleLinkManager::LinkMode::IDLE; }, 40000));
+    EXPECT_EQ(sim.car.get_conn_interval(), tesla_ble_vehicle::LINK_PARAMS_IDLE.max_interval);
+    EXPECT_TRUE(sim.car.get_requests(FakeVehicle::DOMAIN_VCSEC) >= requests + 2);
+
+    // Polls keep going out on the idle profile without switching back
+    const uint32_t switches = link->get_switch_count();
+    sim.driver.run_for(30000);
+    EXPECT_EQ(link->get_mode(), tesla_ble_vehicle::BleLinkManager::LinkMode::IDLE);
+    EXPECT_EQ(link->get_switch_count(), switches);
+}
+
+TEST(fake_vehicle_poor_link_still_polls_infotainment) {
+    SimulatedCar sim;
+    host::LinkConfig link;
+    link.rssi = -92;
+    sim.car.set_link(link);
+    ASSERT_TRUE(sim.connect());
+    // RSSI is read every 10 s
+    auto* link_manager = sim.vehicle.get_link_manager();
+    ASSERT_TRUE(sim.driver.run_until(
+        [link_manager]() {
+            return link_manager->get_quality() == tesla_ble_vehicle::BleLinkManager::LinkQuality::POOR;
+        },
+        15000));
+
+    // Awake and idle: infotainment every 4 x 30 s on a POOR link, VCSEC on
+    // every 10 s update tick
+    const uint32_t infotainment = sim.car.get_requests(FakeVehicle::DOMAIN_INFOTAINMENT);
+    const uint32_t vcsec = sim.car.get_requests(FakeVehicle::DOMAIN_VCSEC);
+    sim.driver.run_for(300000);
+    EXPECT_TRUE(sim.car.get_requests(FakeVehicle::DOMAIN_INFOTAINMENT) >= infotainment + 2);
+    EXPECT_TRUE(sim.car.get_requests(FakeVehicle::DOMAIN_VCSEC) >= vcsec + 25);
+}
+
+// The car alone on the link, for requests the stub library does not send:
+// the test plays the client, with the helpers the car signs with
+struct BareCar {
+    static constexpr const char* VIN = "5YJ3E1EA7JF000001";
+
+    struct ClientSession {
+        std::vector<uint8_t> key;
+        std::vector<uint8_t> epoch;
+        uint32_t clock_time{0};
+        uint32_t counter{0};
+    };
+
+    ble_client::BLEClient client;
+    FakeVehicle car{&client};
+    host::P256Key key;
+    uint8_t next_uuid{1};
+
+    BareCar() { car.set_vin(VIN); }
+
+    bool connect() {
+        car.connect();
+        pump(200);
+        return car.link_up();
+    }
+
+    void pump(uint32_t duration_ms) {
+        for (uint32_t t = 0; t < duration_ms; t += 10) {
+            car.loop();
+            host::advance_time_ms(10);
+        }
+    }
+
+    // The car's answer, or empty if it sent none
+    std::vector<uint8_t> request(const std::vector<uint8_t>& message) {
+        const size_t sent = car.get_sent_messages().size();
+        auto frame = framed(message);
+        esp_ble_gattc_write_char(0, client.get_conn_id(), FakeVehicle::WRITE_HANDLE, static_cast<uint16_t>(frame.size()),
+                                 frame.data(), ESP_GATT_WRITE_TYPE_NO_RSP, ESP_GATT_AUTH_REQ_NONE);
+        pump(50);
+        return car.get_sent_messages().size() > sent ? car.get_sent_messages().back() : std::vector<uint8_t>{};
+    }
+
+    std::vector<uint8_t> header(uint32_t domain, std::vector<uint8_t>& uuid) {
+        uuid.assign(16, next_uuid++);
+        std::vector<uint8_t> message;
+        put_bytes_field(message, 6, {0x08, static_cast<uint8_t>(domain)});
+        put_bytes_field(message, 7, {0x12, 0x02, 0xCA, 0xFE});
+        put_bytes_field(message, 51, uuid);
+        return message;
+    }
+
+    std::vector<uint8_t> session_info_request(uint32_t domain, std::vector<uint8_t>& uuid) {
+        std::vector<uint8_t> request;
+        put_bytes_field(request, 1, key.public_key());
+        std::vector<uint8_t> message = header(domain, uuid);
+        put_bytes_field(message, 14, request);
+        return message;
+    }
+
+    bool handshake(uint32_t domain, ClientSession& session) {
+        std::vector<uint8_t> uuid;
+        const auto response = request(session_info_request(domain, uuid));
+        const auto info = host::bytes_field(response, 15);
+        if (info.empty()) return false;
+        session.key = key.session_key(host::bytes_field(info, 2));
+        session.epoch = host::bytes_field(info, 3);
+        session.clock_time = static_cast<uint32_t>(host::varint_field(info, 4));
+        session.counter = static_cast<uint32_t>(host::varint_field(info, 1));
+        return !session.key.empty();
+    }
+
+    // An AES_GCM_Personalized request; tag is what the response must name
+    std::vector<uint8_t> signed_request(uint32_t domain, ClientSession& session, const std::vector<uint8_t>& plaintext,
+                                        std::vector<uint8_t>& tag) {
+        const uint32_t counter = ++session.counter;
+        const uint32_t expires_at = session.clock_time + 30;
+        const std::vector<uint8_t> nonce(host::GCM_NONCE_SIZE, static_cast<uint8_t>(counter));
+        std::vector<uint8_t> ciphertext;
+        host::aes_gcm_encrypt(session.key, nonce,
+                              host::request_aad(domain, VIN, session.epoch, expires_at, counter, 0), plaintext,
+                              ciphertext, tag);
+        std::vector<uint8_t> gcm;
+        put_bytes_field(gcm, 1, session.epoch);
+        put_bytes_field(gcm, 2, nonce);
+        host::put_varint_field(gcm, 3, counter);
+        host::put_fixed32_field(gcm, 4, expires_at);
+        put_bytes_field(gcm, 5, tag);
+        std::vector<uint8_t> identity;
+        put_bytes_field(identity, 1, key.public_key());
+        std::vector<uint8_t> signature;
+        put_bytes_field(signature, 1, identity);
+        put_bytes_field(signature, 5, gcm);
+
+        std::vector<uint8_t> uuid;
+        std::vector<uint8_t> message = header(domain, uuid);
+        put_bytes_field(message, 10, ciphertext);
+        put_bytes_field(message, 13, signature);
+        return message;
+    }
+};
+
+static uint32_t fault_of(const std::vector<uint8_t>& response) {
+    return static_cast<uint32_t>(host::varint_field(host::bytes_field(response, 12), 2));
+}
+
+TEST(fake_vehicle_tags_session_info_for_the_requester) {
+    BareCar bare;
+    ASSERT_TRUE(bare.connect());
+
+    std::vector<uint8_t> uuid;
+    const auto response = bare.request(bare.session_info_request(FakeVehicle::DOMAIN_INFOTAINMENT, uuid));
+    const auto info = host::bytes_field(response, 15);
+    ASSERT_TRUE(!info.empty());
+    EXPECT_EQ(host::bytes_field(info, 2), bare.car.get_public_key());
+    EXPECT_EQ(host::bytes_field(info, 3).size(), 16u);
+    EXPECT_EQ(host::bytes_field(response, 50), uuid);
+    EXPECT_TRUE(bare.car.has_session(FakeVehicle::DOMAIN_INFOTAINMENT));
+
+    const auto tag = host::bytes_field(host::bytes_field(host::bytes_field(response, 13), 6), 1);
+    const auto session_key = bare.key.session_key(bare.car.get_public_key());
+    EXPECT_EQ(session_key.size(), host::SESSION_KEY_SIZE);
+    EXPECT_EQ(tag, host::session_info_tag(session_key, BareCar::VIN, uuid, info));
+    // Bound to the challenge and the VIN
+    EXPECT_TRUE(tag != host::session_info_tag(session_key, BareCar::VIN, std::vector<uint8_t>(16, 0), info));
+    EXPECT_TRUE(tag != host::session_info_tag(session_key, "5YJ3E1EA7JF000002", uuid, info));
+}
+
+TEST(fake_vehicle_signs_infotainment_responses) {
+    BareCar bare;
+    ASSERT_TRUE(bare.connect());
+    BareCar::ClientSession session;
+    ASSERT_TRUE(bare.handshake(FakeVehicle::DOMAIN_INFOTAINMENT, session));
+
+    const std::vector<uint8_t> action = {0x0A, 0x02, 0x08, 0x01};
+    std::vector<uint8_t> request_tag;
+    const auto request = bare.signed_request(FakeVehicle::DOMAIN_INFOTAINMENT, session, action, request_tag);
+    const auto response = bare.request(request);
+    EXPECT_EQ(bare.car.get_signed_responses(), 1u);
+
+    const auto gcm = host::bytes_field(host::bytes_field(response, 13), 9);
+    ASSERT_TRUE(!gcm.empty());
+    EXPECT_EQ(host::varint_field(gcm, 2), session.counter);
+    std::vector<uint8_t> plaintext;
+    EXPECT_TRUE(host::aes_gcm_decrypt(
+        session.key, host::bytes_field(gcm, 1),
+        host::response_aad(FakeVehicle::DOMAIN_INFOTAINMENT, BareCar::VIN, session.counter, 0,
+                           host::request_hash(FakeVehicle::DOMAIN_INFOTAINMENT, request_tag), 0),
+        host::bytes_field(response, 10), host::bytes_field(gcm, 3), plaintext));
+    // An OK actionStatus
+    EXPECT_EQ(plaintext, (std::vector<uint8_t>{0x0A, 0x00}));
+
+    // The same request again is a replay
+    EXPECT_EQ(fault_of(bare.request(request)), 6u);  // INVALID_TOKEN_OR_COUNTER
+    EXPECT_EQ(bare.car.get_signed_responses(), 1u);
+}
+
+TEST(fake_vehicle_rejects_requests_outside_the_session) {
+    BareCar bare;
+    ASSERT_TRUE(bare.connect());
+    BareCar::ClientSession session;
+    ASSERT_TRUE(bare.handshake(FakeVehicle::DOMAIN_INFOTAINMENT, session));
+    std::vector<uint8_t> tag;
+
+    BareCar::ClientSession wrong_key = session;
+    wrong_key.key[0] ^= 0x01;
+    EXPECT_EQ(fault_of(bare.request(bare.signed_request(FakeVehicle::DOMAIN_INFOTAINMENT, wrong_key, {}, tag))),
+              5u);  // INVALID_SIGNATURE
+
+    BareCar::ClientSession wrong_epoch = session;
+    wrong_epoch.epoch[0] ^= 0x01;
+    EXPECT_EQ(fault_of(bare.request(bare.signed_request(FakeVehicle::DOMAIN_INFOTAINMENT, wrong_epoch, {}, tag))),
+              15u);  // INCORRECT_EPOCH
+
+    // No session with VCSEC yet
+    EXPECT_EQ(fault_of(bare.request(bare.signed_request(FakeVehicle::DOMAIN_VCSEC, session, {}, tag))),
+              3u);  // UNKNOWN_KEY_ID
+    EXPECT_EQ(bare.car.get_faults(), 3u);
+    EXPECT_EQ(bare.car.get_signed_responses(), 0u);
+}
+
+TEST(fake_vehicle_wakes_on_rke_action) {
+    BareCar bare;
+    bare.car.status().sleep_status = 2;  // ASLEEP
+    ASSERT_TRUE(bare.connect());
+
+    // Infotainment is down while the car sleeps
+    BareCar::ClientSession infotainment;
+    EXPECT_FALSE(bare.handshake(FakeVehicle::DOMAIN_INFOTAINMENT, infotainment));
+
+    BareCar::ClientSession vcsec;
+    ASSERT_TRUE(bare.handshake(FakeVehicle::DOMAIN_VCSEC, vcsec));
+    const std::vector<uint8_t> wake = {0x10, 0x1E};  // UnsignedMessage.RKEAction = WAKE_VEHICLE
+    std::vector<uint8_t> tag;
+    const auto response = bare.request(bare.signed_request(FakeVehicle::DOMAIN_VCSEC, vcsec, wake, tag));
+    EXPECT_TRUE(!host::bytes_field(host::bytes_field(response, 13), 9).empty());
+    EXPECT_TRUE(bare.car.asleep());
+
+    bare.pump(FakeVehicle::WAKE_MS);
+    EXPECT_FALSE(bare.car.asleep());
+    // The car says so unasked
+    const auto status = host::bytes_field(host::bytes_field(bare.car.get_sent_messages().back(), 10), 1);
+    EXPECT_EQ(host::varint_field(status, 3), 1u);  // AWAKE
+    EXPECT_TRUE(bare.handshake(FakeVehicle::DOMAIN_INFOTAINMENT, infotainment));
+}
+
+TEST(fake_vehicle_sleeps_once_infotainment_polls_stop) {
+    SimulatedCar sim;
+    sim.car.set_sleep_timeout(600000);
+    ASSERT_TRUE(sim.connect());
+    ASSERT_TRUE(sim.driver.run_until([&sim]() { return sim.asleep.has_state(); }, 2000));
+    EXPECT_FALSE(sim.asleep.state);
+
+    // Locked, away and not charging: the component polls infotainment every
+    // 30 s for infotainment_sleep_timeout (11 min), then backs off
+    sim.driver.run_for(540000);
+    EXPECT_FALSE(sim.car.asleep());
+    EXPECT_TRUE(sim.driver.run_until([&sim]() { return sim.asleep.state; }, 1200000));
+    EXPECT_TRUE(sim.car.asleep());
+}
@@ -0,0 +1,65 @@
+#include "host_test.h"
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace host_test {
+
+struct TestCase {
+    const char* name;
+    TestFn fn;
+};
+
+static std::vector<TestCase>& registry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+static int failures = 0;
+
+Registrar::Registrar(const char* name, TestFn fn) { registry().push_back({name, fn}); }
+
+void report_failure(const char* file, int line, const std::string& message) {
+    fprintf(stderr, "%s:%d: %s\n", file, line, message.c_str());
+    failures++;
+}
+
+// The component keeps process-wide state (coordinator, BLE tracker, NVS),
+// as it would on a device; a process per test keeps tests independent
+static bool run_isolated(const TestCase& test) {
+    fflush(stdout);
+    fflush(stderr);
+    const pid_t pid = fork();
+    if (pid == 0) {
+        try {
+            test.fn();
+        } catch (const AssertionFailed&) {
+        }
+        fflush(stderr);
+        _exit(failures == 0 ? 0 : 1);
+    }
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) < 0) return false;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+} // namespace host_test
+
+int main(int argc, char** argv) {
+    using namespace host_test;
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+
+    int run = 0;
+    int failed = 0;
+    for (const auto& test : registry()) {
+        if (filter != nullptr && strstr(test.name, filter) == nullptr) continue;
+        run++;
+        const bool passed = run_isolated(test);
+        printf("[%s] %s\n", passed ? "  OK  " : " FAIL ", test.name);
+        if (!passed) failed++;
+    }
+    printf("%d tests, %d failed\n", run, failed);
+    return failed == 0 && run > 0 ? 0 : 1;
+}
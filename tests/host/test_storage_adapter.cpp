@@ -0,0 +1,172 @@
+#include "host_env.h"
+#include "host_test.h"
+#include "storage_adapter_impl.h"
+#include <esphome/core/helpers.h>
+#include <cinttypes>
+#include <cstdio>
+
+using esphome::tesla_ble_vehicle::StorageAdapterImpl;
+
+static const char* const VIN = "5YJ3E1EA7JF000001";
+
+static std::string vin_namespace(const std::string& vin) {
+    char ns[16];
+    snprintf(ns, sizeof(ns), "tb_%08" PRIx32, esphome::fnv1_hash(vin));
+    return ns;
+}
+
+TEST(storage_namespace_follows_vin) {
+    StorageAdapterImpl legacy;
+    ASSERT_TRUE(legacy.initialize());
+    EXPECT_EQ(legacy.get_namespace(), std::string("storage"));
+
+    StorageAdapterImpl storage;
+    ASSERT_TRUE(storage.initialize(VIN));
+    EXPECT_EQ(storage.get_namespace(), vin_namespace(VIN));
+}
+
+TEST(storage_sessions_keep_legacy_key_names) {
+    StorageAdapterImpl storage;
+    ASSERT_TRUE(storage.initialize(VIN));
+    const std::vector<uint8_t> session = {1, 2, 3};
+    EXPECT_TRUE(storage.save("session_vcsec", session));
+    EXPECT_TRUE(storage.save("session_infotainment", session));
+    EXPECT_TRUE(storage.flush());
+
+    EXPECT_EQ(host::nvs_get(vin_namespace(VIN), "tk_vcsec"), session);
+    EXPECT_EQ(host::nvs_get(vin_namespace(VIN), "tk_infotainment"), session);
+}
+
+TEST(storage_long_keys_are_hashed_and_survive_restart) {
+    const std::string key = "a_key_longer_than_fifteen_chars";
+    const std::vector<uint8_t> value = {9, 8, 7};
+    {
+        StorageAdapterImpl storage;
+        ASSERT_TRUE(storage.initialize(VIN));
+        EXPECT_TRUE(storage.save(key, value));
+        EXPECT_TRUE(storage.flush());
+    }
+    EXPECT_TRUE(host::nvs_has_key(vin_namespace(VIN), "~index"));
+
+    StorageAdapterImpl reopened;
+    ASSERT_TRUE(reopened.initialize(VIN));
+    std::vector<uint8_t> loaded;
+    EXPECT_TRUE(reopened.load(key, loaded));
+    EXPECT_EQ(loaded, value);
+}
+
+TEST(storage_sessions_are_written_behind) {
+    StorageAdapterImpl storage;
+    ASSERT_TRUE(storage.initialize(VIN));
+    storage.set_flush_interval(1000);
+    const uint32_t commits = host::nvs_commit_count();
+
+    EXPECT_TRUE(storage.save("session_vcsec", {1}));
+    EXPECT_TRUE(storage.save("session_vcsec", {2}));
+    EXPECT_TRUE(storage.has_pending_writes());
+    EXPECT_EQ(host::nvs_commit_count(), commits);
+    EXPECT_EQ(storage.get_writes_avoided(), 1u);
+
+    // Reads are served from the cache before the flush
+    std::vector<uint8_t> loaded;
+    EXPECT_TRUE(storage.load("session_vcsec", loaded));
+    EXPECT_EQ(loaded, std::vector<uint8_t>{2});
+
+    host::advance_time_ms(999);
+    storage.loop();
+    EXPECT_TRUE(storage.has_pending_writes());
+
+    host::advance_time_ms(1);
+    storage.loop();
+    EXPECT_FALSE(storage.has_pending_writes());
+    EXPECT_EQ(host::nvs_get(vin_namespace(VIN), "tk_vcsec"), std::vector<uint8_t>{2});
+    EXPECT_EQ(storage.get_flash_writes(), 1u);
+}
+
+TEST(storage_failed_commit_keeps_sessions_dirty) {
+    StorageAdapterImpl storage;
+    ASSERT_TRUE(storage.initialize(VIN));
+    EXPECT_TRUE(storage.save("session_vcsec", {1}));
+    EXPECT_TRUE(storage.save("session_infotainment", {2}));
+
+    host::nvs_set_commit_result(ESP_FAIL);
+    EXPECT_FALSE(storage.flush());
+    EXPECT_TRUE(storage.has_pending_writes());
+    EXPECT_FALSE(host::nvs_has_key(vin_namespace(VIN), "tk_vcsec"));
+    EXPECT_EQ(storage.get_flash_writes(), 0u);
+
+    // The next flush stages both sessions again
+    EXPECT_TRUE(storage.flush());
+    EXPECT_FALSE(storage.has_pending_writes());
+    EXPECT_EQ(host::nvs_get(vin_namespace(VIN), "tk_vcsec"), std::vector<uint8_t>{1});
+    EXPECT_EQ(host::nvs_get(vin_namespace(VIN), "tk_infotainment"), std::vector<uint8_t>{2});
+    EXPECT_EQ(storage.get_flash_writes(), 2u);
+}
+
+TEST(storage_private_key_is_written_through) {
+    StorageAdapterImpl storage;
+    ASSERT_TRUE(storage.initialize(VIN));
+    const std::vector<uint8_t> key = {0x30, 0x77};
+
+    EXPECT_TRUE(storage.save("private_key", key));
+    EXPECT_FALSE(storage.has_pending_writes());
+    EXPECT_EQ(host::nvs_get(vin_namespace(VIN), "private_key"), key);
+
+    // Saving the same bytes again does not touch flash
+    EXPECT_TRUE(storage.save("private_key", key));
+    EXPECT_EQ(storage.get_flash_writes(), 1u);
+    EXPECT_EQ(storage.get_writes_avoided(), 1u);
+}
+
+TEST(storage_remove_drops_cached_value) {
+    StorageAdapterImpl storage;
+    ASSERT_TRUE(storage.initialize(VIN));
+    EXPECT_TRUE(storage.save("private_key", {1, 2}));
+    EXPECT_TRUE(storage.remove("private_key"));
+
+    std::vector<uint8_t> loaded;
+    EXPECT_FALSE(storage.load("private_key", loaded));
+    EXPECT_FALSE(host::nvs_has_key(vin_namespace(VIN), "private_key"));
+    EXPECT_TRUE(storage.remove("private_key"));
+}
+
+TEST(storage_legacy_keys_migrate_to_first_vehicle_only) {
+    const std::vector<uint8_t> legacy_key = {0xAA, 0xBB};
+    host::nvs_put("storage", "private_key", legacy_key);
+    host::nvs_put("storage", "tk_vcsec", {0x01});
+
+    {
+        StorageAdapterImpl first;
+        ASSERT_TRUE(first.initialize(VIN));
+        std::vector<uint8_t> loaded;
+        EXPECT_TRUE(first.load("private_key", loaded));
+        EXPECT_EQ(loaded, legacy_key);
+        EXPECT_TRUE(first.load("session_vcsec", loaded));
+        EXPECT_EQ(loaded, std::vector<uint8_t>{0x01});
+    }
+    // Left in place for downgrades
+    EXPECT_TRUE(host::nvs_has_key("storage", "private_key"));
+
+    StorageAdapterImpl second;
+    ASSERT_TRUE(second.initialize("5YJ3E1EA7JF000002"));
+    std::vector<uint8_t> loaded;
+    EXPECT_FALSE(second.load("private_key", loaded));
+}
+
+TEST(storage_erases_full_partition_on_init) {
+    host::nvs_put("storage", "private_key", {1});
+    host::nvs_set_init_result(ESP_ERR_NVS_NO_FREE_PAGES);
+
+    StorageAdapterImpl storage;
+    ASSERT_TRUE(storage.initialize());
+    std::vector<uint8_t> loaded;
+    EXPECT_FALSE(storage.load("private_key", loaded));
+}
+
+TEST(storage_refuses_use_before_initialize) {
+    StorageAdapterImpl storage;
+    std::vector<uint8_t> loaded;
+    EXPECT_FALSE(storage.save("private_key", {1}));
+    EXPECT_FALSE(storage.load("private_key", loaded));
+    EXPECT_FALSE(storage.remove("private_key"));
+}
@@ -0,0 +1,277 @@
+#include "host_env.h"
+#include "host_test.h"
+#include "vehicle_state_manager.h"
+
+using namespace esphome;
+using esphome::tesla_ble_vehicle::VehicleStateManager;
+namespace tbv = esphome::tesla_ble_vehicle;
+
+class TestLock : public lock::Lock {
+protected:
+    void control(const lock::LockCall&) override {}
+};
+
+class TestCover : public cover::Cover {
+public:
+    cover::CoverTraits get_traits() override { return {}; }
+
+protected:
+    void control(const cover::CoverCall&) override {}
+};
+
+class TestSwitch : public switch_::Switch {
+protected:
+    void write_state(bool) override {}
+};
+
+class TestNumber : public number::Number {
+protected:
+    void control(float) override {}
+};
+
+static VCSEC_VehicleStatus vehicle_status(VCSEC_VehicleSleepStatus_E sleep, VCSEC_VehicleLockState_E lock_state,
+                                          VCSEC_UserPresence_E presence) {
+    VCSEC_VehicleStatus status = VCSEC_VehicleStatus_init_zero;
+    status.vehicleSleepStatus = sleep;
+    status.vehicleLockState = lock_state;
+    status.userPresence = presence;
+    return status;
+}
+
+TEST(state_vcsec_status_updates_entities) {
+    VehicleStateManager manager(nullptr);
+    manager.set_publish_budget(0);
+    binary_sensor::BinarySensor asleep, present;
+    TestLock doors;
+    TestCover flap;
+    manager.set_binary_sensor("asleep", &asleep);
+    manager.set_binary_sensor("user_present", &present);
+    manager.set_doors_lock(&doors);
+    manager.set_charge_port_door_cover(&flap);
+
+    auto status = vehicle_status(VCSEC_VehicleSleepStatus_E_VEHICLE_SLEEP_STATUS_AWAKE,
+                                 VCSEC_VehicleLockState_E_VEHICLELOCKSTATE_SELECTIVE_UNLOCKED,
+                                 VCSEC_UserPresence_E_VEHICLE_USER_PRESENCE_PRESENT);
+    status.has_closureStatuses = true;
+    status.closureStatuses.chargePort = VCSEC_ClosureState_E_CLOSURESTATE_OPEN;
+    manager.update_vehicle_status(status);
+
+    EXPECT_FALSE(asleep.state);
+    EXPECT_TRUE(manager.is_known_awake());
+    EXPECT_TRUE(present.state);
+    EXPECT_TRUE(manager.is_user_present());
+    EXPECT_EQ(doors.state, lock::LOCK_STATE_UNLOCKED);
+    EXPECT_TRUE(manager.is_unlocked());
+    EXPECT_TRUE(manager.is_charge_flap_open());
+}
+
+TEST(state_unknown_sleep_status_makes_sensor_unavailable) {
+    VehicleStateManager manager(nullptr);
+    manager.set_publish_budget(0);
+    binary_sensor::BinarySensor asleep;
+    manager.set_binary_sensor("asleep", &asleep);
+
+    manager.update_sleep_status(VCSEC_VehicleSleepStatus_E_VEHICLE_SLEEP_STATUS_ASLEEP);
+    EXPECT_TRUE(asleep.has_state());
+    manager.update_sleep_status(VCSEC_VehicleSleepStatus_E_VEHICLE_SLEEP_STATUS_UNKNOWN);
+    EXPECT_FALSE(asleep.has_state());
+    EXPECT_FALSE(manager.is_known_awake());
+}
+
+TEST(state_unchanged_values_are_not_republished) {
+    VehicleStateManager manager(nullptr);
+    manager.set_publish_budget(0);
+    binary_sensor::BinarySensor asleep;
+    manager.set_binary_sensor("asleep", &asleep);
+
+    manager.update_asleep(true);
+    manager.update_asleep(true);
+    EXPECT_EQ(asleep.get_publish_count(), 1u);
+    EXPECT_EQ(manager.get_publish_count(), 1u);
+}
+
+TEST(state_changes_are_staged_until_flushed) {
+    VehicleStateManager manager(nullptr);
+    binary_sensor::BinarySensor asleep;
+    sensor::Sensor battery;
+    manager.set_binary_sensor("asleep", &asleep);
+    manager.set_sensor("battery_level", &battery);
+
+    manager.update_asleep(false);
+    CarServer_ChargeState charge = CarServer_ChargeState_init_zero;
+    charge.which_optional_battery_level = CarServer_ChargeState_battery_level_tag;
+    charge.optional_battery_level.battery_level = 70;
+    manager.update_charge_state(charge);
+    charge.optional_battery_level.battery_level = 71;
+    manager.update_charge_state(charge);
+
+    EXPECT_FALSE(asleep.has_state());
+    EXPECT_FALSE(battery.has_state());
+    // Reads see the staged value before it is published
+    EXPECT_TRUE(manager.is_known_awake());
+    EXPECT_EQ(manager.get_pending_count(), 2u);
+
+    manager.flush_pending();
+    EXPECT_EQ(manager.get_pending_count(), 0u);
+    EXPECT_FALSE(asleep.state);
+    EXPECT_NEAR(battery.state, 71.0f, 0.001f);
+    // The superseded 70% never reached the entity
+    EXPECT_EQ(battery.get_publish_count(), 1u);
+}
+
+TEST(state_flush_stops_when_budget_is_spent) {
+    VehicleStateManager manager(nullptr);
+    manager.set_publish_budget(1000);
+    sensor::Sensor tpms[4];
+    const char* const ids[] = {"tpms_front_left", "tpms_front_right", "tpms_rear_left", "tpms_rear_right"};
+    for (int i = 0; i < 4; i++) {
+        manager.set_sensor(ids[i], &tpms[i]);
+        // Each publish takes 600us of the budget
+        tpms[i].add_on_state_callback([](float) { host::advance_time_us(600); });
+    }
+
+    CarServer_TirePressureState pressures = CarServer_TirePressureState_init_zero;
+    pressures.which_optional_tpms_pressure_fl = CarServer_TirePressureState_tpms_pressure_fl_tag;
+    pressures.optional_tpms_pressure_fl.tpms_pressure_fl = 2.9f;
+    pressures.which_optional_tpms_pressure_fr = CarServer_TirePressureState_tpms_pressure_fr_tag;
+    pressures.optional_tpms_pressure_fr.tpms_pressure_fr = 2.9f;
+    pressures.which_optional_tpms_pressure_rl = CarServer_TirePressureState_tpms_pressure_rl_tag;
+    pressures.optional_tpms_pressure_rl.tpms_pressure_rl = 2.8f;
+    pressures.which_optional_tpms_pressure_rr = CarServer_TirePressureState_tpms_pressure_rr_tag;
+    pressures.optional_tpms_pressure_rr.tpms_pressure_rr = 2.8f;
+    manager.update_tire_pressure_state(pressures);
+    EXPECT_EQ(manager.get_pending_count(), 4u);
+
+    manager.flush_pending();
+    EXPECT_EQ(manager.get_pending_count(), 2u);
+    manager.flush_pending();
+    EXPECT_EQ(manager.get_pending_count(), 0u);
+
+    manager.update_tire_pressure_state(pressures);
+    EXPECT_EQ(manager.get_pending_count(), 0u);
+}
+
+TEST(state_flush_all_ignores_budget) {
+    VehicleStateManager manager(nullptr);
+    manager.set_publish_budget(1);
+    sensor::Sensor battery, range;
+    manager.set_sensor("battery_level", &battery);
+    manager.set_sensor("range", &range);
+    battery.add_on_state_callback([](float) { host::advance_time_us(100); });
+
+    CarServer_ChargeState charge = CarServer_ChargeState_init_zero;
+    charge.which_optional_battery_level = CarServer_ChargeState_battery_level_tag;
+    charge.optional_battery_level.battery_level = 50;
+    charge.which_optional_battery_range = CarServer_ChargeState_battery_range_tag;
+    charge.optional_battery_range.battery_range = 150.0f;
+    manager.update_charge_state(charge);
+
+    manager.flush_all();
+    EXPECT_EQ(manager.get_pending_count(), 0u);
+    EXPECT_TRUE(range.has_state());
+}
+
+TEST(state_unavailable_drops_staged_values) {
+    VehicleStateManager manager(nullptr);
+    binary_sensor::BinarySensor asleep;
+    manager.set_binary_sensor("asleep", &asleep);
+
+    manager.update_asleep(false);
+    manager.set_sensors_available(false);
+    manager.flush_all();
+    EXPECT_FALSE(asleep.has_state());
+    EXPECT_EQ(asleep.get_publish_count(), 0u);
+}
+
+TEST(state_charge_state_syncs_controls) {
+    VehicleStateManager manager(nullptr);
+    manager.set_publish_budget(0);
+    binary_sensor::BinarySensor charger;
+    text_sensor::TextSensor charging_state, iec;
+    TestSwitch charging;
+    TestNumber amps, limit;
+    manager.set_binary_sensor("charger", &charger);
+    manager.set_text_sensor("charging_state", &charging_state);
+    manager.set_text_sensor("iec61851_state", &iec);
+    manager.set_charging_switch(&charging);
+    manager.set_charging_amps_number(&amps);
+    manager.set_charging_limit_number(&limit);
+
+    CarServer_ChargeState charge = CarServer_ChargeState_init_zero;
+    charge.has_charging_state = true;
+    charge.charging_state.which_type = CarServer_ChargeState_ChargingState_Charging_tag;
+    charge.which_optional_charge_current_request = CarServer_ChargeState_charge_current_request_tag;
+    charge.optional_charge_current_request.charge_current_request = 16;
+    charge.which_optional_charge_current_request_max = CarServer_ChargeState_charge_current_request_max_tag;
+    charge.optional_charge_current_request_max.charge_current_request_max = 24;
+    charge.which_optional_charge_limit_soc = CarServer_ChargeState_charge_limit_soc_tag;
+    charge.optional_charge_limit_soc.charge_limit_soc = 80;
+    manager.update_charge_state(charge);
+
+    EXPECT_TRUE(manager.is_charging());
+    EXPECT_TRUE(charging.state);
+    EXPECT_TRUE(charger.state);
+    EXPECT_EQ(charging_state.state, std::string("Charging"));
+    EXPECT_EQ(iec.state, std::string("C"));
+    EXPECT_NEAR(manager.get_charging_amps(), 16.0f, 0.001f);
+    EXPECT_NEAR(limit.state, 80.0f, 0.001f);
+    EXPECT_EQ(manager.get_charging_amps_max(), 24);
+
+    charge.charging_state.which_type = CarServer_ChargeState_ChargingState_Disconnected_tag;
+    manager.update_charge_state(charge);
+    EXPECT_FALSE(manager.is_charging());
+    EXPECT_FALSE(charging.state);
+    EXPECT_FALSE(charger.state);
+}
+
+TEST(state_charge_limit_reason_infers_external_limit) {
+    VehicleStateManager manager(nullptr);
+    manager.set_publish_budget(0);
+    text_sensor::TextSensor reason;
+    manager.set_text_sensor("charge_limit_reason", &reason);
+
+    CarServer_ChargeState charge = CarServer_ChargeState_init_zero;
+    charge.has_charging_state = true;
+    charge.charging_state.which_type = CarServer_ChargeState_ChargingState_Charging_tag;
+    charge.which_optional_charge_current_request = CarServer_ChargeState_charge_current_request_tag;
+    charge.optional_charge_current_request.charge_current_request = 32;
+    charge.which_optional_charger_actual_current = CarServer_ChargeState_charger_actual_current_tag;
+    charge.optional_charger_actual_current.charger_actual_current = 16;
+    manager.update_charge_state(charge);
+    EXPECT_EQ(reason.state, std::string("ExternalLimit"));
+
+    charge.optional_charger_actual_current.charger_actual_current = 32;
+    manager.update_charge_state(charge);
+    EXPECT_EQ(reason.state, std::string("Unknown"));
+
+    charge.which_optional_charge_limit_reason = CarServer_ChargeState_charge_limit_reason_tag;
+    charge.optional_charge_limit_reason.charge_limit_reason = CarServer_ChargeState_ChargeLimitReason_ChargeLimitReasonEvse;
+    manager.update_charge_state(charge);
+    EXPECT_EQ(reason.state, std::string("EVSE"));
+}
+
+TEST(state_closures_update_lock_and_windows) {
+    VehicleStateManager manager(nullptr);
+    manager.set_publish_budget(0);
+    TestLock doors;
+    TestCover windows;
+    binary_sensor::BinarySensor window_driver_front;
+    manager.set_doors_lock(&doors);
+    manager.set_windows_cover(&windows);
+    manager.set_binary_sensor("window_driver_front", &window_driver_front);
+
+    CarServer_ClosuresState closures = CarServer_ClosuresState_init_zero;
+    closures.which_optional_locked = CarServer_ClosuresState_locked_tag;
+    closures.optional_locked.locked = true;
+    closures.which_optional_window_open_driver_front = CarServer_ClosuresState_window_open_driver_front_tag;
+    closures.optional_window_open_driver_front.window_open_driver_front = true;
+    manager.update_closures_state(closures);
+
+    EXPECT_EQ(doors.state, lock::LOCK_STATE_LOCKED);
+    EXPECT_TRUE(window_driver_front.state);
+    EXPECT_NEAR(windows.position, cover::COVER_OPEN, 0.001f);
+
+    closures.optional_window_open_driver_front.window_open_driver_front = false;
+    manager.update_closures_state(closures);
+    EXPECT_NEAR(windows.position, cover::COVER_CLOSED, 0.001f);
+}
@@ -0,0 +1,101 @@
+#include "wire_format.h"
+
+namespace host {
+
+bool WireReader::next(WireField& field) {
+    if (pos_ >= end_) return false;
+    field.start = pos_;
+    uint64_t key = 0;
+    if (!varint(key)) return false;
+    field.number = static_cast<uint32_t>(key >> 3);
+    field.wire_type = static_cast<uint32_t>(key & 0x07);
+    field.value = 0;
+    field.data = nullptr;
+    field.len = 0;
+    switch (field.wire_type) {
+        case 0:
+            if (!varint(field.value)) return false;
+            break;
+        case 1:
+            if (end_ - pos_ < 8) return false;
+            pos_ += 8;
+            break;
+        case 2: {
+            uint64_t len = 0;
+            if (!varint(len) || len > static_cast<uint64_t>(end_ - pos_)) return false;
+            field.data = pos_;
+            field.len = static_cast<size_t>(len);
+            pos_ += len;
+            break;
+        }
+        case 5:
+            if (end_ - pos_ < 4) return false;
+            field.value = pos_[0] | (pos_[1] << 8) | (pos_[2] << 16) | (static_cast<uint32_t>(pos_[3]) << 24);
+            pos_ += 4;
+            break;
+        default:
+            return false;
+    }
+    field.end = pos_;
+    return true;
+}
+
+bool WireReader::varint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos_ < end_; shift += 7) {
+        const uint8_t byte = *pos_++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+bool find_field(const std::vector<uint8_t>& message, uint32_t number, WireField& out) {
+    WireReader reader(message);
+    WireField field;
+    while (reader.next(field)) {
+        if (field.number == number) {
+            out = field;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<uint8_t> bytes_field(const std::vector<uint8_t>& message, uint32_t number) {
+    WireField field;
+    if (!find_field(message, number, field) || field.wire_type != 2) return {};
+    return std::vector<uint8_t>(field.data, field.data + field.len);
+}
+
+uint64_t varint_field(const std::vector<uint8_t>& message, uint32_t number) {
+    WireField field;
+    if (!find_field(message, number, field) || field.wire_type == 2) return 0;
+    return field.value;
+}
+
+void put_varint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void put_varint_field(std::vector<uint8_t>& out, uint32_t number, uint64_t value) {
+    put_varint(out, number << 3);
+    put_varint(out, value);
+}
+
+void put_fixed32_field(std::vector<uint8_t>& out, uint32_t number, uint32_t value) {
+    put_varint(out, (number << 3) | 5);
+    for (int i = 0; i < 4; i++) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+void put_bytes_field(std::vector<uint8_t>& out, uint32_t number, const std::vector<uint8_t>& value) {
+    put_varint(out, (number << 3) | 2);
+    put_varint(out, value.size());
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+} // namespace host
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Protobuf wire format, just enough for the fake car
+ *
+ * The fake car reads and writes RoutableMessages field by field instead of
+ * through the library's nanopb types, so it can answer in forms the library
+ * under test may not generate itself (captures from other firmware, signed
+ * responses) and so a library that gets a field number wrong fails here
+ * rather than agreeing with itself.
+ */
+namespace host {
+
+struct WireField {
+    uint32_t number;
+    uint32_t wire_type;
+    uint64_t value;         // varint and fixed32 fields
+    const uint8_t* data;    // length-delimited fields
+    size_t len;
+    const uint8_t* start;   // whole field including its key
+    const uint8_t* end;
+};
+
+class WireReader {
+public:
+    explicit WireReader(const std::vector<uint8_t>& message)
+        : pos_(message.data()), end_(message.data() + message.size()) {}
+
+    bool next(WireField& field);
+
+private:
+    const uint8_t* pos_;
+    const uint8_t* end_;
+
+    bool varint(uint64_t& value);
+};
+
+bool find_field(const std::vector<uint8_t>& message, uint32_t number, WireField& out);
+// Empty when the field is missing or not length-delimited
+std::vector<uint8_t> bytes_field(const std::vector<uint8_t>& message, uint32_t number);
+// 0 when the field is missing, as proto3 reads it
+uint64_t varint_field(const std::vector<uint8_t>& message, uint32_t number);
+
+void put_varint(std::vector<uint8_t>& out, uint64_t value);
+void put_varint_field(std::vector<uint8_t>& out, uint32_t number, uint64_t value);
+void put_fixed32_field(std::vector<uint8_t>& out, uint32_t number, uint32_t value);
+void put_bytes_field(std::vector<uint8_t>& out, uint32_t number, const std::vector<uint8_t>& value);
+
+} // namespace host